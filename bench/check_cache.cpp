@@ -0,0 +1,219 @@
+// pl0_check_cache - incremental recompilation must match a cold compile
+//
+// Replays an edit session the way the GUI does: one ProcedureCache kept
+// across compilations of successive versions of a program. Every version is
+// also compiled without the cache; code (including line numbers), symbol
+// history, AST text and diagnostics must be identical. Versions edit one
+// procedure so that the others are reused with relinked calls, and change
+// outer declarations so that stale entries must not be reused.
+//
+// Exits non-zero if any version differs.
+
+#include "SourceManager.h"
+#include "Diagnostics.h"
+#include "CompilationContext.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SymbolTable.h"
+#include "Instruction.h"
+#include "ProcedureCache.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Compiled {
+    std::shared_ptr<pl0::CompilationContext> context;  // Owns the symbol names
+    bool success = false;
+    std::vector<pl0::Instruction> code;
+    std::vector<pl0::Symbol> symbols;
+    std::string ast;
+    std::string diagnostics;
+    int hits = 0;
+    int misses = 0;
+};
+
+Compiled compile(const std::string& source, pl0::ProcedureCache* cache) {
+    pl0::SourceManager srcMgr;
+    srcMgr.loadString(source, "edit.pl0");
+    std::ostringstream diagOut;
+    std::ostringstream astOut;
+    pl0::DiagnosticsEngine diag(srcMgr, diagOut);
+    diag.setUseColor(false);
+    auto context = std::make_shared<pl0::CompilationContext>(source.size() * 2);
+    pl0::SymbolTable symTable(context);
+    pl0::CodeGenerator codeGen;
+    pl0::Lexer lexer(source, diag, *context);
+    pl0::Parser parser(lexer, symTable, codeGen, diag);
+    parser.setProcedureCache(cache);
+    parser.enableAstDump(true);
+    parser.setAstOutput(astOut);
+
+    Compiled result;
+    result.context = context;
+    result.success = parser.parse();
+    result.code = codeGen.getCode();
+    result.symbols = symTable.getAllSymbols();
+    result.ast = astOut.str();
+    result.diagnostics = diagOut.str();
+    if (cache) {
+        result.hits = cache->getHits();
+        result.misses = cache->getMisses();
+    }
+    return result;
+}
+
+// Empty if equal, else the first difference
+std::string compare(const Compiled& cold, const Compiled& cached) {
+    if (cold.success != cached.success) {
+        return "parse result differs";
+    }
+    if (cold.diagnostics != cached.diagnostics) {
+        return "diagnostics differ:\n--- cold\n" + cold.diagnostics + "--- cached\n" + cached.diagnostics;
+    }
+    if (cold.code.size() != cached.code.size()) {
+        return "code size " + std::to_string(cold.code.size()) + " != " + std::to_string(cached.code.size());
+    }
+    for (size_t i = 0; i < cold.code.size(); i++) {
+        const pl0::Instruction& a = cold.code[i];
+        const pl0::Instruction& b = cached.code[i];
+        if (a.op != b.op || a.L != b.L || a.A != b.A || a.line != b.line) {
+            std::ostringstream msg;
+            msg << "instruction " << i << ": " << pl0::opCodeToString(a.op) << " " << a.L << ", " << a.A
+                << " (line " << a.line << ") != " << pl0::opCodeToString(b.op) << " " << b.L << ", " << b.A
+                << " (line " << b.line << ")";
+            return msg.str();
+        }
+    }
+    if (cold.symbols.size() != cached.symbols.size()) {
+        return "symbol history size " + std::to_string(cold.symbols.size()) + " != "
+             + std::to_string(cached.symbols.size());
+    }
+    for (size_t i = 0; i < cold.symbols.size(); i++) {
+        const pl0::Symbol& a = cold.symbols[i];
+        const pl0::Symbol& b = cached.symbols[i];
+        if (a.name != b.name || a.kind != b.kind || a.level != b.level || a.address != b.address
+            || a.value != b.value || a.size != b.size || a.paramCount != b.paramCount) {
+            std::ostringstream msg;
+            msg << "symbol " << i << ": " << a.name << " " << pl0::symbolKindToString(a.kind) << " level "
+                << a.level << " address " << a.address << " != " << b.name << " "
+                << pl0::symbolKindToString(b.kind) << " level " << b.level << " address " << b.address;
+            return msg.str();
+        }
+    }
+    if (cold.ast != cached.ast) {
+        return "AST text differs";
+    }
+    return std::string();
+}
+
+struct Version {
+    const char* description;
+    std::string source;
+    int minHits;            // Procedures that must be reused
+    bool valid = true;      // Expected to compile
+};
+
+// @HEAD@ / @LEAF@ / @MID@ are replaced per version
+const char* const TEMPLATE = R"(program edit;
+@HEAD@
+procedure leaf(n);
+begin
+  @LEAF@
+end;
+procedure mid(n);
+  var x;
+  procedure inner(k);
+    var x;
+  begin
+    x := k * 2;
+    call leaf(x);
+    if k > 0 then call inner(k - 1)
+  end;
+begin
+  x := n;
+  @MID@
+  call inner(x)
+end;
+procedure top();
+  var i;
+begin
+  for i := 1 to 3 do
+  begin
+    call mid(i);
+    call leaf(i + limit)
+  end;
+  write(total)
+end;
+begin
+  total := 0;
+  call top();
+  write(total)
+end
+)";
+
+std::string instantiate(const std::string& head, const std::string& leaf, const std::string& mid) {
+    std::string text = TEMPLATE;
+    auto replace = [&text](const std::string& key, const std::string& value) {
+        size_t at = text.find(key);
+        text.replace(at, key.size(), value);
+    };
+    replace("@HEAD@", head);
+    replace("@LEAF@", leaf);
+    replace("@MID@", mid);
+    return text;
+}
+
+} // namespace
+
+int main() {
+    const std::string head = "const limit := 10;\nvar total, scratch;";
+    const std::string leaf = "total := total + n";
+    const std::string mid = "x := x + 1;";
+
+    std::vector<Version> versions = {
+        {"initial compile", instantiate(head, leaf, mid), 0},
+        {"unchanged", instantiate(head, leaf, mid), 3},
+        {"leaf grows (callers relinked)", instantiate(head, "scratch := n * n;\n  total := total + n", mid), 2},
+        {"mid edited", instantiate(head, "scratch := n * n;\n  total := total + n", "x := x + 2;\n  x := x - 1;"), 2},
+        {"global inserted before total", instantiate("const limit := 10;\nvar first, total, scratch;", leaf, mid), 1},
+        {"constant changed", instantiate("const limit := 11;\nvar first, total, scratch;", leaf, mid), 2},
+        {"procedure made erroneous", instantiate(head, "total := total + undefined", mid), 0, false},
+        {"error fixed", instantiate(head, leaf, mid), 0},
+        {"leaf shrinks", instantiate(head, "", mid), 2},
+    };
+
+    pl0::ProcedureCache cache;
+    int failures = 0;
+    int totalHits = 0;
+    for (const Version& version : versions) {
+        Compiled cold = compile(version.source, nullptr);
+        Compiled cached = compile(version.source, &cache);
+        std::string diff = compare(cold, cached);
+        totalHits += cached.hits;
+        std::cout << version.description << ": " << cached.hits << " reused, " << cached.misses
+                  << " compiled";
+        if (cold.success != version.valid) {
+            std::cout << (cold.success ? " - compiled, expected errors\n" : " - compile errors:\n")
+                      << cold.diagnostics;
+            failures++;
+        } else if (!diff.empty()) {
+            std::cout << " - MISMATCH: " << diff << "\n";
+            failures++;
+        } else if (cached.hits < version.minHits) {
+            std::cout << " - expected at least " << version.minHits << " reused\n";
+            failures++;
+        } else {
+            std::cout << " - OK\n";
+        }
+    }
+    if (totalHits == 0) {
+        std::cout << "the cache was never used\n";
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
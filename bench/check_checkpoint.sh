@@ -0,0 +1,141 @@
+#!/usr/bin/env bash
+# Round trip of --checkpoint-every with --output-file: a job cut short by
+# --timeout and resumed (repeatedly) must write exactly what an
+# uninterrupted run writes, in text and binary format. A checkpoint that
+# cannot be used (other snapshot version, other program, truncated, or an
+# output file shorter than the checkpoint says) must be ignored with a
+# warning, and the run must start over and still write the same output.
+#
+# Usage: bench/check_checkpoint.sh [pl0c] [timeout-ms]
+#   pl0c        compiler binary (default: build/pl0c)
+#   timeout-ms  --timeout of each interrupted run (default: 50)
+#
+# Exits non-zero if any check fails. Registered with ctest.
+
+set -euo pipefail
+
+PL0C=${1:-build/pl0c}
+TIMEOUT=${2:-50}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Some work between writes, so that runs stop anywhere in between
+cat > "$WORK/job.pl0" <<'EOF'
+program job;
+var i, j, s;
+begin
+  i := 1;
+  while i <= 40 do
+  begin
+    j := 0;
+    s := 0;
+    while j < 100000 do
+    begin
+      s := s + j mod 7;
+      j := j + 1
+    end;
+    write(i * 1000 + s mod 1000);
+    i := i + 1
+  end
+end
+EOF
+# Same shape, different code
+sed 's/j mod 7/j mod 5/' "$WORK/job.pl0" > "$WORK/other.pl0"
+
+status=0
+
+# pl0c <program> with checkpointing into $WORK/job.ckpt and output to $WORK/actual
+run_job() {
+    local program=$1 format=$2
+    shift 2
+    "$PL0C" "$program" --no-color --io-format "$format" --output-file "$WORK/actual" \
+        --checkpoint-every 100000 --checkpoint "$WORK/job.ckpt" "$@"
+}
+
+# Interrupt runs of job.pl0 until a checkpoint exists
+make_checkpoint() {
+    local format=$1 tries=0
+    rm -f "$WORK/job.ckpt" "$WORK/actual"
+    while [ ! -f "$WORK/job.ckpt" ]; do
+        tries=$((tries + 1))
+        if [ "$tries" -ge 20 ]; then
+            echo "$format: no checkpoint written"
+            exit 1
+        fi
+        run_job "$WORK/job.pl0" "$format" --timeout "$TIMEOUT" > /dev/null 2>&1 || true
+    done
+}
+
+# check <name> <expected file>: $WORK/actual must match
+check() {
+    if cmp -s "$2" "$WORK/actual"; then
+        echo "$1: OK"
+    else
+        echo "$1: output differs"
+        status=1
+    fi
+}
+
+# rejected <name> <program> <format> <warning> [loads]: the run ignores the
+# checkpoint with <warning> and writes the output of an uninterrupted run.
+# loads: the snapshot itself is valid and is loaded before being dropped.
+rejected() {
+    local name=$1 program=$2 format=$3 warning=$4 loads=${5:-}
+    run_job "$program" "$format" > /dev/null 2> "$WORK/stderr" || true
+    if ! grep -q -- "$warning" "$WORK/stderr"; then
+        echo "$name: expected warning '$warning', got:"
+        cat "$WORK/stderr"
+        status=1
+        return
+    fi
+    if [ -z "$loads" ] && grep -q "Resuming" "$WORK/stderr"; then
+        echo "$name: resumed from an unusable checkpoint"
+        status=1
+        return
+    fi
+    check "$name" "$WORK/expected-$(basename "$program" .pl0)"
+}
+
+for format in text binary; do
+    for program in job other; do
+        "$PL0C" "$WORK/$program.pl0" --no-color --io-format "$format" \
+            --output-file "$WORK/expected-$program" > /dev/null
+    done
+
+    # Resume until the job completes
+    rm -f "$WORK/job.ckpt" "$WORK/actual"
+    runs=0
+    while :; do
+        runs=$((runs + 1))
+        run_job "$WORK/job.pl0" "$format" --timeout "$TIMEOUT" > /dev/null 2>&1 || true
+        [ -f "$WORK/job.ckpt" ] || break
+        if [ "$runs" -ge 1000 ]; then
+            echo "$format: no progress after $runs runs"
+            exit 1
+        fi
+    done
+    check "$format resume ($runs runs)" "$WORK/expected-job"
+
+    # Snapshot version field (after the 8-byte magic) from an older release
+    make_checkpoint "$format"
+    printf '\001\000\000\000' | dd of="$WORK/job.ckpt" bs=1 seek=8 conv=notrunc status=none
+    rejected "$format old snapshot version" "$WORK/job.pl0" "$format" "unsupported snapshot version"
+
+    # Checkpoint of job.pl0 offered to other.pl0
+    make_checkpoint "$format"
+    rejected "$format other program" "$WORK/other.pl0" "$format" "different program"
+
+    # Checkpoint cut short while writing
+    make_checkpoint "$format"
+    size=$(wc -c < "$WORK/job.ckpt")
+    truncate -s $((size / 2)) "$WORK/job.ckpt"
+    rejected "$format truncated snapshot" "$WORK/job.pl0" "$format" "truncated snapshot"
+
+    # Output file lost its tail after the checkpoint was taken
+    make_checkpoint "$format"
+    if [ -s "$WORK/actual" ]; then
+        truncate -s 0 "$WORK/actual"
+        rejected "$format short output file" "$WORK/job.pl0" "$format" "starting over" loads
+    fi
+done
+exit $status
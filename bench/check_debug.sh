@@ -0,0 +1,248 @@
+#!/usr/bin/env bash
+# Scripted --debug sessions: commands are fed to the REPL on stdin, and the
+# transcript from the first prompt on must match the expected one. Store
+# addresses depend on the word size and heap layout and are blanked, and
+# trailing blanks (after prompts) are dropped.
+#
+# Usage: bench/check_debug.sh [pl0c]
+#   pl0c  compiler binary (default: build/pl0c)
+#
+# Exits non-zero if any session differs. Registered with ctest.
+
+set -euo pipefail
+
+PL0C=${1:-build/pl0c}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+status=0
+
+# session <name> <program> <commands> [pl0c options]; expected transcript on stdin
+session() {
+    local name=$1 program=$2 commands=$3
+    shift 3
+    cat > "$WORK/expected"
+    printf '%s\n' "$commands" | "$PL0C" "$program" --debug --no-color "$@" 2>&1 \
+        | sed -n '/^(debug L/,$p' | sed -e 's/========== Execution Complete.*//' \
+              -e 's/(address [0-9]*)/(address N)/g' -e 's/ *$//' > "$WORK/actual"
+    if diff -u "$WORK/expected" "$WORK/actual" > "$WORK/diff"; then
+        echo "$name: OK"
+    else
+        echo "$name: transcript differs"
+        cat "$WORK/diff"
+        status=1
+    fi
+}
+
+# x is declared at every level; inner reads outer's y through the static chain
+cat > "$WORK/shadow.pl0" <<'EOF'
+program shadow;
+var x, y;
+procedure outer();
+  var x, y;
+  procedure inner();
+    var x;
+  begin
+    x := 3;
+    write(x + y)
+  end;
+begin
+  x := 2;
+  y := 20;
+  call inner();
+  write(x)
+end;
+begin
+  x := 1;
+  y := 10;
+  call outer();
+  write(x)
+end
+EOF
+
+session "shadowed variables" "$WORK/shadow.pl0" "b 9
+b 15
+b 21
+r
+p x
+p y
+c
+p x
+p y
+c
+p x
+p y
+c
+q" <<'EOF'
+(debug L1)> Breakpoint set at line 9
+(debug L1)> Breakpoint set at line 15
+(debug L1)> Breakpoint set at line 21
+(debug L1)> Breakpoint hit at line 9
+(debug L9)> x = 3
+(debug L9)> y = 20
+(debug L9)> 23
+Breakpoint hit at line 15
+(debug L15)> x = 2
+(debug L15)> y = 20
+(debug L15)> 2
+Breakpoint hit at line 21
+(debug L21)> x = 1
+(debug L21)> y = 10
+(debug L21)> 1
+Program terminated (rs/rc to go back, q to quit).
+(debug L1)>
+EOF
+
+# Heap cell watched through a pointer, next to a stack variable; the block
+# is freed while watched
+cat > "$WORK/heap.pl0" <<'EOF'
+program heap;
+var n, p: pointer;
+begin
+  new(p, 4);
+  *p := 7;
+  n := 1;
+  *p := 8;
+  delete(p);
+  write(n)
+end
+EOF
+
+session "heap watchpoints" "$WORK/heap.pl0" "b 5
+r
+w *p
+w n
+c
+w
+c
+c
+c
+c
+q" <<'EOF'
+(debug L1)> Breakpoint set at line 5
+(debug L1)> Breakpoint hit at line 5
+(debug L5)> Watchpoint set on *p (address N)
+(debug L5)> Watchpoint set on n (address N)
+(debug L5)> Watchpoint *p (address N) at line 5: 0 -> 7
+(debug L6)>   *p (address N) = 7
+  n (address N) = 0
+(debug L6)> Watchpoint n (address N) at line 6: 0 -> 1
+(debug L7)> Watchpoint *p (address N) at line 7: 7 -> 8
+(debug L8)> Watchpoint *p (address N) at line 8: freed
+(debug L9)> 1
+Program terminated (rs/rc to go back, q to quit).
+(debug L1)>
+EOF
+
+# A read pauses the debugger until the next command; resuming must run it
+# once, popping the array element's address once
+cat > "$WORK/indirect.pl0" <<'EOF'
+program indirect;
+var a[3], k, t;
+begin
+  k := 7;
+  read(a[1]);
+  t := a[1] + k;
+  write(t)
+end
+EOF
+echo 5 > "$WORK/indirect.in"
+
+session "read into array element" "$WORK/indirect.pl0" "r
+p t
+c
+q" --input-file "$WORK/indirect.in" <<'EOF'
+(debug L1)> (debug L5)> t = 0
+(debug L5)> 12
+Program terminated (rs/rc to go back, q to quit).
+(debug L1)>
+EOF
+
+# Reverse execution across reads: stepping back over the second read and
+# running forward again must take 7 from the input log (the file would
+# give 11), reach the same variables as the first time, and leave the
+# output file as an uninterrupted run writes it
+cat > "$WORK/sum.pl0" <<'EOF'
+program sum;
+var i, x, s;
+begin
+  s := 0;
+  for i := 1 to 3 do
+  begin
+    read(x);
+    s := s + x * i;
+    write(s)
+  end;
+  write(s * 2)
+end
+EOF
+printf '5\n7\n11\n' > "$WORK/sum.in"
+
+session "reverse over reads" "$WORK/sum.pl0" "b 9
+r
+c
+c
+p i
+p x
+p s
+rs
+rs
+rs
+rs
+rs
+rs
+rs
+p i
+p x
+p s
+c
+p i
+p x
+p s
+rc
+p i
+p x
+p s
+c
+c
+c
+p i
+p x
+p s
+c
+q" --input-file "$WORK/sum.in" --output-file "$WORK/sum.out" <<'EOF'
+(debug L1)> Breakpoint set at line 9
+(debug L1)> (debug L7)> Breakpoint hit at line 9
+(debug L9)> Breakpoint hit at line 9
+(debug L9)> i = 2
+(debug L9)> x = 7
+(debug L9)> s = 19
+(debug L9)> (debug L8)> (debug L8)> (debug L8)> (debug L8)> (debug L8)> (debug L8)> (debug L7)> i = 2
+(debug L7)> x = 5
+(debug L7)> s = 5
+(debug L7)> Breakpoint hit at line 9
+(debug L9)> i = 2
+(debug L9)> x = 7
+(debug L9)> s = 19
+(debug L9)> Breakpoint hit at line 9
+(debug L9)> i = 1
+(debug L9)> x = 5
+(debug L9)> s = 5
+(debug L9)> Breakpoint hit at line 9
+(debug L9)> (debug L7)> Breakpoint hit at line 9
+(debug L9)> i = 3
+(debug L9)> x = 11
+(debug L9)> s = 52
+(debug L9)> Program terminated (rs/rc to go back, q to quit).
+(debug L1)>
+EOF
+
+"$PL0C" "$WORK/sum.pl0" --no-color --input-file "$WORK/sum.in" --output-file "$WORK/sum.expected" > /dev/null
+if cmp -s "$WORK/sum.expected" "$WORK/sum.out"; then
+    echo "reverse over reads, output file: OK"
+else
+    echo "reverse over reads, output file differs"
+    status=1
+fi
+
+exit $status
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Overhead of --check-overflow versus default (wrapping) execution.
+#
+# Usage: bench/check_overflow.sh [pl0c] [size] [runs]
+#   pl0c   compiler binary (default: build/pl0c; use a Release build)
+#   size   outer iterations of bench/arith.pl0 (default: 2000)
+#   runs   timed runs per mode, after one warmup run (default: 7)
+#
+# Prints the median user CPU time of each mode and the relative overhead.
+
+set -euo pipefail
+
+PL0C=${1:-build/pl0c}
+SIZE=${2:-2000}
+RUNS=${3:-7}
+PROGRAM="$(dirname "$0")/arith.pl0"
+
+# User CPU time of one run in milliseconds
+run_ms() {
+    local TIMEFORMAT=%3U seconds
+    seconds=$( { time echo "$SIZE" | "$PL0C" "$PROGRAM" --no-color "$@" > /dev/null 2>&1; } 2>&1 )
+    awk -v s="$seconds" 'BEGIN { printf "%d\n", s * 1000 }'
+}
+
+median() {
+    printf '%s\n' "$@" | sort -n | sed -n "$(( (RUNS + 1) / 2 ))p"
+}
+
+# Alternate the modes so frequency scaling and background load hit both alike
+run_ms > /dev/null
+run_ms --check-overflow > /dev/null
+plain_times=()
+checked_times=()
+for ((i = 0; i < RUNS; i++)); do
+    plain_times+=("$(run_ms)")
+    checked_times+=("$(run_ms --check-overflow)")
+done
+plain=$(median "${plain_times[@]}")
+checked=$(median "${checked_times[@]}")
+
+echo "arith.pl0 size=$SIZE runs=$RUNS"
+echo "  default:          ${plain} ms"
+echo "  --check-overflow: ${checked} ms"
+awk -v a="$plain" -v b="$checked" 'BEGIN { printf "  overhead:         %+.1f%%\n", a ? 100 * (b - a) / a : 0 }'
@@ -0,0 +1,435 @@
+// pl0_bench - reproducible phase timings of the PL/0 toolchain
+//
+// Compiles and runs each workload several times and reports the lexer,
+// parser, optimizer and VM phases separately (min / median / p99 / mean).
+// Workloads in bench/workloads are templates: "@N@" is replaced by the
+// problem size and "@N2@" by its square. The default size comes from a
+// "{ bench-size: <N> }" comment and is multiplied by --scale. Plain .pl0
+// files given on the command line run unchanged.
+
+#include "Common.h"
+#include "SourceManager.h"
+#include "Diagnostics.h"
+#include "CompilationContext.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SymbolTable.h"
+#include "Instruction.h"
+#include "Optimizer.h"
+#include "Interpreter.h"
+#include "IntStream.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+#ifndef PL0_BENCH_WORKLOADS
+#define PL0_BENCH_WORKLOADS "bench/workloads"
+#endif
+
+struct BenchOptions {
+    std::string workloadDir = PL0_BENCH_WORKLOADS;
+    std::vector<std::string> files;             // Extra programs, run as-is
+    std::map<std::string, long> sizes;          // --size name=N overrides
+    double scale = 1.0;
+    int warmup = 1;
+    int reps = 5;
+    bool optimize = false;                      // Run the VM on optimized code
+    std::string filter;
+    std::string jsonFile;                       // "-" = standard output
+    std::string label;
+};
+
+struct Workload {
+    std::string name;
+    std::string source;
+    long size = 0;                              // 0 for plain programs
+};
+
+struct Summary {
+    double min = 0;
+    double median = 0;
+    double p99 = 0;
+    double mean = 0;
+};
+
+// Phases in report order
+const char* const PHASES[] = {"lex", "parse", "optimize", "vm"};
+constexpr int PHASE_COUNT = 4;
+
+struct Result {
+    Workload workload;
+    uint64_t tokens = 0;
+    size_t codeSize = 0;
+    uint64_t instructions = 0;
+    std::vector<double> samples[PHASE_COUNT];   // Milliseconds per repetition
+    std::string error;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Summary summarize(std::vector<double> samples) {
+    Summary s;
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    s.min = samples.front();
+    s.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    // Nearest rank
+    size_t rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(n)));
+    s.p99 = samples[std::max<size_t>(rank, 1) - 1];
+    double total = 0;
+    for (double v : samples) total += v;
+    s.mean = total / static_cast<double>(n);
+    return s;
+}
+
+bool readFile(const std::string& path, std::string& text) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+long defaultSize(const std::string& text) {
+    size_t pos = text.find("bench-size:");
+    return pos == std::string::npos ? 1 : std::atol(text.c_str() + pos + 11);
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::vector<Workload> loadWorkloads(const BenchOptions& opts) {
+    std::vector<Workload> workloads;
+    std::vector<fs::path> templates;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(opts.workloadDir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".pl0") {
+            templates.push_back(entry.path());
+        }
+    }
+    if (ec && opts.files.empty()) {
+        std::cerr << "Error: cannot read workload directory " << opts.workloadDir << "\n";
+    }
+    std::sort(templates.begin(), templates.end());
+
+    for (const auto& path : templates) {
+        Workload w;
+        w.name = path.stem().string();
+        if (!readFile(path.string(), w.source)) continue;
+        auto it = opts.sizes.find(w.name);
+        w.size = it != opts.sizes.end()
+            ? it->second
+            : std::max(1L, std::lround(static_cast<double>(defaultSize(w.source)) * opts.scale));
+        replaceAll(w.source, "@N2@", std::to_string(w.size * w.size));
+        replaceAll(w.source, "@N@", std::to_string(w.size));
+        workloads.push_back(std::move(w));
+    }
+    for (const auto& file : opts.files) {
+        Workload w;
+        w.name = fs::path(file).stem().string();
+        if (!readFile(file, w.source)) {
+            std::cerr << "Error: cannot read " << file << "\n";
+            continue;
+        }
+        workloads.push_back(std::move(w));
+    }
+    if (!opts.filter.empty()) {
+        workloads.erase(std::remove_if(workloads.begin(), workloads.end(), [&](const Workload& w) {
+            return w.name.find(opts.filter) == std::string::npos;
+        }), workloads.end());
+    }
+    return workloads;
+}
+
+// One repetition of every phase. Returns false (with result.error) if the
+// program does not compile or fails at run time.
+bool runOnce(const BenchOptions& opts, Result& result, bool record) {
+    const std::string& source = result.workload.source;
+    pl0::SourceManager srcMgr;
+    srcMgr.loadString(source, result.workload.name + ".pl0");
+    std::ostringstream diagOut;
+    pl0::DiagnosticsEngine diag(srcMgr, diagOut);
+    diag.setUseColor(false);
+
+    // Lexer alone
+    auto start = Clock::now();
+    uint64_t tokens = 0;
+    {
+        pl0::CompilationContext context(source.size());
+        pl0::Lexer lexer(source, diag, context);
+        while (lexer.nextToken().type != pl0::TokenType::END_OF_FILE) {
+            tokens++;
+        }
+    }
+    double lexMs = elapsedMs(start);
+
+    // Parser with code generation (it drives its own lexer)
+    start = Clock::now();
+    auto context = std::make_shared<pl0::CompilationContext>(source.size() + source.size() / 8);
+    pl0::Lexer lexer(source, diag, *context);
+    pl0::SymbolTable symTable(context);
+    pl0::CodeGenerator codeGen;
+    pl0::Parser parser(lexer, symTable, codeGen, diag);
+    parser.parse();
+    double parseMs = elapsedMs(start);
+    if (diag.getErrorCount() > 0) {
+        result.error = "compilation failed:\n" + diagOut.str();
+        return false;
+    }
+
+    start = Clock::now();
+    pl0::Optimizer optimizer;
+    std::vector<pl0::Instruction> optimized = optimizer.optimize(codeGen.getCode());
+    double optimizeMs = elapsedMs(start);
+
+    // VM with batch I/O into memory; no input is provided
+    const std::vector<pl0::Instruction>& code = opts.optimize ? optimized : codeGen.getCode();
+    std::istringstream noInput;
+    std::ostringstream programOut;
+    std::ostringstream programErr;
+    pl0::StreamIntReader reader(noInput);
+    pl0::StreamIntWriter writer(programOut);
+    pl0::Interpreter interpreter(code);
+    interpreter.setStreams(noInput, programOut, programErr);
+    interpreter.setIntReader(&reader);
+    interpreter.setIntWriter(&writer);
+    start = Clock::now();
+    interpreter.run();
+    writer.flush();
+    double vmMs = elapsedMs(start);
+    if (interpreter.hasError()) {
+        result.error = "runtime error: " + interpreter.getError();
+        return false;
+    }
+
+    result.tokens = tokens;
+    result.codeSize = code.size();
+    result.instructions = interpreter.getInstructionCount();
+    if (record) {
+        double times[PHASE_COUNT] = {lexMs, parseMs, optimizeMs, vmMs};
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            result.samples[p].push_back(times[p]);
+        }
+    }
+    return true;
+}
+
+void printTable(const std::vector<Result>& results, std::ostream& out) {
+    out << std::left << std::setw(14) << "workload" << std::right
+        << std::setw(9) << "size" << std::setw(13) << "instructions";
+    for (const char* phase : PHASES) {
+        out << std::setw(23) << (std::string(phase) + " ms (med/p99)");
+    }
+    out << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (const Result& r : results) {
+        out << std::left << std::setw(14) << r.workload.name << std::right
+            << std::setw(9) << (r.workload.size ? std::to_string(r.workload.size) : "-");
+        if (!r.error.empty()) {
+            out << "  FAILED: " << r.error << "\n";
+            continue;
+        }
+        out << std::setw(13) << r.instructions;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            Summary s = summarize(r.samples[p]);
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(3) << s.median << "/" << s.p99;
+            out << std::setw(23) << cell.str();
+        }
+        out << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+void writeJson(const BenchOptions& opts, const std::vector<Result>& results, std::ostream& out) {
+    out << "{\"label\":\"" << jsonEscape(opts.label) << "\""
+        << ",\"wordBits\":" << pl0::WORD_BITS
+        << ",\"optimize\":" << (opts.optimize ? "true" : "false")
+        << ",\"scale\":" << opts.scale
+        << ",\"warmup\":" << opts.warmup
+        << ",\"reps\":" << opts.reps
+        << ",\"workloads\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i ? "," : "") << "\n  {\"name\":\"" << jsonEscape(r.workload.name) << "\""
+            << ",\"size\":" << r.workload.size;
+        if (!r.error.empty()) {
+            out << ",\"error\":\"" << jsonEscape(r.error) << "\"}";
+            continue;
+        }
+        out << ",\"tokens\":" << r.tokens
+            << ",\"codeSize\":" << r.codeSize
+            << ",\"instructions\":" << r.instructions
+            << ",\"phases\":{";
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            Summary s = summarize(r.samples[p]);
+            out << (p ? "," : "") << "\"" << PHASES[p] << "\":{"
+                << "\"minMs\":" << s.min << ",\"medianMs\":" << s.median
+                << ",\"p99Ms\":" << s.p99 << ",\"meanMs\":" << s.mean << "}";
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] [extra.pl0 ...]\n\n"
+              << "Times the lexer, parser (incl. code generation), optimizer and VM on\n"
+              << "the scalable workloads and on any extra programs.\n\n"
+              << "Options:\n"
+              << "  --workloads <dir>   Workload templates (default: " << PL0_BENCH_WORKLOADS << ")\n"
+              << "  --scale <F>         Multiply every default problem size by F (default: 1)\n"
+              << "  --size <name>=<N>   Problem size of one workload\n"
+              << "  --filter <text>     Only workloads whose name contains text\n"
+              << "  --warmup <N>        Untimed runs per workload (default: 1)\n"
+              << "  --reps <N>          Timed runs per workload (default: 5)\n"
+              << "  -O, --optimize      Run the VM on optimized code\n"
+              << "  --json <f>          Write results as JSON to f (- = stdout)\n"
+              << "  --label <text>      Tag stored in the JSON (e.g. a commit id)\n"
+              << "  -h, --help          Show this help\n";
+}
+
+bool parseCount(const std::string& text, long min, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= min;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        long count = 0;
+        bool takesValue = arg == "--workloads" || arg == "--scale" || arg == "--size" ||
+                          arg == "--filter" || arg == "--warmup" || arg == "--reps" ||
+                          arg == "--json" || arg == "--label";
+        if (takesValue) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a value\n";
+                return 4;
+            }
+            i++;
+        }
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--workloads") {
+            opts.workloadDir = value;
+        } else if (arg == "--scale") {
+            char* end = nullptr;
+            opts.scale = std::strtod(value.c_str(), &end);
+            if (*end != '\0' || !(opts.scale > 0)) {
+                std::cerr << "Error: invalid scale '" << value << "'\n";
+                return 4;
+            }
+        } else if (arg == "--size") {
+            size_t eq = value.find('=');
+            if (eq == std::string::npos || !parseCount(value.substr(eq + 1), 1, count)) {
+                std::cerr << "Error: --size expects <name>=<N>, got '" << value << "'\n";
+                return 4;
+            }
+            opts.sizes[value.substr(0, eq)] = count;
+        } else if (arg == "--filter") {
+            opts.filter = value;
+        } else if (arg == "--warmup" || arg == "--reps") {
+            if (!parseCount(value, arg == "--reps" ? 1 : 0, count)) {
+                std::cerr << "Error: invalid count for " << arg << ": '" << value << "'\n";
+                return 4;
+            }
+            (arg == "--reps" ? opts.reps : opts.warmup) = static_cast<int>(count);
+        } else if (arg == "-O" || arg == "--optimize") {
+            opts.optimize = true;
+        } else if (arg == "--json") {
+            opts.jsonFile = value;
+        } else if (arg == "--label") {
+            opts.label = value;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 4;
+        } else {
+            opts.files.push_back(arg);
+        }
+    }
+
+    std::vector<Workload> workloads = loadWorkloads(opts);
+    if (workloads.empty()) {
+        std::cerr << "Error: no workloads to run\n";
+        return 2;
+    }
+
+    // Progress goes to stderr so "--json -" stays machine-readable
+    std::vector<Result> results;
+    bool failed = false;
+    for (Workload& w : workloads) {
+        std::cerr << "running " << w.name << "..." << std::flush;
+        Result result;
+        result.workload = std::move(w);
+        bool ok = true;
+        for (int i = 0; ok && i < opts.warmup; i++) {
+            ok = runOnce(opts, result, false);
+        }
+        for (int i = 0; ok && i < opts.reps; i++) {
+            ok = runOnce(opts, result, true);
+        }
+        failed = failed || !ok;
+        std::cerr << (ok ? " done\n" : " failed\n");
+        results.push_back(std::move(result));
+    }
+
+    if (opts.jsonFile == "-") {
+        writeJson(opts, results, std::cout);
+    } else {
+        printTable(results, std::cout);
+        if (!opts.jsonFile.empty()) {
+            std::ofstream json(opts.jsonFile);
+            if (json) {
+                writeJson(opts, results, json);
+            }
+            if (!json) {
+                std::cerr << "Error: cannot write " << opts.jsonFile << "\n";
+                return 2;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
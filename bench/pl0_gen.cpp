@@ -0,0 +1,466 @@
+// pl0_gen - synthetic PL/0 programs for compiler stress tests
+//
+// Emits a valid, terminating program whose shape is set on the command
+// line: number of procedures (or a target line count), procedure nesting
+// depth, expression depth, arrays and loop nesting. Output is a pure
+// function of the options and --seed, so a generated file can be
+// regenerated instead of checked in.
+//
+// Calls only happen while a global "fuel" counter is positive and every
+// procedure decrements it on entry, so the number of activations (including
+// recursion) is bounded and the program also runs under pl0c / pl0_bench. Divisors and array indices
+// are built so that they can never trap.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+struct GenOptions {
+    int procs = 100;            // Total procedures (ignored with --lines)
+    long lines = 0;             // Target line count; 0: use procs
+    int depth = 3;              // Procedure nesting levels
+    int stmts = 8;              // Statements per procedure body
+    int exprDepth = 3;
+    int loops = 2;              // Loop nesting
+    int arrays = 1;             // Local arrays per procedure
+    int params = 2;             // Maximum parameters per procedure
+    int fuel = 10000;           // Bound on procedure activations
+    uint32_t seed = 1;
+    std::string output;         // Empty: standard output
+};
+
+constexpr int ARRAY_SIZE = 16;
+constexpr int LOCALS = 4;       // Scalars x0..x3 in every procedure
+constexpr int GLOBALS = 4;      // g0..g3
+constexpr int CONSTANTS = 4;    // K0..K3
+
+class Generator {
+public:
+    Generator(const GenOptions& opts, std::ostream& out) : opts_(opts), out_(out), rng_(opts.seed) {}
+
+    // Returns the number of lines written
+    long generate(const std::string& commandLine);
+
+private:
+    struct Proc {
+        std::string name;
+        int params;
+    };
+
+    // Names visible in one procedure (or the program block)
+    struct Scope {
+        std::vector<std::string> scalars;       // Readable
+        std::vector<std::string> assignable;
+        std::vector<std::string> arrays;
+        std::vector<Proc> procs;                // Declared so far, callable
+        int params = 0;
+    };
+
+    // mt19937 output is fully specified, unlike the std distributions, so
+    // the same seed gives the same program with every standard library
+    uint32_t pick(uint32_t n) { return n ? rng_() % n : 0; }
+    bool chance(uint32_t percent) { return pick(100) < percent; }
+
+    // Uniform choice among the items of all enclosing scopes, innermost
+    // included; nullptr if there are none. No copies: the program scope can
+    // hold tens of thousands of procedures.
+    template <class T>
+    const T* pickVisible(std::vector<T> Scope::*items);
+
+    // Output is one line behind so that a statement separator can still be
+    // appended to the last line of a statement
+    void line(const std::string& text);
+    void terminate() { pending_ += ";"; }
+    void flush();
+
+    void procedure(int level);
+    void body(int level);
+    void statement(int loopDepth, int nesting);
+    void statementList(int count, int loopDepth, int nesting);
+
+    std::string expr(int depth);
+    std::string leaf();
+    std::string element(const std::string& array);
+    std::string condition();
+
+
+    const GenOptions& opts_;
+    std::ostream& out_;
+    std::mt19937 rng_;
+    std::vector<Scope> scopes_;
+    std::string pending_;
+    bool hasPending_ = false;
+    int indent_ = 0;
+    long lines_ = 0;
+    int procCount_ = 0;
+};
+
+void Generator::line(const std::string& text) {
+    flush();
+    pending_.assign(static_cast<size_t>(indent_) * 2, ' ');
+    pending_ += text;
+    hasPending_ = true;
+}
+
+void Generator::flush() {
+    if (!hasPending_) return;
+    out_ << pending_ << '\n';
+    hasPending_ = false;
+    lines_++;
+}
+
+long Generator::generate(const std::string& commandLine) {
+    line("program generated;");
+    line("{ " + commandLine + " }");
+
+    std::string consts;
+    for (int i = 0; i < CONSTANTS; i++) {
+        consts += (i ? ", K" : "K") + std::to_string(i) + " := " + std::to_string(1 + pick(50));
+    }
+    line("const " + consts + ";");
+
+    Scope globals;
+    std::string vars;
+    for (int i = 0; i < GLOBALS; i++) {
+        std::string name = "g" + std::to_string(i);
+        globals.scalars.push_back(name);
+        globals.assignable.push_back(name);
+        vars += name + ", ";
+    }
+    for (int i = 0; i < CONSTANTS; i++) {
+        globals.scalars.push_back("K" + std::to_string(i));
+    }
+    globals.arrays.push_back("ga");
+    line("var " + vars + "ga[" + std::to_string(ARRAY_SIZE) + "], chk, fuel;");
+    scopes_.push_back(globals);
+
+    // Top-level procedures until the size target is met
+    while (opts_.lines > 0 ? lines_ < opts_.lines : procCount_ < opts_.procs) {
+        procedure(1);
+    }
+
+    line("begin");
+    indent_++;
+    line("chk := 0;");
+    line("fuel := " + std::to_string(opts_.fuel) + ";");
+    for (int i = 0; i < GLOBALS; i++) {
+        line("g" + std::to_string(i) + " := " + std::to_string(pick(100)) + ";");
+    }
+    for (const Proc& proc : scopes_.front().procs) {
+        std::string args;
+        for (int i = 0; i < proc.params; i++) {
+            args += (i ? ", " : "") + std::to_string(pick(100));
+        }
+        line("call " + proc.name + "(" + args + ");");
+    }
+    line("write(chk)");
+    indent_--;
+    line("end");
+    flush();
+    scopes_.clear();
+    return lines_;
+}
+
+void Generator::procedure(int level) {
+    Proc proc{"p" + std::to_string(procCount_++), static_cast<int>(pick(static_cast<uint32_t>(opts_.params) + 1))};
+    std::string params;
+    Scope scope;
+    scope.params = proc.params;
+    for (int i = 0; i < proc.params; i++) {
+        std::string name = "a" + std::to_string(i);
+        params += (i ? ", " : "") + name;
+        scope.scalars.push_back(name);
+    }
+    // Same local names at every level: inner procedures shadow outer ones
+    std::string vars;
+    for (int i = 0; i < LOCALS; i++) {
+        std::string name = "x" + std::to_string(i);
+        scope.scalars.push_back(name);
+        scope.assignable.push_back(name);
+        vars += name + ", ";
+    }
+    for (int i = 0; i < opts_.loops; i++) {
+        std::string name = "i" + std::to_string(i);
+        scope.scalars.push_back(name);
+        vars += name + ", ";
+    }
+    for (int i = 0; i < opts_.arrays; i++) {
+        std::string name = "t" + std::to_string(i);
+        scope.arrays.push_back(name);
+        vars += name + "[" + std::to_string(ARRAY_SIZE) + "], ";
+    }
+    vars.resize(vars.size() - 2);
+
+    line("procedure " + proc.name + "(" + params + ");");
+    line("var " + vars + ";");
+    scopes_.push_back(scope);
+
+    indent_++;
+    if (level < opts_.depth) {
+        int children = static_cast<int>(pick(3));
+        for (int i = 0; i < children && (opts_.lines > 0 || procCount_ < opts_.procs); i++) {
+            procedure(level + 1);
+        }
+    }
+    indent_--;
+
+    // Callable from its own body (recursion) but not from the nested
+    // procedures above: the code generator does not patch calls to an
+    // enclosing procedure whose entry address is not known yet
+    scopes_[scopes_.size() - 2].procs.push_back(proc);
+    body(level);
+    scopes_.pop_back();
+}
+
+void Generator::body(int level) {
+    const Scope& scope = scopes_.back();
+    line("begin");
+    indent_++;
+    line("fuel := fuel - 1;");
+    for (int i = 0; i < LOCALS; i++) {
+        std::string value = scope.params > 0 && i < scope.params
+            ? "a" + std::to_string(i)
+            : std::to_string(pick(100));
+        line("x" + std::to_string(i) + " := " + value + ";");
+    }
+    line("if fuel > 0 then begin");
+    indent_++;
+    statementList(opts_.stmts, 0, 0);
+    indent_--;
+    line("end;");
+    line("chk := (chk + x0 + x" + std::to_string(LOCALS - 1) + " + " + std::to_string(level) + ") mod 1000003");
+    indent_--;
+    line("end;");
+}
+
+void Generator::statementList(int count, int loopDepth, int nesting) {
+    for (int i = 0; i < count; i++) {
+        statement(loopDepth, nesting);
+        if (i + 1 < count) terminate();
+    }
+}
+
+void Generator::statement(int loopDepth, int nesting) {
+    bool canNest = nesting < 3;
+
+    for (;;) {
+        uint32_t kind = pick(100);
+        if (kind < 30) {
+            line(*pickVisible(&Scope::assignable) + " := " + expr(opts_.exprDepth));
+        } else if (kind < 45) {
+            const std::string* array = pickVisible(&Scope::arrays);
+            if (!array) continue;
+            line(element(*array) + " := " + expr(opts_.exprDepth));
+        } else if (kind < 60) {
+            if (!canNest) continue;
+            line("if " + condition() + " then begin");
+            indent_++;
+            statementList(1 + static_cast<int>(pick(2)), loopDepth, nesting + 1);
+            indent_--;
+            if (chance(50)) {
+                line("end else begin");
+                indent_++;
+                statementList(1 + static_cast<int>(pick(2)), loopDepth, nesting + 1);
+                indent_--;
+            }
+            line("end");
+        } else if (kind < 70) {
+            if (loopDepth >= opts_.loops || !canNest) continue;
+            std::string counter = "i" + std::to_string(loopDepth);
+            line(counter + " := 0;");
+            line("while " + counter + " < " + std::to_string(2 + pick(3)) + " do begin");
+            indent_++;
+            statementList(1 + static_cast<int>(pick(3)), loopDepth + 1, nesting + 1);
+            terminate();
+            line(counter + " := " + counter + " + 1");
+            indent_--;
+            line("end");
+        } else if (kind < 80) {
+            if (loopDepth >= opts_.loops || !canNest) continue;
+            line("for i" + std::to_string(loopDepth) + " := 1 to " + std::to_string(2 + pick(3)) + " do begin");
+            indent_++;
+            statementList(1 + static_cast<int>(pick(3)), loopDepth + 1, nesting + 1);
+            indent_--;
+            line("end");
+        } else if (kind < 95) {
+            const Proc* proc = pickVisible(&Scope::procs);
+            if (!proc) continue;
+            std::string args;
+            for (int i = 0; i < proc->params; i++) {
+                args += (i ? ", " : "") + expr(opts_.exprDepth > 1 ? 1 : 0);
+            }
+            line("if fuel > 0 then call " + proc->name + "(" + args + ")");
+        } else {
+            if (!canNest) continue;
+            line("begin");
+            indent_++;
+            statementList(2, loopDepth, nesting + 1);
+            indent_--;
+            line("end");
+        }
+        return;
+    }
+}
+
+std::string Generator::expr(int depth) {
+    if (depth <= 0 || chance(20)) return leaf();
+
+    // One operand at full depth, the other shallower to keep sizes linear
+    std::string left = expr(depth - 1);
+    std::string right = expr(static_cast<int>(pick(static_cast<uint32_t>(depth))));
+    switch (pick(7)) {
+        case 0: return "(" + left + " + " + right + ")";
+        case 1: return "(" + left + " - " + right + ")";
+        case 2: return "(" + left + " * " + right + ")";
+        // Divisor in [2, 14]: leaf mod 7 is in [-6, 6]
+        case 3: return "(" + left + " / (" + leaf() + " mod 7 + 8))";
+        case 4: return "(" + left + " mod (" + leaf() + " mod 7 + 8))";
+        case 5: return "(-" + left + ")";
+        default: return "(" + left + " + " + right + " * " + std::to_string(pick(10)) + ")";
+    }
+}
+
+std::string Generator::leaf() {
+    uint32_t kind = pick(10);
+    if (kind < 2) return std::to_string(pick(1000));
+    if (kind < 3) {
+        if (const std::string* array = pickVisible(&Scope::arrays)) return element(*array);
+    }
+    return *pickVisible(&Scope::scalars);
+}
+
+std::string Generator::element(const std::string& array) {
+    if (chance(30)) return array + "[" + std::to_string(pick(ARRAY_SIZE)) + "]";
+    // Any integer maps into [0, ARRAY_SIZE)
+    std::string size = std::to_string(ARRAY_SIZE);
+    return array + "[(" + *pickVisible(&Scope::scalars) + " mod " + size + " + " + size + ") mod " + size + "]";
+}
+
+std::string Generator::condition() {
+    if (chance(10)) return "odd " + expr(1);
+    static const char* const OPERATORS[] = {"=", "<>", "<", "<=", ">", ">="};
+    return expr(opts_.exprDepth > 1 ? 2 : 1) + " " + OPERATORS[pick(6)] + " " + expr(1);
+}
+
+template <class T>
+const T* Generator::pickVisible(std::vector<T> Scope::*items) {
+    size_t total = 0;
+    for (const Scope& scope : scopes_) {
+        total += (scope.*items).size();
+    }
+    if (total == 0) return nullptr;
+    size_t index = pick(static_cast<uint32_t>(total));
+    for (const Scope& scope : scopes_) {
+        if (index < (scope.*items).size()) return &(scope.*items)[index];
+        index -= (scope.*items).size();
+    }
+    return nullptr;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n\n"
+              << "Writes a random but valid and terminating PL/0 program.\n\n"
+              << "Options:\n"
+              << "  --procs <N>         Number of procedures (default: 100)\n"
+              << "  --lines <N>         Generate procedures until the program has N lines\n"
+              << "  --depth <N>         Procedure nesting levels (default: 3)\n"
+              << "  --stmts <N>         Statements per procedure body (default: 8)\n"
+              << "  --expr-depth <N>    Expression nesting (default: 3)\n"
+              << "  --loops <N>         Loop nesting (default: 2)\n"
+              << "  --arrays <N>        Arrays per procedure (default: 1)\n"
+              << "  --params <N>        Maximum parameters per procedure (default: 2)\n"
+              << "  --fuel <N>          Bound on procedure activations at run time (default: 10000)\n"
+              << "  --seed <N>          Random seed (default: 1)\n"
+              << "  -o <file>           Output file (default: stdout)\n"
+              << "  -h, --help          Show this help\n";
+}
+
+bool parseNumber(const std::string& text, long min, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= min;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GenOptions opts;
+    std::string commandLine = "generated by pl0_gen";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << (arg[0] == '-' ? arg + " requires a value" : "unexpected argument " + arg) << "\n";
+            return 4;
+        }
+        std::string value = argv[++i];
+        if (arg == "-o") {
+            opts.output = value;
+            continue;
+        }
+
+        long number = 0;
+        struct { const char* name; long min; } const LIMITS[] = {
+            {"--procs", 1}, {"--lines", 1}, {"--depth", 1}, {"--stmts", 1}, {"--expr-depth", 0},
+            {"--loops", 0}, {"--arrays", 0}, {"--params", 0}, {"--fuel", 1}, {"--seed", 0}
+        };
+        bool known = false;
+        for (const auto& limit : LIMITS) {
+            if (arg != limit.name) continue;
+            known = true;
+            if (!parseNumber(value, limit.min, number) || number > 1000000000L) {
+                std::cerr << "Error: invalid value for " << arg << ": '" << value << "'\n";
+                return 4;
+            }
+        }
+        if (!known) {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 4;
+        }
+        commandLine += " " + arg + " " + value;
+
+        int n = static_cast<int>(number);
+        if (arg == "--procs") opts.procs = n;
+        else if (arg == "--lines") opts.lines = number;
+        else if (arg == "--depth") opts.depth = n;
+        else if (arg == "--stmts") opts.stmts = n;
+        else if (arg == "--expr-depth") opts.exprDepth = n;
+        else if (arg == "--loops") opts.loops = n;
+        else if (arg == "--arrays") opts.arrays = n;
+        else if (arg == "--params") opts.params = n;
+        else if (arg == "--fuel") opts.fuel = n;
+        else opts.seed = static_cast<uint32_t>(number);
+    }
+
+    std::ofstream file;
+    if (!opts.output.empty()) {
+        file.open(opts.output);
+        if (!file) {
+            std::cerr << "Error: cannot write " << opts.output << "\n";
+            return 2;
+        }
+    }
+    std::ostream& out = opts.output.empty() ? std::cout : file;
+
+    Generator generator(opts, out);
+    long lines = generator.generate(commandLine);
+    out.flush();
+    if (!out) {
+        std::cerr << "Error: write failed\n";
+        return 2;
+    }
+    if (!opts.output.empty()) {
+        std::cerr << "wrote " << lines << " lines to " << opts.output << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Define before Qt headers to avoid keyword conflicts with 'emit'
+#ifndef QT_NO_KEYWORDS
+#define QT_NO_KEYWORDS
+#endif
+
+#include "BuildWorker.h"
+#include "../include/CompilationContext.h"
+#include "../include/Lexer.h"
+#include "../include/Parser.h"
+#include "../include/Interpreter.h"
+#include "../include/SourceManager.h"
+#include "../include/Diagnostics.h"
+
+#include <sstream>
+
+BuildWorker::BuildWorker(QObject* parent)
+    : QObject(parent)
+    , latestGeneration_(0)
+    , droppedOutput_(0)
+    , activeInterpreter_(nullptr)
+    , activeRun_(-1)
+    , cancelledRun_(-1)
+    , hasInput_(false)
+    , inputValue_(0)
+{
+}
+
+void BuildWorker::compile(int generation, const QString& source, const QString& fileName) {
+    // A newer request is already queued; skip straight to it
+    if (generation != latestGeneration_.load()) {
+        return;
+    }
+
+    CompileOutput result;
+    result.generation = generation;
+
+    std::string sourceStr = source.toUtf8().constData();
+
+    pl0::SourceManager srcMgr;
+    srcMgr.loadString(sourceStr, fileName.toStdString());
+    std::ostringstream diagCapture;
+    std::ostringstream astCapture;
+    pl0::DiagnosticsEngine diag(srcMgr, diagCapture);
+    diag.setUseColor(false);  // No color in GUI
+    pl0::CodeGenerator codeGen;
+    // The symbol table keeps the context (and so the symbol names) alive in the UI
+    auto context = std::make_shared<pl0::CompilationContext>(sourceStr.size() + sourceStr.size() / 8);
+    result.symbols = pl0::SymbolTable(context);
+    pl0::Lexer lexer(sourceStr, diag, *context);
+    pl0::Parser parser(lexer, result.symbols, codeGen, diag);
+    parser.setProcedureCache(&procCache_);
+    parser.enableAstDump(true);
+    parser.setAstOutput(astCapture);
+
+    result.success = parser.parse();
+    result.reusedProcedures = procCache_.getHits();
+    result.totalProcedures = procCache_.getHits() + procCache_.getMisses();
+
+    // Collect tokens for visualization (lexer errors were reported by the parse)
+    std::ostringstream ignored;
+    pl0::DiagnosticsEngine tokenDiag(srcMgr, ignored);
+    pl0::Lexer tokenCollector(sourceStr, tokenDiag, *context);
+    pl0::Token tok;
+    while ((tok = tokenCollector.nextToken()).type != pl0::TokenType::END_OF_FILE) {
+        if (tok.type != pl0::TokenType::UNKNOWN) {
+            result.tokens.push_back(std::make_tuple(
+                QString::fromStdString(pl0::tokenTypeToString(tok.type)),
+                QString::fromUtf8(tok.literal.data(), static_cast<int>(tok.literal.size())),
+                tok.line,
+                tok.column));
+        }
+    }
+
+    std::ostringstream symCapture;
+    result.symbols.dump(symCapture);
+
+    result.code = codeGen.getCode();
+    result.debugInfo.build(result.symbols, result.code);
+    result.diagnostics = QString::fromUtf8(diagCapture.str().c_str());
+    result.astText = QString::fromUtf8(astCapture.str().c_str());
+    result.symbolText = QString::fromUtf8(symCapture.str().c_str());
+
+    Q_EMIT compileFinished(result);
+}
+
+void BuildWorker::run(int runId, const QString& source, const QString& fileName) {
+    std::string sourceStr = source.toUtf8().constData();
+
+    pl0::SourceManager srcMgr;
+    srcMgr.loadString(sourceStr, fileName.toStdString());
+    std::ostringstream diagCapture;
+    pl0::DiagnosticsEngine diag(srcMgr, diagCapture);
+    diag.setUseColor(false);
+    auto context = std::make_shared<pl0::CompilationContext>(sourceStr.size() + sourceStr.size() / 8);
+    pl0::SymbolTable symTable(context);
+    pl0::CodeGenerator codeGen;
+    pl0::Lexer lexer(sourceStr, diag, *context);
+    pl0::Parser parser(lexer, symTable, codeGen, diag);
+    parser.setProcedureCache(&procCache_);
+
+    if (!parser.parse()) {
+        Q_EMIT runFinished(false, false, QString("Failed to recompile before running\n") 
+                                         + QString::fromUtf8(diagCapture.str().c_str()));
+        return;
+    }
+
+    pl0::Interpreter interpreter(codeGen.getCode());
+    std::istringstream noInput;
+    std::ostringstream console;
+    std::ostringstream errors;
+    interpreter.setStreams(noInput, console, errors);
+    interpreter.setOutputCallback([this](pl0::Word value) { queueOutput(value); });
+    interpreter.setInputCallback([this]() { return waitForInput(); });
+
+    interpreter.start();
+    {
+        // Publish the interpreter for cancel(); honour a cancel that came early
+        std::lock_guard<std::mutex> lock(runMutex_);
+        activeInterpreter_ = &interpreter;
+        activeRun_ = runId;
+        if (cancelledRun_ == runId) {
+            interpreter.requestStop();
+        }
+    }
+
+    interpreter.resume();
+
+    bool cancelled;
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        activeInterpreter_ = nullptr;
+        activeRun_ = -1;
+        cancelled = cancelledRun_ == runId;
+        hasInput_ = false;
+    }
+
+    bool success = !interpreter.hasError();
+    Q_EMIT runFinished(success, cancelled && !success, QString::fromStdString(interpreter.getError()));
+}
+
+void BuildWorker::clearCache() {
+    procCache_.clear();
+}
+
+// UI thread entry points
+
+void BuildWorker::cancel(int runId) {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    cancelledRun_ = runId;
+    if (activeInterpreter_ && activeRun_ == runId) {
+        activeInterpreter_->requestStop();
+    }
+    inputReady_.notify_all();
+}
+
+void BuildWorker::provideInput(pl0::Word value) {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    inputValue_ = value;
+    hasInput_ = true;
+    inputReady_.notify_all();
+}
+
+std::vector<pl0::Word> BuildWorker::takeOutput(long long* dropped) {
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    std::vector<pl0::Word> values(pendingOutput_.begin(), pendingOutput_.end());
+    pendingOutput_.clear();
+    *dropped = droppedOutput_;
+    droppedOutput_ = 0;
+    return values;
+}
+
+// Interpreter callbacks (worker thread)
+
+void BuildWorker::queueOutput(pl0::Word value) {
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    if (pendingOutput_.size() >= MAX_PENDING_OUTPUT) {
+        pendingOutput_.pop_front();
+        droppedOutput_++;
+    }
+    pendingOutput_.push_back(value);
+}
+
+pl0::Word BuildWorker::waitForInput() {
+    Q_EMIT inputRequested();
+
+    std::unique_lock<std::mutex> lock(runMutex_);
+    inputReady_.wait(lock, [this] { return hasInput_ || cancelledRun_ == activeRun_; });
+    if (!hasInput_) {
+        return 0;  // Cancelled: the interpreter stops at its next poll
+    }
+    hasInput_ = false;
+    return inputValue_;
+}
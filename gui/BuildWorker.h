@@ -0,0 +1,90 @@
+#ifndef BUILDWORKER_H
+#define BUILDWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QMetaType>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "../include/Instruction.h"
+#include "../include/SymbolTable.h"
+#include "../include/DebugInfo.h"
+#include "../include/ProcedureCache.h"
+
+namespace pl0 {
+    class Interpreter;
+}
+
+// Everything the UI needs from one compilation, built on the worker thread
+struct CompileOutput {
+    int generation = 0;
+    bool success = false;
+    QString diagnostics;
+    QString astText;
+    QString symbolText;
+    std::vector<std::tuple<QString, QString, int, int>> tokens;  // type, value, line, column
+    std::vector<pl0::Instruction> code;
+    pl0::SymbolTable symbols;
+    pl0::DebugInfo debugInfo;
+    int reusedProcedures = 0;
+    int totalProcedures = 0;
+};
+
+Q_DECLARE_METATYPE(CompileOutput)
+
+// Runs compilation and program execution off the UI thread.
+// Lives in its own QThread; requests arrive as queued signals and results
+// are posted back the same way. cancel(), provideInput() and takeOutput()
+// are called directly from the UI thread and are thread-safe.
+class BuildWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BuildWorker(QObject* parent = nullptr);
+
+    // Thread-safe (UI thread)
+    void cancel(int runId);                         // Interrupt run runId (queued or running)
+    void provideInput(pl0::Word value);             // Answer a pending read()
+    std::vector<pl0::Word> takeOutput(long long* dropped); // Drain batched write() values
+    void setLatestGeneration(int generation) { latestGeneration_.store(generation); }
+
+public Q_SLOTS:
+    void compile(int generation, const QString& source, const QString& fileName);
+    void run(int runId, const QString& source, const QString& fileName);
+    void clearCache();
+
+Q_SIGNALS:
+    void compileFinished(const CompileOutput& result);
+    void inputRequested();
+    void runFinished(bool success, bool cancelled, const QString& error);
+
+private:
+    pl0::Word waitForInput();
+    void queueOutput(pl0::Word value);
+
+    // Program output is kept as values and formatted by the UI in batches.
+    // Beyond MAX_PENDING_OUTPUT the oldest values are dropped (and counted);
+    // the console only keeps that many lines anyway.
+    static constexpr size_t MAX_PENDING_OUTPUT = 20000;
+
+    pl0::ProcedureCache procCache_;     // Worker thread only
+    std::atomic<int> latestGeneration_;
+
+    std::mutex outputMutex_;
+    std::deque<pl0::Word> pendingOutput_;
+    long long droppedOutput_;
+
+    std::mutex runMutex_;
+    std::condition_variable inputReady_;
+    pl0::Interpreter* activeInterpreter_;
+    int activeRun_;                     // -1 when no program is running
+    int cancelledRun_;
+    bool hasInput_;
+    pl0::Word inputValue_;
+};
+
+#endif // BUILDWORKER_H
@@ -12,6 +12,7 @@ ConsoleWidget::ConsoleWidget(QWidget *parent)
     // Output area
     outputArea_ = new QTextEdit(this);
     outputArea_->setReadOnly(true);
+    outputArea_->document()->setMaximumBlockCount(MAX_LINES);
     
     // Dark theme
     QPalette p = outputArea_->palette();
@@ -12,6 +12,9 @@ class ConsoleWidget : public QWidget {
 public:
     explicit ConsoleWidget(QWidget *parent = nullptr);
     
+    // Older lines are discarded beyond this (keeps long program runs responsive)
+    static constexpr int MAX_LINES = 20000;
+    
     void appendOutput(const QString& text);
     void appendError(const QString& text);
     void appendInfo(const QString& text);
@@ -7,15 +7,12 @@
 #include "CodeEditor.h"
 #include "ConsoleWidget.h"
 #include "../include/Common.h"
-#include "../include/Lexer.h"
-#include "../include/Parser.h"
 #include "../include/SymbolTable.h"
 #include "../include/Instruction.h"
 #include "../include/Interpreter.h"
-#include "../include/SourceManager.h"
-#include "../include/Diagnostics.h"
 
 #include <QMenuBar>
+#include <QMenu>
 #include <QToolBar>
 #include <QStatusBar>
 #include <QVBoxLayout>
@@ -24,21 +21,44 @@
 #include <QMessageBox>
 #include <QFontDatabase>
 #include <QHeaderView>
+#include <QSet>
 #include <QRegExp>
 #include <QTextStream>
 #include <QFileInfo>
-#include <iostream>
-#include <sstream>
+#include <limits>
+
+namespace {
+
+// Parse console input as a PL/0 word (range depends on PL0_WORD64)
+bool parseWord(const QString& input, pl0::Word& value) {
+    bool ok;
+    qlonglong v = input.trimmed().toLongLong(&ok);
+    if (!ok || v < std::numeric_limits<pl0::Word>::min() || v > std::numeric_limits<pl0::Word>::max()) {
+        return false;
+    }
+    value = static_cast<pl0::Word>(v);
+    return true;
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , isModified_(false)
     , isDebugging_(false)
     , currentDebugLine_(-1)
+    , worker_(nullptr)
+    , outputTimer_(nullptr)
+    , compileGeneration_(0)
+    , runId_(0)
+    , isRunning_(false)
+    , awaitingInput_(false)
+    , debugAfterCompile_(false)
     , baseFontSize_(13)  // Larger default size
     , currentFontSize_(13)
 {
     setupUI();
+    setupWorker();
     createActions();
     setupMenuBar();
     setupToolBar();
@@ -50,7 +70,25 @@ MainWindow::MainWindow(QWidget *parent)
 }
 
 MainWindow::~MainWindow() {
-    // Qt's parent-child system will handle cleanup
+    // Stop a running program (also releases a pending read) and join the worker;
+    // the remaining widgets are cleaned up by Qt's parent-child system
+    worker_->cancel(runId_);
+    workerThread_.quit();
+    workerThread_.wait();
+}
+
+void MainWindow::setupWorker() {
+    qRegisterMetaType<CompileOutput>("CompileOutput");
+    
+    // Compilation and program execution run on workerThread_
+    worker_ = new BuildWorker;
+    worker_->moveToThread(&workerThread_);
+    connect(&workerThread_, &QThread::finished, worker_, &QObject::deleteLater);
+    workerThread_.start();
+    
+    // Program output is batched and flushed to the console on a timer
+    outputTimer_ = new QTimer(this);
+    outputTimer_->setInterval(50);
 }
 
 void MainWindow::setupUI() {
@@ -134,6 +172,7 @@ void MainWindow::setupUI() {
     variableWatch_->header()->setStretchLastSection(true);
     variableWatch_->setAlternatingRowColors(true);
     variableWatch_->setMaximumHeight(200);
+    variableWatch_->setContextMenuPolicy(Qt::CustomContextMenu);  // Watchpoints
     debugLayout->addWidget(variableWatch_);
     
     // Stack Diagram
@@ -190,6 +229,10 @@ void MainWindow::createActions() {
     runAction_ = new QAction(tr("&Run"), this);
     runAction_->setShortcut(QKeySequence(tr("F6")));
     
+    cancelAction_ = new QAction(tr("C&ancel Run"), this);
+    cancelAction_->setShortcut(QKeySequence(tr("Shift+F6")));
+    cancelAction_->setEnabled(false);
+    
     // Debug actions
     debugAction_ = new QAction(tr("Start &Debug"), this);
     debugAction_->setShortcut(QKeySequence(tr("F7")));
@@ -240,6 +283,7 @@ void MainWindow::setupMenuBar() {
     QMenu* buildMenu = menuBar->addMenu(tr("&Build"));
     buildMenu->addAction(compileAction_);
     buildMenu->addAction(runAction_);
+    buildMenu->addAction(cancelAction_);
     
     // Debug menu
     QMenu* debugMenu = menuBar->addMenu(tr("&Debug"));
@@ -259,6 +303,7 @@ void MainWindow::setupToolBar() {
     toolBar->addSeparator();
     toolBar->addAction(compileAction_);
     toolBar->addAction(runAction_);
+    toolBar->addAction(cancelAction_);
     toolBar->addSeparator();
     
     // Debug controls - all visible
@@ -282,12 +327,23 @@ void MainWindow::connectSignals() {
     // Compile and run
     connect(compileAction_, &QAction::triggered, this, &MainWindow::compile);
     connect(runAction_, &QAction::triggered, this, &MainWindow::run);
+    connect(cancelAction_, &QAction::triggered, this, &MainWindow::cancelRun);
+    
+    // Build worker (cross-thread connections are queued)
+    connect(this, &MainWindow::compileRequested, worker_, &BuildWorker::compile);
+    connect(this, &MainWindow::runRequested, worker_, &BuildWorker::run);
+    connect(this, &MainWindow::cacheClearRequested, worker_, &BuildWorker::clearCache);
+    connect(worker_, &BuildWorker::compileFinished, this, &MainWindow::onCompileFinished);
+    connect(worker_, &BuildWorker::runFinished, this, &MainWindow::onRunFinished);
+    connect(worker_, &BuildWorker::inputRequested, this, &MainWindow::onInputRequested);
+    connect(outputTimer_, &QTimer::timeout, this, &MainWindow::flushProgramOutput);
     
     // Debug
     connect(debugAction_, &QAction::triggered, this, &MainWindow::startDebug);
     connect(stepAction_, &QAction::triggered, this, &MainWindow::stepDebug);
     connect(continueAction_, &QAction::triggered, this, &MainWindow::continueDebug);
     connect(stopAction_, &QAction::triggered, this, &MainWindow::stopDebug);
+    connect(variableWatch_, &QTreeWidget::customContextMenuRequested, this, &MainWindow::showVariableWatchMenu);
     
     // Console input (for debug mode)
     connect(console_, &ConsoleWidget::inputSubmitted, this, &MainWindow::onConsoleInput);
@@ -317,6 +373,7 @@ void MainWindow::newFile() {
     isModified_ = false;
     setWindowTitle("PL/0 Compiler - [Untitled]");
     clearVisualizations();
+    Q_EMIT cacheClearRequested();
     console_->clear();
     statusBar()->showMessage(tr("New file created"));
 }
@@ -349,6 +406,7 @@ void MainWindow::openFile() {
     isModified_ = false;
     setWindowTitle("PL/0 Compiler - " + QFileInfo(fileName).fileName());
     clearVisualizations();
+    Q_EMIT cacheClearRequested();
     console_->clear();
     statusBar()->showMessage(tr("File opened: ") + fileName);
 }
@@ -395,71 +453,35 @@ void MainWindow::compile() {
     codeEditor_->clearErrorLine();
     interpreter_.reset();  // Clear existing debug session
     
-    // Get source code (UTF-8 encoded)
-    QString sourceCode = codeEditor_->toPlainText();
-    std::string sourceStr = sourceCode.toUtf8().constData();
-    
     console_->appendInfo("=== Compiling ===");
+    statusBar()->showMessage(tr("Compiling..."));
     
-    // Create compiler components
-    pl0::SourceManager srcMgr;
-    srcMgr.loadString(sourceStr, currentFilePath_.isEmpty() ? "<untitled>" : currentFilePath_.toStdString());
-    pl0::DiagnosticsEngine diag(srcMgr);
-    diag.setUseColor(false);  // No color in GUI
-    pl0::SymbolTable symTable;
-    pl0::CodeGenerator codeGen;
-    pl0::Lexer lexer(sourceStr, diag);
-    pl0::Parser parser(lexer, symTable, codeGen, diag);
-    
-    // Enable AST dump and capture output (and stderr for diagnostics)
-    parser.enableAstDump(true);
-    std::ostringstream astCapture;
-    std::ostringstream errCapture;
-    std::streambuf* oldCout = std::cout.rdbuf(astCapture.rdbuf());
-    std::streambuf* oldCerr = std::cerr.rdbuf(errCapture.rdbuf());
-    
-    // Parse
-    bool success = parser.parse();
-    
-    // Restore streams
-    std::cout.rdbuf(oldCout);
-    std::cerr.rdbuf(oldCerr);
+    // Compile on the worker thread; a newer request supersedes this one
+    compileGeneration_++;
+    worker_->setLatestGeneration(compileGeneration_);
+    Q_EMIT compileRequested(compileGeneration_, codeEditor_->toPlainText(),
+                            currentFilePath_.isEmpty() ? QString("<untitled>") : currentFilePath_);
+}
 
-    astOutput_ = QString::fromUtf8(astCapture.str().c_str());
-    QString errorOutput = QString::fromUtf8(errCapture.str().c_str());
-    
-    // Collect tokens for visualization
-    tokens_.clear();
-    pl0::Lexer tokenCollector(sourceStr, diag);
-    pl0::Token tok;
-    while ((tok = tokenCollector.nextToken()).type != pl0::TokenType::END_OF_FILE) {
-        if (tok.type != pl0::TokenType::UNKNOWN) {
-            tokens_.push_back(std::make_tuple(
-                QString::fromStdString(pl0::tokenTypeToString(tok.type)),
-                QString::fromUtf8(tok.literal.c_str()),
-                tok.line,
-                tok.column));
-        }
+void MainWindow::onCompileFinished(const CompileOutput& result) {
+    if (result.generation != compileGeneration_) {
+        return;  // Superseded by a later compile
     }
     
+    astOutput_ = result.astText;
+    symbolOutput_ = result.symbolText;
+    tokens_ = result.tokens;
+    
     // Collect P-Code
     pcode_.clear();
-    const auto& instructions = codeGen.getCode();
-    for (size_t i = 0; i < instructions.size(); ++i) {
-        const auto& instr = instructions[i];
+    for (size_t i = 0; i < result.code.size(); ++i) {
+        const auto& instr = result.code[i];
         pcode_.push_back({static_cast<int>(i),
                            QString::fromStdString(pl0::opCodeToString(instr.op)),
                            instr.L,
                            instr.A});
     }
     
-    // Capture symbol table dump
-    std::ostringstream symCapture;
-    std::streambuf* oldCoutSym = std::cout.rdbuf(symCapture.rdbuf());
-    symTable.dump();
-    std::cout.rdbuf(oldCoutSym);
-    symbolOutput_ = QString::fromUtf8(symCapture.str().c_str());
-    
     // Update visualizations
     updateTokenView();
     updateASTView();
@@ -467,81 +489,117 @@ void MainWindow::compile() {
     updatePCodeView();
     
     // Show diagnostics
-    if (!errorOutput.isEmpty()) {
-       console_->appendError(errorOutput);
+    if (!result.diagnostics.isEmpty()) {
+       console_->appendError(result.diagnostics);
     }
 
-    if (diag.hasErrors()) {
+    if (!result.success) {
         console_->appendError("Compilation failed with errors.");
         statusBar()->showMessage(tr("Compilation failed"), 3000);
         
         // Highlight first error line (simplified - would need diag API enhancement)
         codeEditor_->setErrorLine(1);
-    } else {
-        console_->appendOutput("Compilation successful!");
-        statusBar()->showMessage(tr("Compilation successful"),3000);
-        
-        // Store raw instructions and symbol table for debugging/execution
-        rawInstructions_ = codeGen.getCode();
-        symTable_ = symTable;
+        debugAfterCompile_ = false;
+        return;
+    }
+    
+    console_->appendOutput("Compilation successful!");
+    if (result.reusedProcedures > 0) {
+        console_->appendInfo(QString("Reused %1 of %2 procedures from the previous compile")
+                             .arg(result.reusedProcedures)
+                             .arg(result.totalProcedures));
+    }
+    statusBar()->showMessage(tr("Compilation successful"),3000);
+    
+    // Store raw instructions and debug info for debugging/execution
+    rawInstructions_ = result.code;
+    debugInfo_ = result.debugInfo;
+    
+    if (debugAfterCompile_) {
+        debugAfterCompile_ = false;
+        startDebug();
     }
 }
 
 void MainWindow::run() {
-    console_->appendInfo("\n=== Running Program ===");
+    if (isRunning_) return;
     
-    // First compile if needed
+    // Compile first if needed (for the visualizations; queued ahead of the run)
     if (pcode_.empty()) {
         compile();
-        if (pcode_.empty()) {
-            console_->appendError("Cannot run: compilation required");
-            return;
-        }
-    }
-    
-    // Get source code again to run interpreter
-    QString sourceCode = codeEditor_->toPlainText();
-    std::string sourceStr = sourceCode.toUtf8().constData();
-    
-    pl0::SourceManager srcMgr;
-    srcMgr.loadString(sourceStr, currentFilePath_.isEmpty() ? "<untitled>" : currentFilePath_.toStdString());
-    pl0::DiagnosticsEngine diag(srcMgr);
-    diag.setUseColor(false);
-    pl0::SymbolTable symTable;
-    pl0::CodeGenerator codeGen;
-    pl0::Lexer lexer(sourceStr, diag);
-    pl0::Parser parser(lexer, symTable, codeGen, diag);
-    
-    if (!parser.parse()) {
-        console_->appendError("Failed to recompile before running");
-        return;
     }
     
-    // Run interpreter
-    pl0::Interpreter interpreter(codeGen.getCode());
-    interpreter.enableTrace(false);
+    console_->appendInfo("\n=== Running Program ===");
     
-    // Capture interpreter output
-    std::ostringstream outCapture;
-    std::streambuf* oldCout = std::cout.rdbuf(outCapture.rdbuf());
+    runId_++;
+    setRunning(true);
+    outputTimer_->start();
+    Q_EMIT runRequested(runId_, codeEditor_->toPlainText(),
+                        currentFilePath_.isEmpty() ? QString("<untitled>") : currentFilePath_);
+    statusBar()->showMessage(tr("Running... (Shift+F6 to cancel)"));
+}
+
+void MainWindow::cancelRun() {
+    if (!isRunning_) return;
     
-    try {
-        interpreter.run();
-        std::cout.rdbuf(oldCout);
-        
-        QString output = QString::fromUtf8(outCapture.str().c_str());
-        if (!output.isEmpty()) {
-            console_->appendOutput(output);
-        }
+    worker_->cancel(runId_);
+    statusBar()->showMessage(tr("Cancelling..."));
+}
+
+void MainWindow::onRunFinished(bool success, bool cancelled, const QString& error) {
+    flushProgramOutput();
+    outputTimer_->stop();
+    setRunning(false);
+    
+    if (cancelled) {
+        console_->appendError("Program cancelled.");
+        statusBar()->showMessage(tr("Execution cancelled"), 3000);
+    } else if (success) {
         console_->appendInfo("Program finished.");
         statusBar()->showMessage(tr("Execution completed"), 3000);
-    } catch (...) {
-        std::cout.rdbuf(oldCout);
-        console_->appendError("Runtime error occurred");
+    } else {
+        console_->appendError(error.isEmpty() ? QString("Runtime error occurred") : "Runtime Error: " + error);
         statusBar()->showMessage(tr("Execution failed"), 3000);
     }
 }
 
+void MainWindow::onInputRequested() {
+    if (!isRunning_) return;
+    
+    flushProgramOutput();  // Show everything written before the prompt
+    awaitingInput_ = true;
+    console_->appendInfo("Program requires input. Enter a value below and press Enter:");
+    statusBar()->showMessage(tr("Waiting for input..."));
+}
+
+void MainWindow::flushProgramOutput() {
+    long long dropped = 0;
+    std::vector<pl0::Word> values = worker_->takeOutput(&dropped);
+    
+    if (dropped > 0) {
+        console_->appendInfo(QString("... %1 output lines skipped ...").arg(dropped));
+    }
+    if (values.empty()) return;
+    
+    // One append per batch instead of one per write()
+    QStringList lines;
+    lines.reserve(static_cast<int>(values.size()));
+    for (pl0::Word value : values) {
+        lines.append(QString::number(value));
+    }
+    console_->appendOutput(lines.join('\n'));
+}
+
+void MainWindow::setRunning(bool running) {
+    isRunning_ = running;
+    awaitingInput_ = false;
+    
+    compileAction_->setEnabled(!running);
+    runAction_->setEnabled(!running);
+    debugAction_->setEnabled(!running);
+    cancelAction_->setEnabled(running);
+}
+
 void MainWindow::updateTokenView() {
     tokenTable_->setRowCount(0);
     
@@ -704,8 +762,10 @@ void MainWindow::clearVisualizations() {
 
 void MainWindow::startDebug() {
     if (rawInstructions_.empty()) {
+        // Compile in the background, then come back here
+        debugAfterCompile_ = true;
         compile();
-        if (rawInstructions_.empty()) return;
+        return;
     }
 
     console_->appendInfo("=== Starting Debug Session ===");
@@ -714,11 +774,11 @@ void MainWindow::startDebug() {
     
     // Create interpreter for debugging
     interpreter_ = std::make_unique<pl0::Interpreter>(rawInstructions_);
-    interpreter_->setSymbolTable(&symTable_);
+    interpreter_->setDebugInfo(&debugInfo_);
     interpreter_->setDebugMode(true);
     
     // Set output callback to display in console
-    interpreter_->setOutputCallback([this](int value) {
+    interpreter_->setOutputCallback([this](pl0::Word value) {
         console_->appendOutput(QString::number(value));
     });
     
@@ -771,6 +831,7 @@ void MainWindow::stepDebug() {
         stopDebug();
     } else {
         // Show current line and PC
+        reportWatchHit();
         console_->appendInfo(QString("Paused at line %1 (PC=%2)").arg(interpreter_->getCurrentLine()).arg(interpreter_->getCurrentPC()));
     }
 }
@@ -798,9 +859,49 @@ void MainWindow::continueDebug() {
     } else if (interpreter_->hasError()) {
         console_->appendError(QString::fromStdString(interpreter_->getError()));
         stopDebug();
+    } else {
+        reportWatchHit();
     }
 }
 
+void MainWindow::reportWatchHit() {
+    const auto& hit = interpreter_->getWatchHit();
+    if (hit.watchpoint < 0) return;
+    
+    const auto& watch = interpreter_->getWatchpoints()[hit.watchpoint];
+    QString what = hit.freed ? QString("freed")
+                             : QString("%1 → %2").arg(hit.oldValue).arg(hit.newValue);
+    console_->appendInfo(QString("Watchpoint %1 (address %2) at line %3: %4")
+                         .arg(QString::fromStdString(watch.name))
+                         .arg(watch.address)
+                         .arg(hit.line)
+                         .arg(what));
+}
+
+void MainWindow::showVariableWatchMenu(const QPoint& pos) {
+    QTreeWidgetItem* item = variableWatch_->itemAt(pos);
+    if (!item || !interpreter_ || !isDebugging_) return;
+    
+    bool ok = false;
+    int addr = item->text(2).toInt(&ok);
+    if (!ok) return;
+    // Array elements are named after their array
+    QString name = item->parent() ? item->parent()->text(0) + item->text(0) : item->text(0);
+    
+    QMenu menu(this);
+    bool watched = interpreter_->isWatched(addr);
+    QAction* toggle = menu.addAction(watched ? tr("Remove Watchpoint") : tr("Break When Value Changes"));
+    if (menu.exec(variableWatch_->viewport()->mapToGlobal(pos)) != toggle) return;
+    
+    if (watched) {
+        interpreter_->removeWatchpoint(addr);
+        console_->appendInfo(QString("Watchpoint removed: %1 (address %2)").arg(name).arg(addr));
+    } else if (interpreter_->addWatchpoint(name.toStdString(), addr)) {
+        console_->appendInfo(QString("Watchpoint set: %1 (address %2)").arg(name).arg(addr));
+    }
+    updateVariableWatch();
+}
+
 void MainWindow::stopDebug() {
     if (isDebugging_) {
         console_->appendInfo("Debug session stopped.");
@@ -822,17 +923,31 @@ void MainWindow::stopDebug() {
 }
 
 void MainWindow::onConsoleInput(const QString& input) {
+    // Running program blocked in read() on the worker thread
+    if (isRunning_) {
+        if (!awaitingInput_) return;
+        
+        pl0::Word value;
+        if (parseWord(input, value)) {
+            awaitingInput_ = false;
+            worker_->provideInput(value);
+            statusBar()->showMessage(tr("Running... (Shift+F6 to cancel)"));
+        } else {
+            console_->appendError("Invalid input. Please enter a number.");
+        }
+        return;
+    }
+    
     // Only handle input if we're debugging and waiting for input
     if (!isDebugging_ || !interpreter_) return;
     
     if (interpreter_->isWaitingForInput()) {
-        bool ok;
-        int value = input.toInt(&ok);
-        
-        if (ok) {
+        pl0::Word value;
+        if (parseWord(input, value)) {
             interpreter_->provideInput(value);
             console_->appendInfo(QString("Input received: %1").arg(value));
             updateDebugState();
+            reportWatchHit();
             
             // After providing input, continue to next step
             console_->appendInfo(QString("Paused at line %1").arg(interpreter_->getCurrentLine()));
@@ -883,10 +998,6 @@ void MainWindow::highlightCurrentPCodeLine(int pc) {
     }
 }
 
-void MainWindow::onCompileFinished() {
-    // Slot for future use
-}
-
 void MainWindow::onTabChanged(int index) {
     // Slot for future use
     Q_UNUSED(index);
@@ -941,10 +1052,9 @@ void MainWindow::updateVariableWatch() {
     variableWatch_->clear();
     if (!interpreter_) return;
     
-    const pl0::SymbolTable* symTable = interpreter_->getSymbolTable();
-    if (!symTable) return;
+    const pl0::DebugInfo* debugInfo = interpreter_->getDebugInfo();
+    if (!debugInfo || debugInfo->empty()) return;
     
-    const auto& symbols = symTable->getAllSymbols();
     const auto& store = interpreter_->getStore();
     int B = interpreter_->getBasePointer();
     int storeSize = interpreter_->getStoreSize();
@@ -954,81 +1064,104 @@ void MainWindow::updateVariableWatch() {
     bpLabel_->setText(QString("BP: %1").arg(B));
     spLabel_->setText(QString("SP: %1").arg(interpreter_->getStackTop()));
     
-    for (const auto& sym : symbols) {
-        if (sym.kind == pl0::SymbolKind::CONSTANT || 
-            sym.kind == pl0::SymbolKind::PROCEDURE) {
-            continue;  // Skip constants and procedures
-        }
+    // Names visible at the PC: the current scope, then the enclosing ones
+    // through the static chain; inner names hide outer ones
+    const auto& scopes = debugInfo->getScopes();
+    const auto& variables = debugInfo->getVariables();
+    QSet<QString> shown;
+    int frame = B;
+    for (int scope = debugInfo->scopeAt(interpreter_->getCurrentPC()); scope >= 0;
+         scope = scopes[scope].parent) {
+        const auto& info = scopes[scope];
+        for (int v = info.firstVariable; v < info.firstVariable + info.variableCount; ++v) {
+            const auto& sym = variables[v];
+            QString name = QString::fromStdString(sym.name);
+            if (sym.kind == pl0::SymbolKind::CONSTANT || shown.contains(name)) {
+                continue;  // Skip constants and hidden names
+            }
+            shown.insert(name);
         
-        QTreeWidgetItem* item = new QTreeWidgetItem(variableWatch_);
-        item->setText(0, QString::fromStdString(sym.name));
+            QTreeWidgetItem* item = new QTreeWidgetItem(variableWatch_);
+            item->setText(0, name);
         
-        QString typeStr;
-        QString valueStr;
-        int addr = B + sym.address;
+            QString typeStr;
+            QString valueStr;
+            int addr = frame + sym.offset;
         
-        switch (sym.kind) {
-            case pl0::SymbolKind::VARIABLE:
-                typeStr = "VAR";
-                if (addr >= 0 && addr < storeSize && addr < static_cast<int>(store.size())) {
-                    valueStr = QString::number(store[addr]);
-                } else {
-                    valueStr = "?";
-                }
-                break;
-                
-            case pl0::SymbolKind::ARRAY: {
-                typeStr = QString("ARRAY[%1]").arg(sym.size);
-                QStringList values;
-                for (int i = 0; i < sym.size && i < 20; ++i) {  // Limit to 20 elements
-                    int elemAddr = addr + i;
-                    if (elemAddr >= 0 && elemAddr < storeSize && elemAddr < static_cast<int>(store.size())) {
-                        values << QString::number(store[elemAddr]);
+            switch (sym.kind) {
+                case pl0::SymbolKind::VARIABLE:
+                    typeStr = "VAR";
+                    if (addr >= 0 && addr < storeSize && addr < static_cast<int>(store.size())) {
+                        valueStr = QString::number(store[addr]);
                     } else {
-                        values << "?";
+                        valueStr = "?";
                     }
-                }
-                valueStr = "[" + values.join(", ") + "]";
-                if (sym.size > 20) valueStr += "...";
+                    break;
                 
-                // Add child items for each array element
-                for (int i = 0; i < sym.size && i < 20; ++i) {
-                    QTreeWidgetItem* childItem = new QTreeWidgetItem(item);
-                    childItem->setText(0, QString("[%1]").arg(i));
-                    childItem->setText(1, "");
-                    int elemAddr = addr + i;
-                    childItem->setText(2, QString::number(elemAddr));
-                    if (elemAddr >= 0 && elemAddr < storeSize && elemAddr < static_cast<int>(store.size())) {
-                        childItem->setText(3, QString::number(store[elemAddr]));
-                    } else {
-                        childItem->setText(3, "?");
+                case pl0::SymbolKind::ARRAY: {
+                    typeStr = QString("ARRAY[%1]").arg(sym.size);
+                    QStringList values;
+                    for (int i = 0; i < sym.size && i < 20; ++i) {  // Limit to 20 elements
+                        int elemAddr = addr + i;
+                        if (elemAddr >= 0 && elemAddr < storeSize && elemAddr < static_cast<int>(store.size())) {
+                            values << QString::number(store[elemAddr]);
+                        } else {
+                            values << "?";
+                        }
                     }
-                }
-                break;
-            }
+                    valueStr = "[" + values.join(", ") + "]";
+                    if (sym.size > 20) valueStr += "...";
                 
-            case pl0::SymbolKind::POINTER:
-                typeStr = "PTR";
-                if (addr >= 0 && addr < storeSize && addr < static_cast<int>(store.size())) {
-                    int ptrVal = store[addr];
-                    valueStr = QString("→ %1").arg(ptrVal);
-                    // Show dereferenced value
-                    if (ptrVal >= 0 && ptrVal < storeSize && ptrVal < static_cast<int>(store.size())) {
-                        valueStr += QString(" (*=%1)").arg(store[ptrVal]);
+                    // Add child items for each array element
+                    for (int i = 0; i < sym.size && i < 20; ++i) {
+                        QTreeWidgetItem* childItem = new QTreeWidgetItem(item);
+                        childItem->setText(0, QString("[%1]").arg(i));
+                        childItem->setText(1, "");
+                        int elemAddr = addr + i;
+                        childItem->setText(2, QString::number(elemAddr));
+                        if (elemAddr >= 0 && elemAddr < storeSize && elemAddr < static_cast<int>(store.size())) {
+                            childItem->setText(3, QString::number(store[elemAddr]));
+                        } else {
+                            childItem->setText(3, "?");
+                        }
+                        if (interpreter_->isWatched(elemAddr)) {
+                            QFont watchedFont = childItem->font(0);
+                            watchedFont.setBold(true);
+                            childItem->setFont(0, watchedFont);
+                        }
                     }
-                } else {
-                    valueStr = "?";
+                    break;
                 }
-                break;
                 
-            default:
-                typeStr = "?";
-                valueStr = "?";
-        }
+                case pl0::SymbolKind::POINTER:
+                    typeStr = "PTR";
+                    if (addr >= 0 && addr < storeSize && addr < static_cast<int>(store.size())) {
+                        pl0::Word ptrVal = store[addr];
+                        valueStr = QString("→ %1").arg(ptrVal);
+                        // Show dereferenced value
+                        if (ptrVal >= 0 && ptrVal < storeSize && ptrVal < static_cast<int>(store.size())) {
+                            valueStr += QString(" (*=%1)").arg(store[ptrVal]);
+                        }
+                    } else {
+                        valueStr = "?";
+                    }
+                    break;
+                
+                default:
+                    typeStr = "?";
+                    valueStr = "?";
+            }
         
-        item->setText(1, typeStr);
-        item->setText(2, QString::number(addr));
-        item->setText(3, valueStr);
+            item->setText(1, typeStr);
+            item->setText(2, QString::number(addr));
+            item->setText(3, valueStr);
+            if (addr >= 0 && interpreter_->isWatched(addr)) {
+                QFont watchedFont = item->font(0);
+                watchedFont.setBold(true);
+                item->setFont(0, watchedFont);  // Watchpoint set
+            }
+        }
+        frame = (frame >= 0 && frame < storeSize) ? static_cast<int>(store[frame]) : -1;  // Static link
     }
     
     variableWatch_->expandAll();
@@ -1057,7 +1190,7 @@ void MainWindow::updateStackVisualization() {
     
     for (int i = showEnd; i >= showStart && i >= 0; --i) {
         QString line;
-        int value = (i < static_cast<int>(store.size())) ? store[i] : 0;
+        pl0::Word value = (i < static_cast<int>(store.size())) ? store[i] : 0;
         
         // Format the address and value
         if (i == T) {
@@ -1095,12 +1228,8 @@ void MainWindow::updateStackVisualization() {
         diagram += "\n┌─────────────────────────────┐\n";
         diagram += "│       CALL STACK            │\n";
         diagram += "├─────────────────────────────┤\n";
-        for (size_t i = 0; i < callStack.size(); ++i) {
-            const auto& frame = callStack[i];
-            diagram += QString("│ Frame %1: B=%2 RA=%3")
-                .arg(i, 2)
-                .arg(frame.baseAddress, 3)
-                .arg(frame.returnAddress, 3);
+        // Pad the last line to the box width and close it
+        auto closeLine = [&diagram]() {
             while (diagram.right(1) != "\n") {
                 if (diagram.length() % 31 == 30) {
                     diagram += "│\n";
@@ -1108,6 +1237,27 @@ void MainWindow::updateStackVisualization() {
                     diagram += " ";
                 }
             }
+        };
+        const pl0::DebugInfo* debugInfo = interpreter_->getDebugInfo();
+        // A frame executes at the current PC (innermost) or at the return
+        // address saved by the frame it called
+        int pc = interpreter_->getCurrentPC();
+        for (size_t i = 0; i < callStack.size(); ++i) {
+            const auto& frame = callStack[i];
+            diagram += QString("│ Frame %1: B=%2 RA=%3")
+                .arg(i, 2)
+                .arg(frame.baseAddress, 3)
+                .arg(frame.returnAddress, 3);
+            closeLine();
+            if (debugInfo && !debugInfo->empty()) {
+                const auto& scope = debugInfo->getScopes()[debugInfo->scopeAt(pc)];
+                QString where = QString("%1 line %2")
+                    .arg(QString::fromStdString(scope.name))
+                    .arg(debugInfo->lineAt(pc));
+                diagram += "│   " + where.left(25);
+                closeLine();
+            }
+            pc = frame.returnAddress;
         }
         diagram += "└─────────────────────────────┘\n";
     }
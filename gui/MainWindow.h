@@ -11,10 +11,12 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QTimer>
+#include <QThread>
 #include <memory>
 #include <vector>
 #include "../include/Instruction.h"
-#include "../include/SymbolTable.h"
+#include "../include/DebugInfo.h"
+#include "BuildWorker.h"
 
 namespace pl0 {
     class Lexer;
@@ -42,19 +44,30 @@ private Q_SLOTS:
     
     void compile();
     void run();
+    void cancelRun();
     void startDebug();
     void stepDebug();
     void continueDebug();
     void stopDebug();
     
-    void onCompileFinished();
+    void onCompileFinished(const CompileOutput& result);
+    void onRunFinished(bool success, bool cancelled, const QString& error);
+    void onInputRequested();
+    void flushProgramOutput();
     void onTabChanged(int index);
     
     void zoomIn();
     void zoomOut();
     void resetZoom();
     
-    void onConsoleInput(const QString& input);  // Handle console input during debug
+    void onConsoleInput(const QString& input);  // Handle console input during debug/run
+    void showVariableWatchMenu(const QPoint& pos);  // Set/remove a watchpoint on a variable
+
+Q_SIGNALS:
+    // Requests to the build worker (queued to its thread)
+    void compileRequested(int generation, const QString& source, const QString& fileName);
+    void runRequested(int runId, const QString& source, const QString& fileName);
+    void cacheClearRequested();
 
 private:
     void setupUI();
@@ -63,6 +76,8 @@ private:
     void setupStatusBar();
     void createActions();
     void connectSignals();
+    void setupWorker();
+    void setRunning(bool running);
     
     void updateTokenView();
     void updateASTView();  // New: AST visualization
@@ -71,6 +86,7 @@ private:
     void updateDebugState();
     void updateVariableWatch();     // Debug: show variables with runtime values
     void updateStackVisualization(); // Debug: draw stack diagram
+    void reportWatchHit();          // Debug: log the watchpoint the last step/continue stopped on
     void highlightCurrentPCodeLine(int line);
     void clearVisualizations();
     
@@ -106,6 +122,7 @@ private:
     QAction* saveAsAction_;
     QAction* compileAction_;
     QAction* runAction_;
+    QAction* cancelAction_;
     QAction* debugAction_;
     QAction* stepAction_;
     QAction* continueAction_;
@@ -121,11 +138,21 @@ private:
     int currentDebugLine_;
     std::unique_ptr<pl0::Interpreter> interpreter_;
     
+    // Background compilation / execution
+    QThread workerThread_;
+    BuildWorker* worker_;
+    QTimer* outputTimer_;       // Drains batched program output into the console
+    int compileGeneration_;     // Only the newest compile result is shown
+    int runId_;
+    bool isRunning_;
+    bool awaitingInput_;        // Running program is blocked in read()
+    bool debugAfterCompile_;    // Start debugging once the pending compile succeeds
+    
     int baseFontSize_;
     int currentFontSize_;
     
     std::vector<pl0::Instruction> rawInstructions_;
-    pl0::SymbolTable symTable_;
+    pl0::DebugInfo debugInfo_;
     std::vector<std::tuple<QString, QString, int, int>> tokens_;  // type, value, line, column
     std::vector<std::tuple<int, QString, int, int>> pcode_;  // addr, op, l, a
     QString astOutput_;  // AST dump output
@@ -2,7 +2,11 @@
 #define PL0_COMMON_H
 
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
 
 namespace pl0 {
 namespace Color {
@@ -17,15 +21,69 @@ namespace Color {
     inline const char* Bold    = "\033[1m";
 }
 
-bool isTerminal();
+// Whether stream is attached to a terminal (default: stdout)
+bool isTerminal(std::FILE* stream = stdout);
+
+// VM word: the type of every PL/0 value (literals, constants, store cells,
+// read/write). 32-bit by default; configure with -DPL0_WORD64=ON for 64-bit.
+#ifdef PL0_WORD64
+using Word = std::int64_t;
+#else
+using Word = std::int32_t;
+#endif
+
+constexpr int WORD_BITS = std::numeric_limits<Word>::digits + 1;
 
 constexpr int MAX_IDENT_LEN = 64;
-constexpr int MAX_NUMBER_LEN = 10;
-constexpr int MAX_NUMBER_VALUE = 2147483647;
-constexpr int DEFAULT_STORE_SIZE = 10000;
+constexpr int MAX_NUMBER_LEN = std::numeric_limits<Word>::digits10 + 1;
+constexpr Word MAX_NUMBER_VALUE = std::numeric_limits<Word>::max();
+
+// Two's complement wrap-around arithmetic (plain signed overflow is undefined
+// behavior). The VM and the constant folder both use these so folded and
+// executed results agree.
+using UWord = std::make_unsigned_t<Word>;
+
+inline Word wrapAdd(Word a, Word b) { return static_cast<Word>(static_cast<UWord>(a) + static_cast<UWord>(b)); }
+inline Word wrapSub(Word a, Word b) { return static_cast<Word>(static_cast<UWord>(a) - static_cast<UWord>(b)); }
+inline Word wrapMul(Word a, Word b) { return static_cast<Word>(static_cast<UWord>(a) * static_cast<UWord>(b)); }
+inline Word wrapNeg(Word a) { return static_cast<Word>(UWord(0) - static_cast<UWord>(a)); }
+
+// Truncating division/modulo for a non-zero divisor; MIN / -1 wraps to MIN
+inline Word wrapDiv(Word a, Word b) { return b == -1 ? wrapNeg(a) : a / b; }
+inline Word wrapMod(Word a, Word b) { return b == -1 ? 0 : a % b; }
+
+// Overflow-detecting arithmetic (--check-overflow): store the wrapped result
+// and return true if the exact result does not fit a Word. With GCC/Clang this
+// is the add/sub/mul itself plus a branch on the CPU overflow flag.
+#if defined(__GNUC__) || defined(__clang__)
+inline bool addOverflow(Word a, Word b, Word* result) { return __builtin_add_overflow(a, b, result); }
+inline bool subOverflow(Word a, Word b, Word* result) { return __builtin_sub_overflow(a, b, result); }
+inline bool mulOverflow(Word a, Word b, Word* result) { return __builtin_mul_overflow(a, b, result); }
+#else
+inline bool addOverflow(Word a, Word b, Word* result) {
+    *result = wrapAdd(a, b);
+    return ((a ^ *result) & (b ^ *result)) < 0;
+}
+inline bool subOverflow(Word a, Word b, Word* result) {
+    *result = wrapSub(a, b);
+    return ((a ^ b) & (a ^ *result)) < 0;
+}
+inline bool mulOverflow(Word a, Word b, Word* result) {
+    *result = wrapMul(a, b);
+    if (a == -1) return b == std::numeric_limits<Word>::min();
+    return a != 0 && *result / a != b;
+}
+#endif
+
+// MIN / -1 is the only quotient that does not fit
+inline bool divOverflow(Word a, Word b) { return b == -1 && a == std::numeric_limits<Word>::min(); }
+// VM memory limits in words. The store is reserved, not committed, so
+// generous defaults cost nothing until a program uses them.
+constexpr int DEFAULT_STACK_SIZE = 1 << 20;
+constexpr int DEFAULT_HEAP_SIZE = 1 << 24;
 
 int utf8CharLen(unsigned char c);
-int utf8StringLen(const std::string& s);
+int utf8StringLen(std::string_view s);
 std::string utf8Substr(const std::string& s, int start, int len);
 
 } // namespace pl0
@@ -0,0 +1,73 @@
+#ifndef PL0_COMPILATION_CONTEXT_H
+#define PL0_COMPILATION_CONTEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace pl0 {
+
+// Memory of one compilation. Text the front end keeps (the lexer's copy of
+// the source, which token literals point into, and symbol names) is bump
+// allocated from an arena and released in one shot with the context.
+// Shared by the Lexer and the SymbolTable; the SymbolTable holds a
+// reference so symbol names stay valid wherever the table is copied to
+// (debugger, GUI watch view).
+//
+// Identifiers are interned here as well: the lexer hashes each identifier
+// once and stores its id in the token, and the symbol table is indexed by
+// that id, so the parser never hashes a name. Ids are dense (0, 1, ...) in
+// order of first appearance and never change.
+//
+// The arena holds text only. Token, symbol and AST-dump containers stay on
+// the default allocator, and the Parser does not see the context.
+class CompilationContext {
+public:
+    // sizeHint: expected arena size in bytes (e.g. twice the source size)
+    explicit CompilationContext(size_t sizeHint = 0);
+
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+
+    // Copy text into the arena; valid for the lifetime of the context
+    std::string_view saveText(std::string_view text);
+
+    // Bytes of text saved so far
+    size_t getTextBytes() const { return textBytes_; }
+
+    // Id of name, interning (and saving) it on first use
+    int internIdent(std::string_view name);
+
+    // Id of name, -1 if it was never interned
+    int findIdent(std::string_view name) const;
+
+    std::string_view getIdentName(int id) const { return idents_[id].name; }
+    int getIdentCount() const { return static_cast<int>(idents_.size()); }
+
+private:
+    struct Identifier {
+        std::string_view name;
+        size_t hash;
+    };
+
+    // Index slot: low hash bits kept inline so most mismatches skip idents_
+    struct Slot {
+        uint32_t hash;
+        int ident;          // -1 = empty
+    };
+
+    int findIdent(std::string_view name, size_t hash) const;
+    void growIndex();
+
+    std::pmr::monotonic_buffer_resource arena_;
+    size_t textBytes_;
+
+    std::vector<Identifier> idents_;
+    std::vector<Slot> index_;       // Power-of-two size, at most half full
+};
+
+} // namespace pl0
+
+#endif // PL0_COMPILATION_CONTEXT_H
@@ -0,0 +1,43 @@
+#ifndef PL0_DATA_STORE_H
+#define PL0_DATA_STORE_H
+
+#include <cstddef>
+#include <vector>
+#include "Common.h"
+
+namespace pl0 {
+
+// Word-addressed memory of the VM. The whole address range is reserved up
+// front (anonymous mmap where available) and the OS commits pages on first
+// touch, so a large store costs only what the program actually uses. The
+// region never moves: addresses (pointers) stay valid however far the stack
+// or heap grows.
+class DataStore {
+public:
+    DataStore() = default;
+    ~DataStore();
+
+    DataStore(const DataStore&) = delete;
+    DataStore& operator=(const DataStore&) = delete;
+
+    // (Re)create the store with 'words' zeroed words; the previous contents
+    // are discarded. Returns false if the range cannot be reserved.
+    bool reserve(size_t words);
+
+    Word& operator[](size_t index) { return data_[index]; }
+    const Word& operator[](size_t index) const { return data_[index]; }
+
+    size_t size() const { return size_; }
+
+private:
+    void release();
+
+    Word* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<Word> fallback_;     // Without mmap (or if mapping fails)
+};
+
+} // namespace pl0
+
+#endif // PL0_DATA_STORE_H
@@ -0,0 +1,87 @@
+#ifndef PL0_DEBUG_INFO_H
+#define PL0_DEBUG_INFO_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include "Common.h"
+#include "Instruction.h"
+#include "SymbolTable.h"
+
+namespace pl0 {
+
+// Debug information of a compiled program: the procedure body each code
+// address belongs to, the names each body declares with their static level
+// and frame offset, and a PC -> source line map.
+//
+// Built from the symbol history and the code after parsing, so procedures
+// replayed from the ProcedureCache are covered as well. Bodies never overlap
+// (nested procedures are emitted before the body of their parent), so the
+// scope of a PC is a binary search over the sorted body ranges. A name is
+// resolved from that scope outwards through the enclosing scopes, each
+// searched by name; the level difference says how many static links to
+// follow from the frame executing the PC.
+class DebugInfo {
+public:
+    struct Variable {
+        std::string name;
+        SymbolKind kind;        // CONSTANT, VARIABLE, ARRAY or POINTER
+        int scope;              // Declaring scope
+        int offset;             // Frame offset (ARRAY: descriptor slot)
+        int size;               // ARRAY: element count
+        Word value;             // CONSTANT: value
+    };
+
+    struct Scope {
+        std::string name;       // Procedure name, "main" for the program
+        int parent;             // Enclosing scope, -1 for the main program
+        int level;              // Static level of the body's names
+        int codeBegin;          // Body code [codeBegin, codeEnd): INT .. RET
+        int codeEnd;
+        int firstVariable;      // Names [firstVariable, firstVariable + variableCount)
+        int variableCount;      //   of getVariables(), sorted by name
+    };
+
+    // Scope 0 is the main program
+    void build(const SymbolTable& symbols, const std::vector<Instruction>& code);
+
+    // Follow code rearranged by the optimizer. newAddress maps a block
+    // boundary of the code given to build() (procedure entry, the address
+    // after a return) to its new address; the line map is rebuilt from code.
+    void relocate(const std::function<int(int)>& newAddress, const std::vector<Instruction>& code);
+
+    bool empty() const { return scopes_.empty(); }
+    const std::vector<Scope>& getScopes() const { return scopes_; }
+    const std::vector<Variable>& getVariables() const { return variables_; }
+
+    // Innermost scope of pc: the body containing it, the main program for
+    // addresses outside every body; -1 without debug information
+    int scopeAt(int pc) const;
+
+    // Name visible at pc, nullptr if none. levelDiff receives the number of
+    // static links from the frame executing pc to the declaring frame.
+    const Variable* resolve(int pc, std::string_view name, int& levelDiff) const;
+
+    // Source line of the instruction at pc, -1 outside the code
+    int lineAt(int pc) const;
+
+private:
+    struct LineRange {
+        int begin;              // First PC of a run of instructions on one line
+        int line;
+    };
+
+    void sortRanges();
+    void buildLines(const std::vector<Instruction>& code);
+
+    std::vector<Scope> scopes_;
+    std::vector<Variable> variables_;   // Grouped by scope, sorted by name within a scope
+    std::vector<int> ranges_;           // Scope ids sorted by codeBegin
+    std::vector<LineRange> lines_;
+    int codeSize_ = 0;
+};
+
+} // namespace pl0
+
+#endif // PL0_DEBUG_INFO_H
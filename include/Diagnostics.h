@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <iosfwd>
 #include "Token.h"
 
 namespace pl0 {
@@ -29,7 +30,9 @@ struct Diagnostic {
 // Diagnostics engine (Clang-style output)
 class DiagnosticsEngine {
 public:
+    // Diagnostics are written to 'out' (one engine per compilation job)
     explicit DiagnosticsEngine(const SourceManager& srcMgr);
+    DiagnosticsEngine(const SourceManager& srcMgr, std::ostream& out);
 
     // Report error
     void error(const std::string& msg, int line, int col, int len = 1);
@@ -60,6 +63,7 @@ private:
     std::string generateCaret(int column, int length);
 
     const SourceManager& srcMgr_;
+    std::ostream& out_;
     int errorCount_;
     int warningCount_;
     int maxErrors_;
@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <iostream>
+#include <utility>
+#include "Common.h"
 
 namespace pl0 {
 
@@ -22,6 +25,8 @@ enum class OpCode {
     LAD     
 };
 
+constexpr int OPCODE_COUNT = static_cast<int>(OpCode::LAD) + 1;
+
 // OPR operation codes
 enum class OprCode {
     RET = 0,    // Procedure return
@@ -44,11 +49,11 @@ enum class OprCode {
 struct Instruction {
     OpCode op;      // Operation code
     int L;          // Level difference
-    int A;          // Operand/address
+    Word A;         // Operand/address (a full word for LIT)
     int line;       // Source line number
 
     Instruction() : op(OpCode::LIT), L(0), A(0), line(0) {}
-    Instruction(OpCode o, int l, int a, int ln = 0) : op(o), L(l), A(a), line(ln) {}
+    Instruction(OpCode o, int l, Word a, int ln = 0) : op(o), L(l), A(a), line(ln) {}
 };
 
 // Code generator class
@@ -57,7 +62,7 @@ public:
     CodeGenerator();
 
     // Emit instruction, returns instruction address
-    int emit(OpCode op, int L, int A, int line = 0);
+    int emit(OpCode op, int L, Word A, int line = 0);
 
     // Backpatch jump address
     void backpatch(int instrAddr, int targetAddr);
@@ -69,10 +74,10 @@ public:
     const std::vector<Instruction>& getCode() const { return code_; }
     
     // Update instruction sequence (for optimization)
-    void setCode(const std::vector<Instruction>& code) { code_ = code; }
+    void setCode(std::vector<Instruction> code) { code_ = std::move(code); }
 
     // Debug output
-    void dump() const;
+    void dump(std::ostream& out = std::cout) const;
 
 private:
     std::vector<Instruction> code_;
@@ -0,0 +1,241 @@
+#ifndef PL0_INT_STREAM_H
+#define PL0_INT_STREAM_H
+
+#include <charconv>
+#include <cstring>
+#include <cstddef>
+#include <iosfwd>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Common.h"
+
+namespace pl0 {
+
+// Encoding of an integer stream
+enum class IntFormat {
+    TEXT,       // Decimal, whitespace separated (one per line on output)
+    BINARY      // Raw native-endian words (int32, or int64 with PL0_WORD64)
+};
+
+// Buffered integer source for the interpreter's batch I/O (RED).
+// Values are decoded inline from the window [pos_, end_); the virtual
+// refill() is only reached when the window runs dry.
+class IntReader {
+public:
+    virtual ~IntReader() = default;
+
+    // Read the next integer. Returns false at end of input.
+    // A malformed text token is skipped and reads as 0.
+    bool read(Word& value) {
+        if (format_ == IntFormat::BINARY) {
+            if (end_ - pos_ >= static_cast<std::ptrdiff_t>(sizeof(Word))) {
+                std::memcpy(&value, pos_, sizeof(Word));
+                pos_ += sizeof(Word);
+                return true;
+            }
+        } else {
+            const char* p = pos_;
+            while (p < end_ && isSpace(*p)) p++;
+            const char* q = p;
+            while (q < end_ && !isSpace(*q)) q++;
+            if (q < end_) {             // Token is terminated inside the window
+                pos_ = q;
+                value = parse(p, q);
+                return true;
+            }
+        }
+        return readSlow(value);
+    }
+
+    IntFormat getFormat() const { return format_; }
+
+protected:
+    explicit IntReader(IntFormat format) : format_(format), pos_(nullptr), end_(nullptr) {}
+
+    // Extend the window with more input, keeping the unconsumed bytes
+    // [pos_, end_). Returns false when no more input is available.
+    virtual bool refill() = 0;
+
+    IntFormat format_;
+    const char* pos_;
+    const char* end_;
+
+private:
+    bool readSlow(Word& value);
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    static Word parse(const char* first, const char* last) {
+        if (first < last && *first == '+') first++;
+        Word value = 0;
+        auto result = std::from_chars(first, last, value);
+        if (result.ec != std::errc() || result.ptr != last) {
+            return 0;
+        }
+        return value;
+    }
+};
+
+// Buffered integer sink for the interpreter's batch I/O (WRT).
+// Values are encoded inline with std::to_chars; the virtual overflow()
+// is only reached when the window is full.
+class IntWriter {
+public:
+    virtual ~IntWriter() = default;
+
+    void write(Word value) {
+        if (end_ - pos_ < static_cast<std::ptrdiff_t>(MAX_ENCODED_SIZE)) {
+            overflow();
+        }
+        if (format_ == IntFormat::BINARY) {
+            std::memcpy(pos_, &value, sizeof(Word));
+            pos_ += sizeof(Word);
+        } else {
+            pos_ = std::to_chars(pos_, end_, value).ptr;
+            *pos_++ = '\n';
+        }
+    }
+
+    // Push buffered values to the destination
+    virtual void flush() = 0;
+
+    // Bytes written so far, buffered ones included
+    virtual uint64_t getBytesWritten() const = 0;
+
+    IntFormat getFormat() const { return format_; }
+
+protected:
+    explicit IntWriter(IntFormat format) : format_(format), pos_(nullptr), end_(nullptr) {}
+
+    // Make room for at least MAX_ENCODED_SIZE bytes at pos_
+    virtual void overflow() = 0;
+
+    // Sign, digits and newline
+    static constexpr size_t MAX_ENCODED_SIZE = std::numeric_limits<Word>::digits10 + 3;
+
+    IntFormat format_;
+    char* pos_;
+    char* end_;
+};
+
+// Reads integers from a std::istream in large blocks (no prompts, no
+// per-value stream extraction)
+class StreamIntReader : public IntReader {
+public:
+    explicit StreamIntReader(std::istream& in, IntFormat format = IntFormat::TEXT,
+                             size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+protected:
+    bool refill() override;
+
+private:
+    std::istream& in_;
+    std::vector<char> buffer_;
+};
+
+// Writes integers to a std::ostream in large blocks (no per-value flush)
+class StreamIntWriter : public IntWriter {
+public:
+    explicit StreamIntWriter(std::ostream& out, IntFormat format = IntFormat::TEXT,
+                             size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~StreamIntWriter() override;
+
+    void flush() override;
+    uint64_t getBytesWritten() const override { return written_ + (pos_ - buffer_.data()); }
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+protected:
+    void overflow() override;
+
+private:
+    std::ostream& out_;
+    std::vector<char> buffer_;
+    uint64_t written_;          // Bytes passed to out_
+};
+
+// Whole file as a single window: memory-mapped on POSIX, read into memory
+// elsewhere (or when mapping fails). Values are decoded straight from the
+// mapping; refill() never has more to give.
+class MappedIntReader : public IntReader {
+public:
+    explicit MappedIntReader(IntFormat format = IntFormat::TEXT);
+    ~MappedIntReader() override;
+
+    MappedIntReader(const MappedIntReader&) = delete;
+    MappedIntReader& operator=(const MappedIntReader&) = delete;
+
+    // Returns false if the file cannot be opened (see getError())
+    bool open(const std::string& path);
+    const std::string& getError() const { return error_; }
+
+protected:
+    bool refill() override { return false; }
+
+private:
+    void* map_;
+    size_t mapSize_;
+    std::vector<char> data_;    // Fallback copy when not mapped
+    std::string error_;
+};
+
+// Output file written through a shared mapping that is preallocated and
+// doubled as needed; close() trims the file to the bytes written. Without
+// mmap it falls back to block writes through std::ofstream.
+// I/O errors do not interrupt the program: further output is discarded and
+// close() reports the failure.
+class MappedIntWriter : public IntWriter {
+public:
+    explicit MappedIntWriter(IntFormat format = IntFormat::TEXT);
+    ~MappedIntWriter() override;
+
+    MappedIntWriter(const MappedIntWriter&) = delete;
+    MappedIntWriter& operator=(const MappedIntWriter&) = delete;
+
+    // Create/truncate path. With keep, an existing file is left as it is
+    // until resumeAt() says how much of it to keep. Returns false on error
+    // (see getError()).
+    bool open(const std::string& path, bool keep = false);
+
+    // After open(path, true), before any write: continue at byte offset,
+    // discarding the rest of the file (a resumed checkpoint's output).
+    // Returns false if the file is shorter than offset.
+    bool resumeAt(uint64_t offset);
+
+    // Data already lives in the page cache; the file length is only final after close()
+    void flush() override;
+    uint64_t getBytesWritten() const override;
+
+    // Trim, unmap and close (no writes afterwards). Returns false if any write failed.
+    bool close();
+    const std::string& getError() const { return error_; }
+
+    static constexpr size_t INITIAL_CAPACITY = 1 << 20;
+
+protected:
+    void overflow() override;
+
+private:
+    bool map(size_t capacity);
+    void fail(const std::string& message);
+
+    int fd_;                    // -1 when not mapped
+    char* base_;
+    size_t capacity_;
+    uint64_t fileSize_;         // Existing length when opened with keep
+    std::string path_;
+    std::ofstream fallback_;
+    uint64_t written_;          // Bytes passed to fallback_
+    std::vector<char> buffer_;  // Fallback block buffer / discard area after an error
+    bool failed_;
+    std::string error_;
+};
+
+} // namespace pl0
+
+#endif // PL0_INT_STREAM_H
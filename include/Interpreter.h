@@ -1,11 +1,22 @@
 #include <vector>
 #include <set>
+#include <deque>
 #include <map>
 #include <functional>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <array>
+#include <string_view>
 #include "Instruction.h"
-#include "SymbolTable.h"
+#include "DebugInfo.h"
+#include "IntStream.h"
+#include "DataStore.h"
 
 namespace pl0 {
+    class Profiler;
+    class TraceBuffer;
 
     enum class DebugState {
         RUNNING,
@@ -15,6 +26,40 @@ namespace pl0 {
         WAITING_INPUT  // waiting for GUI to provide input
     };
 
+    // VM counters for one run (sizes in store words)
+    struct ExecutionStats {
+        uint64_t instructions = 0;
+        bool hasOpcodeCounts = false;           // Histogram is only kept with enableStats(true)
+        std::array<uint64_t, OPCODE_COUNT> opcodeCounts{};
+        int maxStackTop = 0;                    // Highest T
+        int heapSize = 0;                       // storeSize - H at the end
+        int heapHighWater = 0;                  // storeSize - lowest H
+        int liveHeap = 0;                       // Words in allocated blocks (excluding headers)
+        int liveBlocks = 0;
+        int freeBlocks = 0;                     // Free-list length
+        int freeWords = 0;
+        int largestFreeBlock = 0;
+        double fragmentation = 0.0;             // 1 - largestFreeBlock / freeWords
+        int maxCallDepth = 0;
+        uint64_t calls = 0;
+        double wallSeconds = 0.0;               // Time spent in run()/resume()/stepOver()
+    };
+
+    // A watched store word and the user's name for it
+    struct Watchpoint {
+        std::string name;       // Variable, *pointer or address as given
+        int address;
+    };
+
+    // Why the last resume()/step()/stepOver() paused on a watchpoint
+    struct WatchHit {
+        int watchpoint = -1;    // Index in getWatchpoints(), -1 if it did not
+        Word oldValue = 0;
+        Word newValue = 0;
+        bool freed = false;     // DEL released the heap block holding the word
+        int line = -1;          // Line of the instruction that changed it
+    };
+
     struct StackFrame {
         int returnAddress;
         int dynamicLink;
@@ -30,11 +75,24 @@ public:
     void run();
 
     // Debug API
-    void setSymbolTable(const SymbolTable* symTable) { symTable_ = symTable; }
+    void setDebugInfo(const DebugInfo* debugInfo) { debugInfo_ = debugInfo; }
     void setDebugMode(bool debug) { debugMode_ = debug; }
     
     void setBreakpoint(int line);
     void removeBreakpoint(int line);
+
+    // Watchpoints pause execution after an instruction changes a watched
+    // store word (STO, RED) or frees the heap block holding it (DEL). The
+    // checks are in watching variants of those instructions, which only run
+    // while watchpoints are set; other runs execute the plain ones.
+    bool addWatchpoint(const std::string& name, int address); // false: outside the store
+    void removeWatchpoint(int address);
+    bool isWatched(int address) const {
+        size_t word = static_cast<size_t>(address) / 64;
+        return word < watchBits_.size() && ((watchBits_[word] >> (address % 64)) & 1);
+    }
+    const std::vector<Watchpoint>& getWatchpoints() const { return watchpoints_; }
+    const WatchHit& getWatchHit() const { return watchHit_; }
     
     void start(); // Reset and start
     void resume(); // Run until breakpoint
@@ -46,15 +104,105 @@ public:
     int getCurrentPC() const { return P_; }
     
     std::vector<StackFrame> getCallStack() const;
-    int getValue(const std::string& varName) const;
-    int getValueAt(int address) const;
 
-    // Set store size
-    void setStoreSize(int size) { storeSize_ = size; }
+    // Variable or constant visible at the current PC, resolved through the
+    // debug info and the static chain. Returns -999999 without debug info,
+    // -888888 if no such name is visible, -777777 if outside the store.
+    Word getValue(const std::string& varName) const;
+
+    // Store address of a name visible at the current PC, -1 if none
+    int getVariableAddress(std::string_view varName) const;
+    Word getValueAt(int address) const;
+
+    // Memory limits in words, applied by start(). The stack occupies
+    // [0, stackSize) and the heap grows down from stackSize + heapSize.
+    void setStackSize(int words) { stackSize_ = words; }
+    void setHeapSize(int words) { heapSize_ = words; }
 
     // Enable debug trace
     void enableTrace(bool enable) { trace_ = enable; }
 
+    // Binary trace: record every executed instruction into buffer
+    // (nullptr: off). Cheap enough for whole runs, unlike the text trace.
+    void setTraceBuffer(TraceBuffer* buffer) { traceBuffer_ = buffer; }
+
+    // Console streams for CLI I/O, trace and runtime errors (default: std::cin/cout/cerr)
+    void setStreams(std::istream& in, std::ostream& out, std::ostream& err) {
+        in_ = &in;
+        out_ = &out;
+        err_ = &err;
+    }
+
+    // Batch I/O: RED/WRT go through buffered integer streams instead of the
+    // console (no prompt, no per-value flush). Callbacks still take priority.
+    // The owner flushes the writer after the run.
+    void setIntReader(IntReader* reader) { intReader_ = reader; }
+    void setIntWriter(IntWriter* writer) { intWriter_ = writer; }
+
+    // Interrupt a running program; safe to call from another thread.
+    // The run loop polls the flag and stops with a runtime error.
+    void requestStop() { stopRequested_.store(true, std::memory_order_relaxed); }
+
+    // Wall-clock budget for run()/resume(); zero disables the limit
+    void setTimeLimit(std::chrono::milliseconds limit) { timeLimit_ = limit; }
+    bool timedOut() const { return timedOut_; }
+
+    // Stop with a runtime error when +, -, *, / or unary minus overflow a
+    // word instead of wrapping around (pl0c --check-overflow)
+    void setCheckOverflow(bool enable) { checkOverflow_ = enable; }
+
+    // Instructions executed since start()
+    uint64_t getInstructionCount() const { return instructionCount_; }
+
+    // Counters of the current/last run. Everything but the opcode histogram
+    // is maintained at call/heap events; the histogram needs enableStats(true),
+    // which moves execution to the instrumented loop.
+    ExecutionStats getStats() const;
+    void enableStats(bool enable) { statsEnabled_ = enable; }
+
+    // Checkpointing. A snapshot holds the registers, the used parts of the
+    // store (stack prefix and heap suffix), pending input and the counters,
+    // tagged with a hash of the code. loadSnapshot() replaces start(): it
+    // rejects snapshots of other code or word size, and resume() then
+    // continues where the snapshot was taken.
+    bool saveSnapshot(std::ostream& out) const;
+    bool loadSnapshot(std::istream& in, std::string& error);
+
+    // Bytes the IntWriter had written when the loaded snapshot was taken
+    // (flush it before saving); the owner continues its output there
+    uint64_t getSnapshotOutputBytes() const { return snapshotOutputBytes_; }
+
+    // Call checkpoint() between instructions roughly every 'instructions'
+    // instructions (0 disables); it may call saveSnapshot().
+    using CheckpointCallback = std::function<void()>;
+    void setCheckpointInterval(uint64_t instructions, CheckpointCallback checkpoint);
+
+    // Record and replay for reverse debugging. While recording, read()
+    // values are logged and about every 'interval' instructions a checkpoint
+    // keeps the registers and the old values of the store words changed
+    // since the previous checkpoint; beyond maxCheckpoints the oldest are
+    // dropped. reverseStep()/reverseContinue() restore the nearest
+    // checkpoint before the target and replay forward: read() is fed from
+    // the log and output that was already written is not repeated.
+    // Applies from the next start() or loadSnapshot(); interval 0 disables.
+    static constexpr size_t DEFAULT_RECORD_CHECKPOINTS = 256;
+    void setRecording(uint64_t interval, size_t maxCheckpoints = DEFAULT_RECORD_CHECKPOINTS);
+    bool isRecording() const { return recordInterval_ > 0; }
+
+    // Go back one instruction; false if that is before the recording
+    bool reverseStep();
+    // Go back to the last breakpoint or watchpoint stop before the current
+    // instruction, else to the oldest recorded point; false if already there
+    bool reverseContinue();
+
+    // Values consumed by read() since start(), restored with a snapshot
+    // (the owner skips as many when reopening the input)
+    uint64_t getInputCount() const { return inputCount_; }
+
+    // Record every executed instruction into profiler (nullptr: off).
+    // Runs without a profiler use a loop with no profiling hook at all.
+    void setProfiler(Profiler* profiler) { profiler_ = profiler; }
+
     // Check for runtime error
     bool hasError() const { return debugState_ == DebugState::ERROR || (!running_ && !errorMessage_.empty()); }
 
@@ -62,45 +210,90 @@ public:
     std::string getError() const { return errorMessage_; }
 
     // I/O Callbacks for GUI integration
-    using OutputCallback = std::function<void(int value)>;
-    using InputCallback = std::function<int()>;  // Synchronous input (for CLI)
+    using OutputCallback = std::function<void(Word value)>;
+    using InputCallback = std::function<Word()>;  // Synchronous input (for CLI)
     
     void setOutputCallback(OutputCallback cb) { outputCb_ = cb; }
     void setInputCallback(InputCallback cb) { inputCb_ = cb; }
     
     // Async input support for GUI (non-blocking)
-    void provideInput(int value);  // GUI calls this when user enters input
+    void provideInput(Word value);  // GUI calls this when user enters input
     bool isWaitingForInput() const { return debugState_ == DebugState::WAITING_INPUT; }
 
     // Runtime stack accessors for GUI visualization
     int getStackTop() const { return T_; }
     int getBasePointer() const { return B_; }
     int getHeapPointer() const { return H_; }
-    const std::vector<int>& getStore() const { return store_; }
+    const DataStore& getStore() const { return store_; }
     int getStoreSize() const { return storeSize_; }
-    const SymbolTable* getSymbolTable() const { return symTable_; }
+    int getStackSize() const { return stackSize_; }
+    const DebugInfo* getDebugInfo() const { return debugInfo_; }
 
 private:
     // Find base address for level difference L
-    int base(int L, int B);
+    int base(int L, int B) const;
+
+    // Address of offset in the frame levelDiff static links up from B_
+    // (debugger), -1 if the chain leaves the stack
+    int frameAddress(int levelDiff, int offset) const;
 
     // Execute OPR instruction
     void executeOpr(OprCode opr);
 
     // Runtime error handling
     void runtimeError(const std::string& msg);
+    void overflowError(const std::string& expr);
 
-    // Check stack/heap collision
+    // Check the stack limit
     void checkCollision();
 
     // Heap Management (Free List)
     int allocate(int size);
     void deallocate(int address);
     
-    bool executeOne(); // Returns true if should continue, false if halted/break
+    // Execute one instruction with I/O policy IO (see Interpreter.cpp);
+    // Watch selects the STO/RED/DEL variants that check watchpoints.
+    // Returns true if should continue, false if halted/break
+    template <bool Watch, class IO>
+    bool executeOne(IO& io);
+
+    // executeOne() for the debugger: watching while watchpoints are set
+    template <class IO>
+    bool executeDebug(IO& io);
+
+    // Run until halt, pause or error. Returns false if execution stopped
+    // inside the loop.
+    enum class LoopMode {
+        FAST,           // Execute only
+        INSTRUMENTED,   // + profiler / opcode histogram
+        TRACE,          // INSTRUMENTED + binary trace
+        DEBUG,          // + breakpoint map, trace and instrumentation
+        WATCH           // DEBUG + watchpoint checks
+    };
+    template <LoopMode Mode, class IO>
+    bool runLoop(IO& io);
+    void instrument();
+
+    void traceInstruction();
+    void rebuildBreakpointMap();
+
+    // Watchpoints
+    void rebuildWatchBits();
+    bool watchStore(int address, Word value);   // Store; false (paused) if a watched word changed
+    int watchedInBlock(int address) const;      // A watched word in the heap block at address, -1 if none
+    void watchTriggered(int address, Word oldValue, Word newValue, bool freed);
+    void printWatchHit() const;
+
+    // Call fn(io) with the I/O policy matching the current configuration
+    template <class Fn>
+    void withIO(Fn&& fn);
+
+    // Poll stop request / deadline; stops with a runtime error when set
+    bool checkInterrupt();
+    static constexpr uint64_t INTERRUPT_POLL_INTERVAL = 4096; // power of two
 
     const std::vector<Instruction>& code_;
-    std::vector<int> store_;    // Unified data store (stack + heap)
+    DataStore store_;           // Unified data store (stack + heap)
     
     int P_;     // Program counter
     int B_;     // Base register
@@ -108,17 +301,95 @@ private:
     int H_;     // Heap pointer
     int freeListHead_; // Head of free list (sorted by address)
     
-    int storeSize_;
+    int stackSize_;
+    int heapSize_;
+    int storeSize_;             // stackSize_ + heapSize_
     bool running_;
     bool trace_;
+    TraceBuffer* traceBuffer_;
     std::string errorMessage_;
+    uint64_t instructionCount_;
+    uint64_t inputCount_;
+
+    // Interruption
+    std::atomic<bool> stopRequested_;
+    std::chrono::milliseconds timeLimit_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool timedOut_;
+
+    bool checkOverflow_;
+
+    // Record and replay
+    struct VmState {
+        int P, B, T, H, freeListHead;
+        uint64_t instructions, inputs, calls;
+        int maxStackTop, lowestHeap, liveHeap, liveBlocks, callDepth, maxCallDepth;
+    };
+    struct RecordedCheckpoint {
+        VmState state;
+        std::vector<std::pair<int, int>> undoRuns;  // (address, length) into undoWords
+        std::vector<Word> undoWords;                // Values at the previous checkpoint
+    };
+    enum class ReplayStop { NONE, BREAKPOINT, WATCHPOINT };
+    VmState saveState() const;
+    void loadState(const VmState& state);
+    void startRecording();
+    void recordCheckpoint();
+    void restoreCheckpoint(size_t index);
+    size_t checkpointBefore(uint64_t instruction) const;  // Last one taken at or before instruction
+    void replayTo(uint64_t target, uint64_t stopsBefore, uint64_t* lastStop, ReplayStop* lastKind);
+    bool reverseTo(uint64_t instruction);
+
+    uint64_t recordInterval_;
+    size_t recordLimit_;
+    uint64_t nextRecord_;
+    std::deque<RecordedCheckpoint> recorded_;
+    DataStore recordMirror_;        // Store words at the newest checkpoint (untouched words stay zero)
+    std::vector<Word> inputLog_;    // read() values from input number inputLogStart_ on
+    uint64_t inputLogStart_;
+    uint64_t replayFrontier_;       // Instructions up to here have run before: output is not repeated
+    bool replaying_;
+
+    // Checkpointing
+    uint64_t checkpointInterval_;
+    uint64_t nextCheckpoint_;
+    CheckpointCallback checkpoint_;
+    uint64_t snapshotOutputBytes_;
+
+    Profiler* profiler_;
+
+    // Statistics
+    bool statsEnabled_;
+    std::array<uint64_t, OPCODE_COUNT> opcodeCounts_;
+    int maxStackTop_;
+    int lowestHeap_;
+    int liveHeap_;
+    int liveBlocks_;
+    int callDepth_;
+    int maxCallDepth_;
+    uint64_t calls_;
+    std::chrono::steady_clock::duration runTime_;
     
     // Debugger State
     bool debugMode_;
     DebugState debugState_;
     std::set<int> breakpoints_;
-    const SymbolTable* symTable_;
+    std::vector<char> breakpointAt_;    // Per PC: stop here (line entry or jump target on a breakpoint line)
+    bool breakpointsDirty_;
+    std::vector<Watchpoint> watchpoints_;
+    std::vector<uint64_t> watchBits_;   // Bit per store word: watched
+    WatchHit watchHit_;
+    const DebugInfo* debugInfo_;
     
+    // Console streams
+    std::istream* in_;
+    std::ostream* out_;
+    std::ostream* err_;
+
+    // Batch streams (not owned)
+    IntReader* intReader_;
+    IntWriter* intWriter_;
+
     // I/O Callbacks
     OutputCallback outputCb_;
     InputCallback inputCb_;
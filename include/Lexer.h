@@ -2,13 +2,14 @@
 #define PL0_LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include "Token.h"
 
 namespace pl0 {
 
 class DiagnosticsEngine;
+class CompilationContext;
 
 // Lexer class
 // Implements double-buffered input with sentinel mechanism
@@ -18,14 +19,23 @@ public:
     static constexpr size_t BUFFER_SIZE = 4096;
     static constexpr char SENTINEL = '\0';
 
-    // Construct from source string
-    Lexer(const std::string& source, DiagnosticsEngine& diag);
+    // Construct from source string. The source is copied into context, and
+    // token literals point into that copy. Identifiers are interned in
+    // context; their tokens carry the id.
+    Lexer(const std::string& source, DiagnosticsEngine& diag, CompilationContext& context);
     
     ~Lexer() = default;
 
     // Reset lexer to beginning of source
     void reset();
 
+    // Continue scanning at a byte offset; line/column describe that position
+    void seek(size_t offset, int line, int column);
+
+    std::string_view getSource() const { return source_; }
+
+    CompilationContext& getContext() const { return context_; }
+
     // Get next token
     Token nextToken();
 
@@ -51,8 +61,8 @@ private:
     // Mark current position as lexeme start
     void markLexemeStart();
     
-    // Get lexeme from start to current position
-    std::string getLexeme() const;
+    // Get lexeme from start to current position (a view of source_)
+    std::string_view getLexeme() const;
 
     void skipWhitespace();
     void skipWhitespaceAndComments();
@@ -68,43 +78,43 @@ private:
     // UTF-8 Handling 
     
     int getUtf8CharLen(unsigned char c) const;
-    std::string readUtf8Char();
-    int getUtf8StringLen(const std::string& s) const;
+    void skipUtf8Char();
+    int getUtf8StringLen(std::string_view s) const;
     bool isValidPunctStart(char c) const;
 
     // Token Creation 
     
     Token makeToken(TokenType type);
-    Token makeToken(TokenType type, const std::string& literal);
-    Token makeToken(TokenType type, int value);
+    Token makeToken(TokenType type, std::string_view literal);
+    Token makeToken(TokenType type, Word value);
 
     // Double Buffering Internals
     
     // Switch to next buffer and load data
     void loadNextBuffer();
     
-    std::string source_;       
+    std::string_view source_;   // Owned by the CompilationContext
     size_t sourcePtr_;         
+    size_t bufferOffset_;       // Source offset of the current buffer's first byte
     
     char buffers_[2][BUFFER_SIZE + 1];
     int currentBufferIdx_;     
     char* lexemeBegin_;         
     char* forward_;            
-    std::string partialLexeme_; 
     bool isEof_;                
     
     int line_;                  
     int column_;               
     int tokenStartLine_;       
     int tokenStartColumn_;   
+    size_t tokenStartOffset_;
     
     DiagnosticsEngine& diag_;
+    CompilationContext& context_;
     
     // Token buffer for peek
     Token bufferedToken_;
     bool hasBuffered_;
-
-    static const std::unordered_map<std::string, TokenType> keywords_;
 };
 
 } // namespace pl0
@@ -3,19 +3,15 @@
 
 #include "Instruction.h"
 #include <vector>
-#include <map>
-#include <set>
+#include <cstdint>
 
 namespace pl0 {
 
-struct BasicBlock {
-    int id;
-    int originalStartAddr; // For mapping
-    std::vector<Instruction> instructions;
-    std::vector<int> successors;
-    bool reachable = false;
-};
-
+// Peephole optimizer over basic blocks: constant folding, strength
+// reduction, constant branches and unreachable-block removal. Runs in time
+// linear in the code size. Blocks are index ranges in one instruction
+// buffer that is simplified and then compacted in place; the per-address
+// and per-block tables are flat arrays reused across calls.
 class Optimizer {
 public:
     Optimizer();
@@ -23,23 +19,43 @@ public:
     // Optimize the instruction sequence
     std::vector<Instruction> optimize(const std::vector<Instruction>& input);
 
+    // Leave overflowing constant expressions unfolded so the VM reports
+    // them (pl0c --check-overflow); otherwise they fold to the wrapped value
+    void setCheckOverflow(bool enable) { checkOverflow_ = enable; }
+
+    // New address of a block boundary of the last input (a jump or call
+    // target, the address after a jump or return, or the input size).
+    // Removed blocks map to the address of the next block kept; -1 for
+    // addresses inside a block.
+    int remapAddress(int address) const;
+
 private:
     // Analysis
-    void analyzeJumpTargets(const std::vector<Instruction>& code, std::set<int>& targets);
-    void buildBasicBlocks(const std::vector<Instruction>& code, const std::set<int>& targets);
-    void buildCFG();
-    void markReachable(int startBlockId);
-    
-    // Transformations
-    void constantFolding(BasicBlock& block);
-    void strengthReduction(BasicBlock& block);
-    
-    // Reconstruction
-    std::vector<Instruction> flattenAndRemap();
-
-    std::vector<BasicBlock> blocks_;
-    // Map Old Address -> New Address (Only need to track Block Start addresses)
-    std::map<int, int> addressMap_; 
+    void findBlocks(const std::vector<Instruction>& code);
+    void markReachable(const std::vector<Instruction>& code);
+
+    // Transformations: append each simplified block of input to code
+    void simplifyBlocks(const std::vector<Instruction>& input, std::vector<Instruction>& code);
+    int simplifyTail(std::vector<Instruction>& code, int start, int end);
+    bool foldConstants(Word v1, Word v2, OprCode opr, Word& result) const;
+
+    // Reconstruction: compact reachable blocks and relink jumps and calls
+    void flattenAndRemap(std::vector<Instruction>& code);
+
+    bool isLeader(int addr) const { return (leaders_[static_cast<size_t>(addr) / 64] >> (addr % 64)) & 1; }
+    void setLeader(int addr) { leaders_[static_cast<size_t>(addr) / 64] |= uint64_t(1) << (addr % 64); }
+    int blockOfTarget(Word target) const;   // -1 unless target starts a block
+
+    int size_ = 0;                      // Instructions in the input
+    std::vector<uint64_t> leaders_;     // Bit per address: starts a block
+    std::vector<int> leaderRank_;       // Per 64-bit word: leaders before it
+    std::vector<int> blockBegin_;       // Per block: start in the simplified code (+ sentinel)
+    std::vector<int> newStart_;         // Per block: address in the output
+    int outputSize_ = 0;
+    std::vector<bool> reachable_;       // Per block
+    std::vector<int> worklist_;
+
+    bool checkOverflow_;
 };
 
 } // namespace pl0
@@ -5,6 +5,8 @@
 #include "SymbolTable.h"
 #include "Instruction.h"
 #include "Diagnostics.h"
+#include "ProcedureCache.h"
+#include <iosfwd>
 
 namespace pl0 {
 
@@ -18,6 +20,10 @@ public:
     bool parse();
 
     void enableAstDump(bool enable) { dumpAst_ = enable; }
+    void setAstOutput(std::ostream& out) { astOut_ = &out; }
+
+    // Reuse unchanged procedures from a previous compilation (nullptr disables)
+    void setProcedureCache(ProcedureCache* cache) { procCache_ = cache; }
 
 private:
     void advance();                             
@@ -48,13 +54,33 @@ private:
     void parseFactor();                         // <factor>
     
     // Helper
-    int emit(OpCode op, int L, int A);          // Wrapper around CodeGenerator::emit with line #
-    void parseArrayElementAddress(Symbol& sym); // Handles array subscript, bounds check, and address calc
+    int emit(OpCode op, int L, Word A);         // Wrapper around CodeGenerator::emit with line #
+    void parseArrayElementAddress(const Symbol& sym); // Handles array subscript, bounds check, and address calc
 
     // AST Debug Output 
-    void astEnter(const std::string& nodeName);
+    void astEnter(const char* nodeName);
     void astLeave();
 
+    // Incremental compilation (procedure cache)
+    struct ProcRecording {
+        CachedProcedure entry;
+        size_t offset;          // Source offset of the 'procedure' token
+        int startLine;
+        int startColumn;
+        int codeStart;
+        int historyStart;       // Symbols at or after this history index are declared inside
+        int diagCount;          // Errors + warnings when recording began
+        std::vector<std::pair<int, int>> externalCalls;  // Absolute CAL address, callee handle
+    };
+    
+    bool replayCachedProcedure();               // At 'procedure': replay a cache hit, false on miss
+    void beginRecording();
+    void finishRecording();
+    int declareSymbol(const Token& name, SymbolKind kind, int address);  // symTable_.registerSymbol by identifier id
+    int lookupSymbol(const Token& name);      // symTable_.lookup by identifier id, with dependency tracking
+    void noteDependency(const Symbol& sym);
+    void noteCall(int addr, const Symbol& callee);
+
     // Data Members
     Lexer& lexer_;
     SymbolTable& symTable_;
@@ -65,8 +91,12 @@ private:
     Token previousToken_;
     
     bool dumpAst_;
+    std::ostream* astOut_;
     int astIndent_;
     int currentTempOffset_; // Reserved for temporary calculations (e.g. bounds check)
+    
+    ProcedureCache* procCache_;
+    std::vector<ProcRecording> recordings_;     // Procedures being recorded, innermost last
 };
 
 } // namespace pl0
@@ -0,0 +1,100 @@
+#ifndef PL0_PROCEDURE_CACHE_H
+#define PL0_PROCEDURE_CACHE_H
+
+#include "Instruction.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace pl0 {
+
+// Outer symbol referenced from inside a cached procedure. The procedure is
+// only reused if every dependency still resolves to an equivalent symbol.
+// Entries outlive the compilation that recorded them, so dependencies are
+// kept by name and resolved against the new compilation's identifiers.
+struct SymbolDependency {
+    std::string name;
+    Symbol symbol;          // Snapshot at record time (PROCEDURE address is relinked, not compared)
+};
+
+// Call from a cached procedure to a procedure declared outside of it
+struct ExternalCall {
+    int codeIndex;          // Index of the CAL within CachedProcedure::code
+    int dependency;         // Index of the callee in CachedProcedure::dependencies
+};
+
+// Compiled form of one procedure declaration, position independent:
+//   - JMP/JPC and internal CAL targets are relative to the first instruction
+//   - instruction line numbers are relative to the 'procedure' line
+//   - nested PROCEDURE symbol addresses are relative to the first instruction
+struct CachedProcedure {
+    std::string name;
+    std::string text;       // Exact source from 'procedure' through its final 'end'
+    int level = 0;          // Symbol table level of the declaration
+    int astIndent = -1;     // AST indent at record time, -1 if no AST text was recorded
+    std::string astText;
+
+    std::vector<SymbolDependency> dependencies;
+    std::vector<Instruction> code;
+    std::vector<ExternalCall> externalCalls;
+    std::vector<Symbol> symbols;    // History entries; [0] is the procedure itself
+    int entryOffset = 0;            // Procedure entry (INT) relative to code start
+
+    // Final 'end' of the span. Line and offset are relative to the 'procedure'
+    // token; the column too when both are on the same line.
+    Token lastToken;
+
+    uint64_t lastUsed = 0;          // Generation of the last pass that used this entry
+
+    // Symbol names and the lastToken literal point into the recording
+    // compilation's context, which the cache outlives; store() moves them here
+    std::string ownedText;
+};
+
+// Cache of compiled procedures across recompilations of the same buffer
+// (GUI edit/compile cycle). The parser looks up each procedure declaration
+// by name and source text; on a hit it replays the cached code, symbols and
+// AST text instead of parsing the body. Only error-free procedures are stored.
+class ProcedureCache {
+public:
+    ProcedureCache() = default;
+
+    // Begin/end one compilation; endPass() drops entries the pass did not use
+    void beginPass();
+    void endPass();
+
+    // Find a reusable entry for the declaration starting at source[offset].
+    // ident: id of the procedure name in symTable's context.
+    // wantAst: the caller dumps the AST and needs text recorded at astIndent.
+    const CachedProcedure* find(int ident, std::string_view source, size_t offset,
+                                const SymbolTable& symTable, bool wantAst, int astIndent);
+
+    // Symbol handles of the dependencies of the entry find() last returned
+    const std::vector<int>& getDependencyHandles() const { return resolved_; }
+
+    void store(CachedProcedure entry);
+    void clear();
+
+    int getEntryCount() const { return static_cast<int>(entries_.size()); }
+    int getHits() const { return hits_; }       // Reused procedures in the current pass
+    int getMisses() const { return misses_; }   // Recompiled procedures in the current pass
+
+private:
+    static bool sameSymbol(const Symbol& a, const Symbol& b);
+    static void takeOwnership(CachedProcedure& entry);
+    bool dependenciesHold(const CachedProcedure& entry, const SymbolTable& symTable);
+
+    std::unordered_multimap<std::string, CachedProcedure> entries_;
+    std::vector<int> resolved_;     // Dependency handles, filled by dependenciesHold()
+    uint64_t generation_ = 0;
+    int hits_ = 0;
+    int misses_ = 0;
+};
+
+} // namespace pl0
+
+#endif // PL0_PROCEDURE_CACHE_H
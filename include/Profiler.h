@@ -0,0 +1,72 @@
+#ifndef PL0_PROFILER_H
+#define PL0_PROFILER_H
+
+#include "Instruction.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <iosfwd>
+
+namespace pl0 {
+class SymbolTable;
+class SourceManager;
+
+// Instruction-level profiler for the interpreter (pl0c --profile).
+// The interpreter calls record() before every instruction; it bumps a per-PC
+// counter and follows CAL/RET through a call tree. Per-opcode, per-line and
+// per-procedure figures are aggregated from these when reporting.
+class Profiler {
+public:
+    explicit Profiler(const std::vector<Instruction>& code);
+
+    // Name procedures after PROCEDURE symbols (by entry address).
+    // Entries without a symbol are shown as proc@<address>.
+    void setSymbolTable(const SymbolTable* symTable);
+
+    void record(int pc) {
+        pcCounts_[pc]++;
+        nodes_[current_].self++;
+        const Instruction& instr = code_[pc];
+        if (instr.op == OpCode::CAL) {
+            enter(instr.A);
+        } else if (instr.op == OpCode::OPR && instr.A == static_cast<int>(OprCode::RET)) {
+            leave();
+        }
+    }
+
+    uint64_t getTotal() const;
+
+    // Sorted tables: procedures (inclusive/exclusive), hottest lines, opcodes
+    void report(std::ostream& out, const SourceManager* source = nullptr, int maxRows = 20) const;
+
+    // One "main;outer;inner <count>" line per call path with exclusive
+    // instructions (input for flamegraph.pl and compatible tools)
+    void writeCollapsedStacks(std::ostream& out) const;
+
+private:
+    // Call tree node: one per distinct call path
+    struct Node {
+        int entry;          // Procedure entry address, -1 for the main program
+        int parent;         // -1 for the root
+        uint64_t self;      // Instructions executed with this node on top
+        uint64_t calls;
+    };
+
+    void enter(int entry);
+    void leave();
+
+    std::string procName(int entry) const;
+    std::vector<std::vector<int>> children() const;
+
+    const std::vector<Instruction>& code_;
+    std::vector<uint64_t> pcCounts_;
+    std::vector<Node> nodes_;
+    std::unordered_map<uint64_t, int> childIndex_;     // (parent, entry) -> node
+    int current_;
+    std::unordered_map<int, std::string> procNames_;
+};
+
+} // namespace pl0
+
+#endif // PL0_PROFILER_H
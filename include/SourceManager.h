@@ -22,7 +22,7 @@ public:
     std::string getLine(int lineNum) const;
 
     // Get total line count
-    int getLineCount() const { return static_cast<int>(lines_.size()); }
+    int getLineCount() const { return static_cast<int>(lineStarts_.size()); }
 
     // Get filename
     const std::string& getFilename() const { return filename_; }
@@ -31,12 +31,12 @@ public:
     const std::string& getSource() const { return source_; }
 
 private:
-    // Split source into lines
+    // Record where each line starts
     void splitLines();
 
     std::string filename_;
-    std::string source_;            // Complete source code
-    std::vector<std::string> lines_; // Split by lines
+    std::string source_;                // Complete source code
+    std::vector<size_t> lineStarts_;    // Byte offset of each line in source_
 };
 
 } // namespace pl0
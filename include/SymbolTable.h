@@ -2,9 +2,14 @@
 #define PL0_SYMBOL_TABLE_H
 
 #include <string>
+#include <string_view>
+#include <iostream>
 #include <vector>
-#include <unordered_map>
-#include <list>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "Common.h"
+#include "CompilationContext.h"
 
 namespace pl0 {
 
@@ -17,9 +22,9 @@ enum class SymbolKind {
     POINTER         // Pointer
 };
 
-// Symbol table entry
+// Symbol table entry (expanded view of a table record)
 struct Symbol {
-    std::string name;       // Identifier name
+    std::string_view name;  // Identifier name (owned by the table's CompilationContext)
     SymbolKind kind;        // Symbol kind
     int level;              // Definition level (0 = main program)
     int address;            // Address/offset
@@ -28,84 +33,109 @@ struct Symbol {
                             //   ARRAY: array base stack frame offset
                             //   PROCEDURE: code entry address
 
-    int value;              // CONSTANT: constant value
+    Word value;             // CONSTANT: constant value
     int size;               // ARRAY: array size
     int paramCount;         // PROCEDURE: parameter count
     
-    int tableIndex;         // Index in symbol stack (for fast deletion)
-    int historyIndex;       // Index in allSymbols_ (for dump sync)
+    int historyIndex;       // Index in the history, also the symbol's handle
+    int shadowed;           // Handle of the outer symbol with this name while in scope, -1 if none
 
     Symbol() : kind(SymbolKind::VARIABLE), level(0), address(0), 
-               value(0), size(0), paramCount(0), tableIndex(-1), historyIndex(-1) {}
+               value(0), size(0), paramCount(0), historyIndex(-1), shadowed(-1) {}
     
-    Symbol(const std::string& n, SymbolKind k, int lv, int addr)
+    Symbol(std::string_view n, SymbolKind k, int lv, int addr)
         : name(n), kind(k), level(lv), address(addr), 
-          value(0), size(0), paramCount(0), tableIndex(-1), historyIndex(-1) {}
+          value(0), size(0), paramCount(0), historyIndex(-1), shadowed(-1) {}
 };
 
-// Hash table entry: list of indices for symbols with same name
-struct HashEntry {
-    std::list<int> indices;  // Indices into symbol stack (front = innermost scope)
-};
-
-// Symbol table manager class (Stack + Hash Table implementation)
+// Symbol table manager class (scoped symbol table keyed by identifier id)
+//
+// Every symbol ever registered is one compact record in records_, and its
+// index there is the handle returned by registerSymbol() and lookup().
+// Names are interned in the CompilationContext; the parser passes the id
+// its tokens carry, so lookups index innermost_ directly without hashing.
+// An identifier's innermost symbol in scope links to the symbols it
+// shadows. Each registration logs its identifier, so leaving a scope rolls
+// the log back to the scope's mark. The name overloads intern or find the
+// name first (cache replay, debugger, GUI).
 class SymbolTable {
 public:
+    // Names are interned in context; a table without one makes its own
     SymbolTable();
+    explicit SymbolTable(std::shared_ptr<CompilationContext> context);
+
+    CompilationContext& getContext() const { return *context_; }
 
     // Enter new scope (level + 1)
     void enterScope();
     
-    // Leave scope (pop all symbols from current level, update hash table)
+    // Leave scope (symbols of the current level go out of scope)
     void leaveScope();
     
     // Get current level
     int getCurrentLevel() const { return currentLevel_; }
 
-    // Returns: index in symbol stack, -1 on failure (duplicate definition)
-    int registerSymbol(const std::string& name, SymbolKind kind, int address);
+    // Returns: symbol handle, -1 on failure (duplicate definition)
+    int registerSymbol(int ident, SymbolKind kind, int address);
+    int registerSymbol(std::string_view name, SymbolKind kind, int address);
     
-    // Returns: index in symbol stack, -1 if not found
-    int lookup(const std::string& name) const;
+    // Returns: handle of the innermost symbol in scope, -1 if not found
+    int lookup(int ident) const;
+    int lookup(std::string_view name) const;
     
     // Lookup only in current scope (for detecting duplicate definitions)
-    int lookupCurrentScope(const std::string& name) const;
+    int lookupCurrentScope(int ident) const;
+    int lookupCurrentScope(std::string_view name) const;
     
     // Check if symbol exists
-    bool exists(const std::string& name) const;
+    bool exists(std::string_view name) const;
 
-    Symbol& getSymbol(int index);
-    const Symbol& getSymbol(int index) const;
+    // Expanded copy of a record
+    Symbol getSymbol(int index) const;
     
     void updateSymbolAddress(int index, int address);
     void updateSymbolParamCount(int index, int paramCount);
     void updateSymbolSize(int index, int size);
-    void updateSymbolValue(int index, int value);
+    void updateSymbolValue(int index, Word value);
     
-    // Get symbol stack size
-    int getTableSize() const { return static_cast<int>(symbolStack_.size()); }
+    // Number of symbols in scope
+    int getTableSize() const { return static_cast<int>(scopeLog_.size()); }
     
-    // Debug API: Access all recorded symbols
-    const std::vector<Symbol>& getAllSymbols() const { return allSymbols_; }
+    // Debug API: all recorded symbols, expanded
+    std::vector<Symbol> getAllSymbols() const;
+    int getHistorySize() const { return static_cast<int>(records_.size()); }
+    
+    // Append a history-only entry (symbols of a procedure replayed from cache)
+    void appendHistory(const Symbol& sym);
 
     // Debug Output
-    void dump() const;
-    void dumpHashTable() const;
+    void dump(std::ostream& out = std::cout) const;
+    void dumpHashTable(std::ostream& out = std::cout) const;
 
 private:
-    void removeFromHashTable(const std::string& name, int index);
-    void addToHashTable(const std::string& name, int index);
-
-    std::vector<Symbol> symbolStack_;
+    // History record of one symbol; getSymbol() expands it into a Symbol
+    struct Record {
+        int ident;
+        int address;
+        Word value;         // CONSTANT: value, ARRAY: size, PROCEDURE: parameter count
+        int shadowed;       // Handle of the outer symbol with this name while in scope, -1 if none
+        int level;
+        SymbolKind kind;
+    };
+
+    // Keeps symbol names alive for as long as any copy of the table
+    std::shared_ptr<CompilationContext> context_;
+
+    // Complete symbol history: every symbol ever registered (for dump)
+    std::vector<Record> records_;
     
-    // Complete symbol history: stores ALL symbols ever registered (for dump)
-    std::vector<Symbol> allSymbols_;
+    // Handle of the innermost symbol in scope per identifier id, -1 if none
+    std::vector<int> innermost_;
     
-    // Hash table: name -> list of symbol indices
-    // List head is the innermost (newest) symbol
-    std::unordered_map<std::string, HashEntry> hashTable_;
+    // Rollback log: identifier of each symbol in scope, innermost last
+    std::vector<int> scopeLog_;
     
-    // Scope stack: records start index for each level
+    // Scope stack: scopeLog_ size when each level was entered
     std::vector<int> scopeStack_;
     
     // Current level
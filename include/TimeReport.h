@@ -0,0 +1,70 @@
+#ifndef PL0_TIME_REPORT_H
+#define PL0_TIME_REPORT_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+#include <utility>
+
+namespace pl0 {
+
+// Heap allocations made by the calling thread since it started. Counted by
+// the global operator new defined in TimeReport.cpp, which is linked into
+// every program that uses TimeReport/ScopedPhase.
+struct AllocationCounter {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    static AllocationCounter current();
+};
+
+// Peak resident set size of the process in bytes (0 if unavailable)
+size_t peakRss();
+
+// Per-phase wall time, allocations and peak RSS (pl0c --time-report)
+class TimeReport {
+public:
+    struct Phase {
+        std::string name;
+        double seconds = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        size_t peakRss = 0;         // Process high-water mark when the phase ended
+    };
+
+    void add(Phase phase) { phases_.push_back(std::move(phase)); }
+    const std::vector<Phase>& getPhases() const { return phases_; }
+    bool empty() const { return phases_.empty(); }
+
+    // Table with one row per phase and a total
+    void print(std::ostream& out) const;
+
+private:
+    std::vector<Phase> phases_;
+};
+
+// Measures from construction until stop() (or destruction) and adds the
+// phase to report. A null report disables measuring entirely.
+class ScopedPhase {
+public:
+    ScopedPhase(TimeReport* report, const char* name);
+    ~ScopedPhase() { stop(); }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    void stop();
+
+private:
+    TimeReport* report_;
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+    AllocationCounter allocStart_;
+};
+
+} // namespace pl0
+
+#endif // PL0_TIME_REPORT_H
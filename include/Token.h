@@ -1,7 +1,9 @@
 #ifndef PL0_TOKEN_H
 #define PL0_TOKEN_H
 
-#include <string>
+#include <string_view>
+#include <cstddef>
+#include "Common.h"
 
 namespace pl0 {
 
@@ -66,18 +68,54 @@ enum class TokenType {
 // Token structure
 struct Token {
     TokenType type;         // Token type
-    std::string literal;    // Lexeme (UTF-8)
-    int value;              // Numeric value (only valid for NUMBER type)
+    int ident;              // Identifier id in the lexer's CompilationContext (IDENT only, else -1)
+    std::string_view literal; // Lexeme (UTF-8), owned by the lexer's CompilationContext
+    Word value;             // Numeric value (only valid for NUMBER type)
     int line;               // Line number (1-based)
     int column;             // Column number (1-based, character count)
     int length;             // Token length (character count, for error indication)
+    int offset;             // Byte offset of the lexeme in the source
 
-    Token() : type(TokenType::END_OF_FILE), value(0), line(0), column(0), length(0) {}
+    Token() : type(TokenType::END_OF_FILE), ident(-1), value(0), line(0), column(0), length(0), offset(0) {}
     
-    Token(TokenType t, const std::string& lit, int ln, int col, int len)
-        : type(t), literal(lit), value(0), line(ln), column(col), length(len) {}
+    Token(TokenType t, std::string_view lit, int ln, int col, int len)
+        : type(t), ident(-1), literal(lit), value(0), line(ln), column(col), length(len), offset(0) {}
 };
 
+// Reserved words of the language (case-sensitive)
+struct Keyword {
+    const char* spelling;
+    TokenType type;
+};
+
+inline constexpr Keyword KEYWORDS[] = {
+    {"program",   TokenType::KW_PROGRAM},
+    {"const",     TokenType::KW_CONST},
+    {"var",       TokenType::KW_VAR},
+    {"procedure", TokenType::KW_PROCEDURE},
+    {"begin",     TokenType::KW_BEGIN},
+    {"end",       TokenType::KW_END},
+    {"if",        TokenType::KW_IF},
+    {"then",      TokenType::KW_THEN},
+    {"else",      TokenType::KW_ELSE},
+    {"while",     TokenType::KW_WHILE},
+    {"do",        TokenType::KW_DO},
+    {"for",       TokenType::KW_FOR},
+    {"to",        TokenType::KW_TO},
+    {"downto",    TokenType::KW_DOWNTO},
+    {"call",      TokenType::KW_CALL},
+    {"read",      TokenType::KW_READ},
+    {"write",     TokenType::KW_WRITE},
+    {"odd",       TokenType::KW_ODD},
+    {"mod",       TokenType::KW_MOD},
+    {"new",       TokenType::KW_NEW},
+    {"delete",    TokenType::KW_DELETE}
+};
+
+// Classify the identifier lexeme [text, text + len) via a compile-time
+// perfect hash over KEYWORDS. Returns TokenType::IDENT for non-keywords.
+TokenType lookupKeyword(const char* text, size_t len);
+
 const char* tokenTypeToString(TokenType type);
 
 } // namespace pl0
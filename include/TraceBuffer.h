@@ -0,0 +1,145 @@
+#ifndef PL0_TRACE_BUFFER_H
+#define PL0_TRACE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Common.h"
+#include "Instruction.h"
+
+namespace pl0 {
+
+class DebugInfo;
+
+// One traced instruction and the registers before it executes
+struct TraceRecord {
+    int32_t pc;
+    uint8_t op;             // OpCode
+    uint8_t level;          // L
+    uint16_t reserved;
+    int32_t b;
+    int32_t t;
+    int32_t h;
+    int64_t a;              // A (any word size)
+};
+static_assert(sizeof(TraceRecord) == 32, "trace records are 32 bytes");
+
+// Binary execution trace: a ring of fixed-size TraceRecords that keeps the
+// newest 'capacity' instructions, preceded by a header and, per code
+// address, its source line and procedure, so a trace can be filtered and
+// rendered without the program. Recording is a plain store per instruction.
+//
+// In memory, or written straight into a file through a shared mapping
+// (without mmap the image is kept in memory and written by close()). The
+// pl0-trace tool opens such a file and renders it as text.
+class TraceBuffer {
+public:
+    static constexpr size_t DEFAULT_RECORDS = size_t(1) << 20;    // 32 MiB
+    static constexpr size_t MAX_NAME = 63;                          // Procedure name bytes kept
+
+    TraceBuffer() = default;
+    ~TraceBuffer();
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    // Ring of at least 'records' slots (rounded up to a power of two) for
+    // code; procedure names come from debugInfo when given. path empty: in
+    // memory, else create/truncate that file. Returns false on error (see
+    // getError()).
+    bool create(const std::vector<Instruction>& code, const DebugInfo* debugInfo, size_t records,
+                const std::string& path = std::string());
+
+    // Map a trace file written by create(), read-only
+    bool open(const std::string& path);
+
+    // Release the buffer; a file is complete after this (or the destructor)
+    bool close();
+
+    const std::string& getError() const { return error_; }
+
+    void record(int pc, const Instruction& instr, int b, int t, int h) {
+        TraceRecord& rec = ring_[total_ & mask_];
+        rec.pc = pc;
+        rec.op = static_cast<uint8_t>(instr.op);
+        rec.level = static_cast<uint8_t>(instr.L);
+        rec.reserved = 0;
+        rec.b = b;
+        rec.t = t;
+        rec.h = h;
+        rec.a = instr.A;
+        total_++;
+    }
+
+    // Store the record count in the header. The interpreter calls this at
+    // every interrupt poll, so the file of a run that dies without close()
+    // is missing at most the last poll interval's records.
+    void publish() {
+        if (header_) header_->total = total_;
+    }
+
+    // Instructions recorded; the ring holds the newest size() of them
+    uint64_t getTotal() const { return total_; }
+    size_t size() const { return total_ < mask_ + 1 ? static_cast<size_t>(total_) : mask_ + 1; }
+    size_t capacity() const { return ring_ ? mask_ + 1 : 0; }
+
+    // i-th record held, oldest first; its instruction number is
+    // getTotal() - size() + i
+    const TraceRecord& operator[](size_t i) const { return ring_[(total_ - size() + i) & mask_]; }
+
+    // Code the trace was taken from
+    int getCodeSize() const { return header_ ? static_cast<int>(header_->codeSize) : 0; }
+    int lineAt(int pc) const;                       // -1 outside the code
+    int procedureAt(int pc) const;                  // Index into getProcedures(), -1 outside the code
+    std::vector<std::string_view> getProcedures() const;   // "main" first
+
+    // Text rendering of a record, the layout of the interpreter's --trace
+    static void print(std::ostream& out, const TraceRecord& rec, int line);
+
+private:
+    struct Header {
+        char magic[8];          // "PL0TRACE"
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t capacity;      // Ring slots, a power of two
+        uint64_t total;         // Records written; slot of record n is n % capacity
+        uint32_t codeSize;      // PcInfo entries
+        uint32_t procedureCount;
+        uint64_t ringOffset;    // Byte offset of the ring
+        int32_t wordBits;       // sizeof(Word) * 8 of the writer
+        uint32_t reserved[3];
+    };
+    struct PcInfo {
+        int32_t line;
+        int32_t procedure;
+    };
+    struct ProcedureName {
+        char name[MAX_NAME + 1];    // NUL terminated, truncated
+    };
+
+    bool allocate(size_t bytes, const std::string& path);
+    bool bind(size_t bytes);        // Point the sections into base_; false if inconsistent
+    void reset();
+
+    char* base_ = nullptr;
+    size_t bytes_ = 0;
+    bool mapped_ = false;
+    int fd_ = -1;
+    std::string path_;              // File to write on close() when not mapped
+    std::vector<char> fallback_;    // Without mmap (or if mapping fails)
+
+    Header* header_ = nullptr;
+    const PcInfo* pcInfo_ = nullptr;
+    const ProcedureName* names_ = nullptr;
+    TraceRecord* ring_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t total_ = 0;
+    std::string error_;
+};
+
+} // namespace pl0
+
+#endif // PL0_TRACE_BUFFER_H
@@ -0,0 +1,34 @@
+#ifndef PL0_WORKER_POOL_H
+#define PL0_WORKER_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace pl0 {
+
+// Work-stealing worker pool for independent jobs (e.g. one compilation per job)
+// Jobs are dealt round-robin into per-worker deques. A worker pops from the
+// front of its own deque and steals from the back of the others once it
+// runs dry, so a few slow jobs do not leave the remaining workers idle.
+class WorkerPool {
+public:
+    // workers <= 0 selects the hardware concurrency
+    explicit WorkerPool(int workers);
+
+    int getWorkerCount() const { return workers_; }
+
+    // Run job(i) for every i in [0, count) and block until all have finished.
+    // onDone(i) runs on the calling thread in index order, as soon as jobs
+    // 0..i have all completed (used for deterministic, ordered output).
+    // The first exception thrown by a job is rethrown after all jobs finish.
+    void run(size_t count,
+             const std::function<void(size_t)>& job,
+             const std::function<void(size_t)>& onDone = nullptr);
+
+private:
+    int workers_;
+};
+
+} // namespace pl0
+
+#endif // PL0_WORKER_POOL_H
@@ -11,8 +11,8 @@
 
 namespace pl0 {
 
-bool isTerminal() {
-    return isatty(fileno(stdout)) != 0;
+bool isTerminal(std::FILE* stream) {
+    return isatty(fileno(stream)) != 0;
 }
 
 // Get UTF-8 character byte length from first byte
@@ -25,7 +25,7 @@ int utf8CharLen(unsigned char c) {
 }
 
 // Get UTF-8 string character count
-int utf8StringLen(const std::string& s) {
+int utf8StringLen(std::string_view s) {
     int count = 0;
     size_t i = 0;
     while (i < s.size()) {
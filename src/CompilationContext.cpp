@@ -0,0 +1,82 @@
+#include "CompilationContext.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace pl0 {
+
+namespace {
+
+// First arena block when no hint is given; later blocks grow geometrically
+constexpr size_t MIN_ARENA_BLOCK = 4096;
+
+constexpr size_t INITIAL_INDEX_SIZE = 64;   // Power of two
+
+} // namespace
+
+CompilationContext::CompilationContext(size_t sizeHint)
+    : arena_(std::max(sizeHint, MIN_ARENA_BLOCK)), textBytes_(0),
+      index_(INITIAL_INDEX_SIZE, Slot{0, -1}) {}
+
+std::string_view CompilationContext::saveText(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* copy = static_cast<char*>(arena_.allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    textBytes_ += text.size();
+    return std::string_view(copy, text.size());
+}
+
+// Identifier Index 
+
+int CompilationContext::findIdent(std::string_view name, size_t hash) const {
+    size_t mask = index_.size() - 1;
+    uint32_t tag = static_cast<uint32_t>(hash);
+    for (size_t i = hash & mask; index_[i].ident >= 0; i = (i + 1) & mask) {
+        if (index_[i].hash == tag && idents_[index_[i].ident].name == name) {
+            return index_[i].ident;
+        }
+    }
+    return -1;
+}
+
+int CompilationContext::findIdent(std::string_view name) const {
+    return findIdent(name, std::hash<std::string_view>()(name));
+}
+
+int CompilationContext::internIdent(std::string_view name) {
+    size_t hash = std::hash<std::string_view>()(name);
+    int id = findIdent(name, hash);
+    if (id >= 0) {
+        return id;
+    }
+    
+    if ((idents_.size() + 1) * 2 > index_.size()) {
+        growIndex();
+    }
+    id = static_cast<int>(idents_.size());
+    idents_.push_back({saveText(name), hash});
+    
+    size_t mask = index_.size() - 1;
+    size_t i = hash & mask;
+    while (index_[i].ident >= 0) {
+        i = (i + 1) & mask;
+    }
+    index_[i] = {static_cast<uint32_t>(hash), id};
+    return id;
+}
+
+void CompilationContext::growIndex() {
+    index_.assign(index_.size() * 2, Slot{0, -1});
+    size_t mask = index_.size() - 1;
+    for (size_t id = 0; id < idents_.size(); id++) {
+        size_t i = idents_[id].hash & mask;
+        while (index_[i].ident >= 0) {
+            i = (i + 1) & mask;
+        }
+        index_[i] = {static_cast<uint32_t>(idents_[id].hash), static_cast<int>(id)};
+    }
+}
+
+} // namespace pl0
@@ -0,0 +1,61 @@
+#include "DataStore.h"
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PL0_HAVE_MMAP 1
+#include <sys/mman.h>
+#else
+#define PL0_HAVE_MMAP 0
+#endif
+
+#if PL0_HAVE_MMAP && !defined(MAP_NORESERVE)
+#define MAP_NORESERVE 0
+#endif
+
+namespace pl0 {
+
+DataStore::~DataStore() {
+    release();
+}
+
+void DataStore::release() {
+#if PL0_HAVE_MMAP
+    if (mapped_) {
+        munmap(data_, size_ * sizeof(Word));
+    }
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    std::vector<Word>().swap(fallback_);
+}
+
+bool DataStore::reserve(size_t words) {
+    release();
+    if (words == 0) {
+        return true;
+    }
+
+#if PL0_HAVE_MMAP
+    // Fresh anonymous pages read as zero and are only backed once written
+    void* map = mmap(nullptr, words * sizeof(Word), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map != MAP_FAILED) {
+        data_ = static_cast<Word*>(map);
+        size_ = words;
+        mapped_ = true;
+        return true;
+    }
+#endif
+
+    try {
+        fallback_.assign(words, 0);
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    data_ = fallback_.data();
+    size_ = words;
+    return true;
+}
+
+} // namespace pl0
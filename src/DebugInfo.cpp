@@ -0,0 +1,133 @@
+#include "DebugInfo.h"
+#include <algorithm>
+
+namespace pl0 {
+
+namespace {
+
+// End of the body starting at entry: the address after its return. The body
+// of a procedure contains no other code, so this is the first RET.
+int bodyEnd(const std::vector<Instruction>& code, int entry) {
+    int size = static_cast<int>(code.size());
+    for (int pc = std::max(entry, 0); pc < size; pc++) {
+        if (code[pc].op == OpCode::OPR && static_cast<OprCode>(code[pc].A) == OprCode::RET) {
+            return pc + 1;
+        }
+    }
+    return size;
+}
+
+} // namespace
+
+void DebugInfo::build(const SymbolTable& symbols, const std::vector<Instruction>& code) {
+    scopes_.clear();
+    variables_.clear();
+
+    // The program starts with a jump over the procedures to its body
+    int mainEntry = (!code.empty() && code[0].op == OpCode::JMP) ? static_cast<int>(code[0].A) : 0;
+    scopes_.push_back({"main", -1, 1, mainEntry, bodyEnd(code, mainEntry), 0, 0});
+
+    // A procedure's names follow its symbol in the history, one level
+    // deeper; a name at the procedure's level or above closes its scope
+    std::vector<int> open{0};
+    for (const Symbol& sym : symbols.getAllSymbols()) {
+        while (open.size() > 1 && scopes_[open.back()].level > sym.level) {
+            open.pop_back();
+        }
+        if (sym.kind == SymbolKind::PROCEDURE) {
+            scopes_.push_back({std::string(sym.name), open.back(), sym.level + 1,
+                               sym.address, bodyEnd(code, sym.address), 0, 0});
+            open.push_back(static_cast<int>(scopes_.size()) - 1);
+        } else {
+            variables_.push_back({std::string(sym.name), sym.kind, open.back(),
+                                  sym.address, sym.size, sym.value});
+        }
+    }
+
+    std::stable_sort(variables_.begin(), variables_.end(), [](const Variable& a, const Variable& b) {
+        return a.scope != b.scope ? a.scope < b.scope : a.name < b.name;
+    });
+    for (size_t i = 0; i < variables_.size(); i++) {
+        Scope& scope = scopes_[variables_[i].scope];
+        if (scope.variableCount++ == 0) {
+            scope.firstVariable = static_cast<int>(i);
+        }
+    }
+
+    sortRanges();
+    buildLines(code);
+}
+
+void DebugInfo::relocate(const std::function<int(int)>& newAddress, const std::vector<Instruction>& code) {
+    for (Scope& scope : scopes_) {
+        scope.codeBegin = newAddress(scope.codeBegin);
+        scope.codeEnd = newAddress(scope.codeEnd);
+        if (scope.codeBegin < 0 || scope.codeEnd < scope.codeBegin) {
+            scope.codeBegin = scope.codeEnd = -1;   // Removed
+        }
+    }
+    sortRanges();
+    buildLines(code);
+}
+
+void DebugInfo::sortRanges() {
+    ranges_.resize(scopes_.size());
+    for (size_t i = 0; i < ranges_.size(); i++) {
+        ranges_[i] = static_cast<int>(i);
+    }
+    std::sort(ranges_.begin(), ranges_.end(), [this](int a, int b) {
+        return scopes_[a].codeBegin < scopes_[b].codeBegin;
+    });
+}
+
+void DebugInfo::buildLines(const std::vector<Instruction>& code) {
+    lines_.clear();
+    codeSize_ = static_cast<int>(code.size());
+    for (int pc = 0; pc < codeSize_; pc++) {
+        if (lines_.empty() || lines_.back().line != code[pc].line) {
+            lines_.push_back({pc, code[pc].line});
+        }
+    }
+}
+
+int DebugInfo::scopeAt(int pc) const {
+    if (scopes_.empty()) return -1;
+    // Last body starting at or before pc
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), pc, [this](int addr, int id) {
+        return addr < scopes_[id].codeBegin;
+    });
+    if (it != ranges_.begin()) {
+        const Scope& scope = scopes_[*(it - 1)];
+        if (pc < scope.codeEnd) {
+            return *(it - 1);
+        }
+    }
+    return 0;
+}
+
+const DebugInfo::Variable* DebugInfo::resolve(int pc, std::string_view name, int& levelDiff) const {
+    int current = scopeAt(pc);
+    for (int id = current; id >= 0; id = scopes_[id].parent) {
+        const Scope& scope = scopes_[id];
+        auto first = variables_.begin() + scope.firstVariable;
+        auto last = first + scope.variableCount;
+        auto it = std::lower_bound(first, last, name, [](const Variable& var, std::string_view key) {
+            return var.name < key;
+        });
+        if (it != last && it->name == name) {
+            levelDiff = scopes_[current].level - scope.level;
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+int DebugInfo::lineAt(int pc) const {
+    if (pc < 0 || pc >= codeSize_) return -1;
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), pc, [](int addr, const LineRange& range) {
+        return addr < range.begin;
+    });
+    return (it - 1)->line;
+}
+
+} // namespace pl0
@@ -6,7 +6,10 @@
 namespace pl0 {
 
 DiagnosticsEngine::DiagnosticsEngine(const SourceManager& srcMgr)
-    : srcMgr_(srcMgr), errorCount_(0), warningCount_(0), maxErrors_(100), useColor_(isTerminal()) {}
+    : DiagnosticsEngine(srcMgr, std::cerr) {}
+
+DiagnosticsEngine::DiagnosticsEngine(const SourceManager& srcMgr, std::ostream& out)
+    : srcMgr_(srcMgr), out_(out), errorCount_(0), warningCount_(0), maxErrors_(100), useColor_(isTerminal()) {}
 
 void DiagnosticsEngine::error(const std::string& msg, int line, int col, int len) {
     errorCount_++;
@@ -33,37 +36,37 @@ void DiagnosticsEngine::note(const std::string& msg, int line, int col, int len)
 void DiagnosticsEngine::report(const Diagnostic& diag) {
     // Format: filename:line:col: level: message
     if (useColor_) {
-        std::cerr << Color::Bold << Color::White;
+        out_ << Color::Bold << Color::White;
     }
     
-    std::cerr << srcMgr_.getFilename() << ":" << diag.line << ":" << diag.column << ": ";
+    out_ << srcMgr_.getFilename() << ":" << diag.line << ":" << diag.column << ": ";
     
     printColoredLevel(diag.level);
     
     if (useColor_) {
-        std::cerr << Color::Bold << Color::White;
+        out_ << Color::Bold << Color::White;
     }
-    std::cerr << diag.message;
+    out_ << diag.message;
     
     if (useColor_) {
-        std::cerr << Color::Reset;
+        out_ << Color::Reset;
     }
-    std::cerr << "\n";
+    out_ << "\n";
     
     // Source line echo
     std::string line = srcMgr_.getLine(diag.line);
     if (!line.empty()) {
-        std::cerr << "    " << line << "\n";
+        out_ << "    " << line << "\n";
         
         // Generate caret indicator ^~~~
         if (useColor_) {
-            std::cerr << Color::Green;
+            out_ << Color::Green;
         }
-        std::cerr << "    " << generateCaret(diag.column, diag.length);
+        out_ << "    " << generateCaret(diag.column, diag.length);
         if (useColor_) {
-            std::cerr << Color::Reset;
+            out_ << Color::Reset;
         }
-        std::cerr << "\n";
+        out_ << "\n";
     }
 }
 
@@ -71,25 +74,25 @@ void DiagnosticsEngine::printColoredLevel(DiagLevel level) {
     if (useColor_) {
         switch (level) {
             case DiagLevel::ERROR:
-                std::cerr << Color::Bold << Color::Red << "error: " << Color::Reset;
+                out_ << Color::Bold << Color::Red << "error: " << Color::Reset;
                 break;
             case DiagLevel::WARNING:
-                std::cerr << Color::Bold << Color::Yellow << "warning: " << Color::Reset;
+                out_ << Color::Bold << Color::Yellow << "warning: " << Color::Reset;
                 break;
             case DiagLevel::NOTE:
-                std::cerr << Color::Bold << Color::Cyan << "note: " << Color::Reset;
+                out_ << Color::Bold << Color::Cyan << "note: " << Color::Reset;
                 break;
         }
     } else {
         switch (level) {
             case DiagLevel::ERROR:
-                std::cerr << "error: ";
+                out_ << "error: ";
                 break;
             case DiagLevel::WARNING:
-                std::cerr << "warning: ";
+                out_ << "warning: ";
                 break;
             case DiagLevel::NOTE:
-                std::cerr << "note: ";
+                out_ << "note: ";
                 break;
         }
     }
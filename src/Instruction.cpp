@@ -7,7 +7,7 @@ namespace pl0 {
 
 CodeGenerator::CodeGenerator() {}
 
-int CodeGenerator::emit(OpCode op, int L, int A, int line) {
+int CodeGenerator::emit(OpCode op, int L, Word A, int line) {
     int addr = static_cast<int>(code_.size());
     code_.emplace_back(op, L, A, line);
     return addr;
@@ -19,79 +19,79 @@ void CodeGenerator::backpatch(int instrAddr, int targetAddr) {
     }
 }
 
-void CodeGenerator::dump() const {
-    std::cout << "\n" << Color::Cyan << "[P-Code]" << Color::Reset 
-              << " Generated Instructions:\n";
-    std::cout << std::string(60, '-') << "\n";
+void CodeGenerator::dump(std::ostream& out) const {
+    out << "\n" << Color::Cyan << "[P-Code]" << Color::Reset 
+        << " Generated Instructions:\n";
+    out << std::string(60, '-') << "\n";
     
     for (size_t i = 0; i < code_.size(); i++) {
         const auto& instr = code_[i];
-        std::cout << std::setw(4) << i << ": "
-                  << "L" << std::setw(3) << instr.line << " "
-                  << std::setw(4) << opCodeToString(instr.op) << " "
-                  << std::setw(3) << instr.L << ", "
-                  << std::setw(5) << instr.A;
+        out << std::setw(4) << i << ": "
+            << "L" << std::setw(3) << instr.line << " "
+            << std::setw(4) << opCodeToString(instr.op) << " "
+            << std::setw(3) << instr.L << ", "
+            << std::setw(5) << instr.A;
         
         // Add comment
-        std::cout << "    " << Color::Green << "; ";
+        out << "    " << Color::Green << "; ";
         switch (instr.op) {
             case OpCode::INT:
-                std::cout << "allocate " << instr.A << " units";
+                out << "allocate " << instr.A << " units";
                 break;
             case OpCode::LIT:
-                std::cout << "push constant " << instr.A;
+                out << "push constant " << instr.A;
                 break;
             case OpCode::LOD:
                 if (instr.A == 0) {
-                    std::cout << "indirect load";
+                    out << "indirect load";
                 } else {
-                    std::cout << "load [" << instr.L << ", " << instr.A << "]";
+                    out << "load [" << instr.L << ", " << instr.A << "]";
                 }
                 break;
             case OpCode::STO:
                 if (instr.A == 0) {
-                    std::cout << "indirect store";
+                    out << "indirect store";
                 } else {
-                    std::cout << "store to [" << instr.L << ", " << instr.A << "]";
+                    out << "store to [" << instr.L << ", " << instr.A << "]";
                 }
                 break;
             case OpCode::CAL:
-                std::cout << "call @" << instr.A;
+                out << "call @" << instr.A;
                 break;
             case OpCode::JMP:
-                std::cout << "jump to " << instr.A;
+                out << "jump to " << instr.A;
                 break;
             case OpCode::JPC:
-                std::cout << "jump if zero to " << instr.A;
+                out << "jump if zero to " << instr.A;
                 break;
             case OpCode::OPR:
-                std::cout << oprCodeToString(static_cast<OprCode>(instr.A));
+                out << oprCodeToString(static_cast<OprCode>(instr.A));
                 break;
             case OpCode::RED:
                 if (instr.A == 0) {
-                    std::cout << "read indirect";
+                    out << "read indirect";
                 } else {
-                    std::cout << "read to [" << instr.L << ", " << instr.A << "]";
+                    out << "read to [" << instr.L << ", " << instr.A << "]";
                 }
                 break;
             case OpCode::WRT:
-                std::cout << "write";
+                out << "write";
                 break;
             case OpCode::NEW:
-                std::cout << "heap alloc";
+                out << "heap alloc";
                 break;
             case OpCode::DEL:
-                std::cout << "heap free";
+                out << "heap free";
                 break;
             case OpCode::LAD:
-                std::cout << "load address";
+                out << "load address";
                 break;
         }
-        std::cout << Color::Reset << "\n";
+        out << Color::Reset << "\n";
     }
     
-    std::cout << std::string(60, '-') << "\n";
-    std::cout << "Total instructions: " << code_.size() << "\n";
+    out << std::string(60, '-') << "\n";
+    out << "Total instructions: " << code_.size() << "\n";
 }
 
 const char* opCodeToString(OpCode op) {
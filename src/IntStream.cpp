@@ -0,0 +1,331 @@
+#include "IntStream.h"
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PL0_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define PL0_HAVE_MMAP 0
+#endif
+
+namespace pl0 {
+
+// IntReader
+
+bool IntReader::readSlow(Word& value) {
+    for (;;) {
+        bool more = refill();
+
+        if (format_ == IntFormat::BINARY) {
+            if (end_ - pos_ >= static_cast<std::ptrdiff_t>(sizeof(Word))) {
+                std::memcpy(&value, pos_, sizeof(Word));
+                pos_ += sizeof(Word);
+                return true;
+            }
+            if (!more) {
+                pos_ = end_;    // Trailing partial value is ignored
+                return false;
+            }
+            continue;
+        }
+
+        const char* p = pos_;
+        while (p < end_ && isSpace(*p)) p++;
+        pos_ = p;
+        if (p == end_) {
+            if (!more) return false;
+            continue;
+        }
+
+        const char* q = p;
+        while (q < end_ && !isSpace(*q)) q++;
+        if (q < end_ || !more) {
+            // Complete token (or the last one in the input)
+            pos_ = q;
+            value = parse(p, q);
+            return true;
+        }
+    }
+}
+
+// StreamIntReader
+
+StreamIntReader::StreamIntReader(std::istream& in, IntFormat format, size_t bufferSize)
+    : IntReader(format), in_(in), buffer_(std::max(bufferSize, static_cast<size_t>(64))) {
+    pos_ = buffer_.data();
+    end_ = buffer_.data();
+}
+
+bool StreamIntReader::refill() {
+    // Move the unconsumed tail to the front, then read behind it
+    size_t tail = end_ - pos_;
+    if (tail == buffer_.size()) {
+        // A single token fills the whole buffer: grow
+        buffer_.resize(buffer_.size() * 2);
+    }
+    std::memmove(buffer_.data(), pos_, tail);
+
+    char* data = buffer_.data();
+    in_.read(data + tail, static_cast<std::streamsize>(buffer_.size() - tail));
+    size_t got = static_cast<size_t>(in_.gcount());
+
+    pos_ = data;
+    end_ = data + tail + got;
+    return got > 0;
+}
+
+// StreamIntWriter
+
+StreamIntWriter::StreamIntWriter(std::ostream& out, IntFormat format, size_t bufferSize)
+    : IntWriter(format), out_(out), buffer_(std::max(bufferSize, MAX_ENCODED_SIZE)), written_(0) {
+    pos_ = buffer_.data();
+    end_ = buffer_.data() + buffer_.size();
+}
+
+StreamIntWriter::~StreamIntWriter() {
+    flush();
+}
+
+void StreamIntWriter::overflow() {
+    size_t size = pos_ - buffer_.data();
+    out_.write(buffer_.data(), static_cast<std::streamsize>(size));
+    written_ += size;
+    pos_ = buffer_.data();
+}
+
+void StreamIntWriter::flush() {
+    overflow();
+    out_.flush();
+}
+
+// MappedIntReader
+
+MappedIntReader::MappedIntReader(IntFormat format)
+    : IntReader(format), map_(nullptr), mapSize_(0) {}
+
+MappedIntReader::~MappedIntReader() {
+#if PL0_HAVE_MMAP
+    if (map_) {
+        munmap(map_, mapSize_);
+    }
+#endif
+}
+
+bool MappedIntReader::open(const std::string& path) {
+#if PL0_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_ = "cannot open input file '" + path + "': " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, size, MADV_SEQUENTIAL);
+            ::close(fd);
+            map_ = map;
+            mapSize_ = size;
+            pos_ = static_cast<const char*>(map);
+            end_ = pos_ + size;
+            return true;
+        }
+    }
+    ::close(fd);
+    // Empty, not a regular file (pipe, device) or not mappable: read it
+#endif
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open input file '" + path + "'";
+        return false;
+    }
+    data_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    pos_ = data_.data();
+    end_ = data_.data() + data_.size();
+    return true;
+}
+
+// MappedIntWriter
+
+MappedIntWriter::MappedIntWriter(IntFormat format)
+    : IntWriter(format), fd_(-1), base_(nullptr), capacity_(0), fileSize_(0), written_(0), failed_(false) {}
+
+MappedIntWriter::~MappedIntWriter() {
+    close();
+}
+
+bool MappedIntWriter::open(const std::string& path, bool keep) {
+    path_ = path;
+#if PL0_HAVE_MMAP
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | (keep ? 0 : O_TRUNC), 0644);
+    if (fd_ < 0) {
+        error_ = "cannot open output file '" + path + "': " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+        // Mapping never shrinks a kept file
+        fileSize_ = static_cast<uint64_t>(st.st_size);
+        if (map(std::max<size_t>(INITIAL_CAPACITY, static_cast<size_t>(fileSize_)))) {
+            pos_ = base_;
+            return true;
+        }
+    }
+    // Not a regular file (pipe, device) or not mappable: stream it
+    ::close(fd_);
+    fd_ = -1;
+    error_.clear();
+#endif
+    std::error_code ec;
+    fileSize_ = keep && std::filesystem::is_regular_file(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    fallback_.open(path, std::ios::binary | (keep ? std::ios::app : std::ios::trunc));
+    if (!fallback_) {
+        error_ = "cannot open output file '" + path + "'";
+        return false;
+    }
+    buffer_.resize(StreamIntWriter::DEFAULT_BUFFER_SIZE);
+    pos_ = buffer_.data();
+    end_ = buffer_.data() + buffer_.size();
+    return true;
+}
+
+bool MappedIntWriter::map(size_t capacity) {
+#if PL0_HAVE_MMAP
+    if (ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+        error_ = std::string("cannot grow output file: ") + std::strerror(errno);
+        return false;
+    }
+    void* map = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        error_ = std::string("cannot map output file: ") + std::strerror(errno);
+        return false;
+    }
+    base_ = static_cast<char*>(map);
+    capacity_ = capacity;
+    end_ = base_ + capacity;
+    return true;
+#else
+    (void)capacity;
+    return false;
+#endif
+}
+
+void MappedIntWriter::fail(const std::string& message) {
+    if (!failed_) {
+        failed_ = true;
+        if (error_.empty()) {
+            error_ = message;
+        }
+    }
+    // Keep the inline write path valid; everything from here on is discarded
+    buffer_.resize(StreamIntWriter::DEFAULT_BUFFER_SIZE);
+    pos_ = buffer_.data();
+    end_ = buffer_.data() + buffer_.size();
+}
+
+void MappedIntWriter::overflow() {
+    if (failed_) {
+        pos_ = buffer_.data();
+        return;
+    }
+#if PL0_HAVE_MMAP
+    if (base_) {
+        // Double the mapping; the bytes written so far stay in place
+        size_t used = pos_ - base_;
+        munmap(base_, capacity_);
+        base_ = nullptr;
+        if (!map(capacity_ * 2)) {
+            fail(error_);
+            return;
+        }
+        pos_ = base_ + used;
+        return;
+    }
+#endif
+    fallback_.write(buffer_.data(), static_cast<std::streamsize>(pos_ - buffer_.data()));
+    written_ += pos_ - buffer_.data();
+    pos_ = buffer_.data();
+    if (!fallback_) {
+        fail("write to output file failed");
+    }
+}
+
+bool MappedIntWriter::resumeAt(uint64_t offset) {
+    if (offset > fileSize_) {
+        error_ = "output file '" + path_ + "' is shorter than the checkpoint's output ("
+               + std::to_string(fileSize_) + " < " + std::to_string(offset) + " bytes)";
+        return false;
+    }
+#if PL0_HAVE_MMAP
+    if (base_) {
+        // The rest of the mapping is overwritten or trimmed by close()
+        pos_ = base_ + offset;
+        return true;
+    }
+#endif
+    // Streamed: cut the file, then append
+    fallback_.close();
+    std::error_code ec;
+    std::filesystem::resize_file(path_, offset, ec);
+    fallback_.open(path_, std::ios::binary | std::ios::app);
+    written_ = offset;
+    if (!fallback_) {
+        error_ = "cannot open output file '" + path_ + "'";
+        return false;
+    }
+    return true;
+}
+
+uint64_t MappedIntWriter::getBytesWritten() const {
+    if (base_) {
+        return pos_ - base_;
+    }
+    return written_ + (failed_ ? 0 : pos_ - buffer_.data());
+}
+
+void MappedIntWriter::flush() {
+    if (!base_ && !failed_ && fallback_.is_open()) {
+        overflow();
+        fallback_.flush();
+    }
+}
+
+bool MappedIntWriter::close() {
+#if PL0_HAVE_MMAP
+    if (fd_ >= 0) {
+        if (base_) {
+            size_t used = pos_ - base_;
+            munmap(base_, capacity_);
+            base_ = nullptr;
+            if (ftruncate(fd_, static_cast<off_t>(used)) != 0 && !failed_) {
+                failed_ = true;
+                error_ = std::string("cannot truncate output file: ") + std::strerror(errno);
+            }
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+    if (fallback_.is_open()) {
+        flush();
+        fallback_.close();
+        if (!fallback_ && !failed_) {
+            failed_ = true;
+            error_ = "write to output file failed";
+        }
+    }
+    pos_ = nullptr;
+    end_ = nullptr;
+    return !failed_;
+}
+
+} // namespace pl0
@@ -1,14 +1,174 @@
 #include "Interpreter.h"
 #include "Common.h"
+#include "Profiler.h"
+#include "TraceBuffer.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <cstring>
 
 namespace pl0 {
 
+// I/O policies for RED/WRT. executeOne() is instantiated once per policy so
+// the common configurations resolve I/O at compile time; read() returning
+// false means "no input yet, pause until provideInput()".
+namespace {
+
+// Buffered integer streams (piped CLI, data files, test capture)
+struct BatchIO {
+    IntReader& reader;
+    IntWriter& writer;
+
+    bool read(Word& value) {
+        if (!reader.read(value)) {
+            value = 0;  // End of input
+        }
+        return true;
+    }
+    void write(Word value) { writer.write(value); }
+};
+
+// Synchronous callbacks (GUI worker thread)
+struct CallbackIO {
+    const Interpreter::InputCallback& input;
+    const Interpreter::OutputCallback& output;
+
+    bool read(Word& value) {
+        value = input();
+        return true;
+    }
+    void write(Word value) { output(value); }
+};
+
+// Prompting console (interactive CLI)
+struct ConsoleIO {
+    std::istream& in;
+    std::ostream& out;
+
+    bool read(Word& value) {
+        out << "? ";
+        out.flush();
+        if (!(in >> value)) {
+            in.clear();
+            in.ignore(10000, '\n');
+            value = 0;
+        }
+        return true;
+    }
+    void write(Word value) { out << value << std::endl; }
+};
+
+// Anything else (debugger, mixed sources): decide per value
+struct DynamicIO {
+    const Interpreter::InputCallback& input;
+    const Interpreter::OutputCallback& output;
+    IntReader* reader;
+    IntWriter* writer;
+    ConsoleIO console;
+    bool pauseForInput;     // Debugger without input callback
+
+    bool read(Word& value) {
+        if (input) {
+            value = input();
+            return true;
+        }
+        if (pauseForInput) {
+            return false;
+        }
+        if (reader) {
+            if (!reader->read(value)) {
+                value = 0;
+            }
+            return true;
+        }
+        return console.read(value);
+    }
+    void write(Word value) {
+        if (output) {
+            output(value);
+        } else if (writer) {
+            writer->write(value);
+        } else {
+            console.write(value);
+        }
+    }
+};
+
+// Recording for reverse debugging around another policy: logs read()
+// values, and while re-running recorded instructions reads from the log and
+// drops write()s that already happened
+template <class IO>
+struct RecordingIO {
+    IO& io;
+    std::vector<Word>& log;
+    uint64_t logStart;
+    const uint64_t& inputs;         // read() values consumed so far
+    const uint64_t& instructions;   // Including the one executing
+    uint64_t frontier;
+
+    bool read(Word& value) {
+        if (inputs - logStart < log.size()) {
+            value = log[inputs - logStart];
+            return true;
+        }
+        if (!io.read(value)) {
+            return false;
+        }
+        log.push_back(value);
+        return true;
+    }
+    void write(Word value) {
+        if (instructions > frontier) {
+            io.write(value);
+        }
+    }
+};
+
+} // namespace
+
+template <class Fn>
+void Interpreter::withIO(Fn&& fn) {
+    if (!debugMode_ && !recordInterval_ && !inputCb_ == !outputCb_) {
+        if (inputCb_) {
+            CallbackIO io{inputCb_, outputCb_};
+            fn(io);
+            return;
+        }
+        if (intReader_ && intWriter_) {
+            BatchIO io{*intReader_, *intWriter_};
+            fn(io);
+            return;
+        }
+        if (!intReader_ && !intWriter_) {
+            ConsoleIO io{*in_, *out_};
+            fn(io);
+            return;
+        }
+    }
+    DynamicIO io{inputCb_, outputCb_, intReader_, intWriter_, ConsoleIO{*in_, *out_},
+                 debugMode_ && !waitingForInput_};
+    if (recordInterval_ && !recorded_.empty()) {
+        RecordingIO<DynamicIO> recording{io, inputLog_, inputLogStart_, inputCount_, instructionCount_,
+                                         replayFrontier_};
+        fn(recording);
+        return;
+    }
+    fn(io);
+}
+
 Interpreter::Interpreter(const std::vector<Instruction>& code)
-    : code_(code), P_(0), B_(0), T_(0), H_(0), storeSize_(DEFAULT_STORE_SIZE), 
-      running_(false), trace_(false), debugMode_(false), debugState_(DebugState::HALTED), 
-      symTable_(nullptr), waitingForInput_(false), pendingInputAddress_(0), pendingInputIndirect_(false) {}
+    : code_(code), P_(0), B_(0), T_(0), H_(0), stackSize_(DEFAULT_STACK_SIZE),
+      heapSize_(DEFAULT_HEAP_SIZE), storeSize_(DEFAULT_STACK_SIZE + DEFAULT_HEAP_SIZE), 
+      running_(false), trace_(false), traceBuffer_(nullptr), instructionCount_(0), inputCount_(0), stopRequested_(false),
+      timeLimit_(0), timedOut_(false), checkOverflow_(false),
+      recordInterval_(0), recordLimit_(DEFAULT_RECORD_CHECKPOINTS), nextRecord_(0), inputLogStart_(0),
+      replayFrontier_(0), replaying_(false),
+      checkpointInterval_(0), nextCheckpoint_(0), snapshotOutputBytes_(0), profiler_(nullptr), statsEnabled_(false), opcodeCounts_{}, maxStackTop_(0),
+      lowestHeap_(0), liveHeap_(0), liveBlocks_(0), callDepth_(0), maxCallDepth_(0), calls_(0),
+      runTime_(0), debugMode_(false), debugState_(DebugState::HALTED), 
+      breakpointsDirty_(true), debugInfo_(nullptr), in_(&std::cin), out_(&std::cout), err_(&std::cerr),
+      intReader_(nullptr), intWriter_(nullptr),
+      waitingForInput_(false), pendingInputAddress_(0), pendingInputIndirect_(false) {}
 
 void Interpreter::run() {
     start();
@@ -16,7 +176,7 @@ void Interpreter::run() {
 }
 
 void Interpreter::start() {
-    store_.resize(storeSize_, 0);
+    storeSize_ = stackSize_ + heapSize_;
     P_ = 0;
     B_ = 0;
     T_ = 0;
@@ -24,31 +184,71 @@ void Interpreter::start() {
     freeListHead_ = -1;
     running_ = true;
     debugState_ = DebugState::RUNNING;
+    instructionCount_ = 0;
+    inputCount_ = 0;
+    nextCheckpoint_ = checkpointInterval_;
+    opcodeCounts_.fill(0);
+    maxStackTop_ = 0;
+    lowestHeap_ = storeSize_;
+    liveHeap_ = 0;
+    liveBlocks_ = 0;
+    callDepth_ = 0;
+    maxCallDepth_ = 0;
+    calls_ = 0;
+    runTime_ = std::chrono::steady_clock::duration::zero();
+    
+    if (!store_.reserve(storeSize_)) {
+        runtimeError("cannot reserve " + std::to_string(storeSize_) + " words of memory");
+        debugState_ = DebugState::ERROR;
+        return;
+    }
+    stopRequested_.store(false, std::memory_order_relaxed);
+    timedOut_ = false;
+    rebuildWatchBits();
+    watchHit_ = WatchHit();
+    if (recordInterval_) {
+        startRecording();
+    }
     
     if (trace_) {
-        std::cout << "\n" << Color::Cyan << "[Interpreter Trace]" << Color::Reset << "\n";
-        std::cout << std::string(60, '-') << "\n";
+        *out_ << "\n" << Color::Cyan << "[Interpreter Trace]" << Color::Reset << "\n";
+        *out_ << std::string(60, '-') << "\n";
     }
 }
 
 void Interpreter::resume() {
     if (debugState_ == DebugState::HALTED || debugState_ == DebugState::ERROR) return;
     
+    // Continuing from a pause must not stop on the breakpoint we are sitting on
+    bool wasPaused = debugState_ == DebugState::PAUSED;
     debugState_ = DebugState::RUNNING;
+    watchHit_ = WatchHit();
+    auto started = std::chrono::steady_clock::now();
+    deadline_ = started + timeLimit_;
     
-    while (running_ && P_ >= 0 && P_ < static_cast<int>(code_.size())) {
-        // Check Breakpoint
-        int line = code_[P_].line;
-        if (breakpoints_.count(line)) {
-            debugState_ = DebugState::PAUSED;
-            std::cout << "Breakpoint hit at line " << line << "\n";
+    bool stopped = false;
+    withIO([&](auto& io) {
+        if (breakpoints_.empty() && watchpoints_.empty() && !trace_) {
+            stopped = traceBuffer_ ? !runLoop<LoopMode::TRACE>(io)
+                    : profiler_ || statsEnabled_ ? !runLoop<LoopMode::INSTRUMENTED>(io)
+                                                 : !runLoop<LoopMode::FAST>(io);
             return;
         }
-        
-        if (!executeOne()) {
-            return;
+        if (breakpointsDirty_) {
+            rebuildBreakpointMap();
         }
-    }
+        if (wasPaused && running_ && P_ >= 0 && P_ < static_cast<int>(code_.size())) {
+            if (trace_ || traceBuffer_) traceInstruction();
+            instrument();
+            if (!executeDebug(io)) {
+                stopped = true;
+                return;
+            }
+        }
+        stopped = watchpoints_.empty() ? !runLoop<LoopMode::DEBUG>(io) : !runLoop<LoopMode::WATCH>(io);
+    });
+    runTime_ += std::chrono::steady_clock::now() - started;
+    if (stopped) return;
     
     if (running_) { // Loop exited but still running? (e.g. PC out of bounds?)
          running_ = false;
@@ -62,8 +262,11 @@ void Interpreter::step() {
     // Execute exactly one instruction
     if (running_ && P_ >= 0 && P_ < static_cast<int>(code_.size())) {
         debugState_ = DebugState::RUNNING;
-        executeOne();
-        if (running_) debugState_ = DebugState::PAUSED;
+        watchHit_ = WatchHit();
+        bool paused = true;
+        if (trace_ || traceBuffer_) traceInstruction();
+        withIO([&](auto& io) { paused = executeDebug(io); });
+        if (paused && running_) debugState_ = DebugState::PAUSED;
     }
 }
 
@@ -73,35 +276,125 @@ void Interpreter::stepOver() {
     int startLine = getCurrentLine();
     
     debugState_ = DebugState::RUNNING;
+    watchHit_ = WatchHit();
     
     int initialLine = startLine;
-    while (running_ && P_ >= 0 && P_ < static_cast<int>(code_.size())) {
-         executeOne();
-         int currentLine = code_[P_].line; // P_ is next instruction
-         
-         if (currentLine != initialLine && currentLine != 0) {
-             break;
-         }
-    }
+    auto started = std::chrono::steady_clock::now();
+    deadline_ = started + timeLimit_;
+    bool stopped = false;
+    withIO([&](auto& io) {
+        while (running_ && P_ >= 0 && P_ < static_cast<int>(code_.size())) {
+             if ((instructionCount_ & (INTERRUPT_POLL_INTERVAL - 1)) == 0 && checkInterrupt()) {
+                 stopped = true;
+                 return;
+             }
+             // Halted, failed or waiting for input
+             if (trace_ || traceBuffer_) traceInstruction();
+             if (!executeDebug(io)) {
+                 stopped = true;
+                 return;
+             }
+             int currentLine = code_[P_].line; // P_ is next instruction
+             
+             if (currentLine != initialLine && currentLine != 0) {
+                 break;
+             }
+        }
+    });
+    runTime_ += std::chrono::steady_clock::now() - started;
+    if (stopped) return;
     
     if (running_) debugState_ = DebugState::PAUSED;
 }
 
-bool Interpreter::executeOne() {
+template <Interpreter::LoopMode Mode, class IO>
+bool Interpreter::runLoop(IO& io) {
+    const int codeSize = static_cast<int>(code_.size());
+    while (running_ && P_ >= 0 && P_ < codeSize) {
+        // Poll for interruption every INTERRUPT_POLL_INTERVAL instructions
+        if ((instructionCount_ & (INTERRUPT_POLL_INTERVAL - 1)) == 0 && checkInterrupt()) {
+            return false;
+        }
+
+        if constexpr (Mode == LoopMode::DEBUG || Mode == LoopMode::WATCH) {
+            if (breakpointAt_[P_]) {
+                debugState_ = DebugState::PAUSED;
+                *out_ << "Breakpoint hit at line " << code_[P_].line << "\n";
+                return false;
+            }
+            if (trace_ || traceBuffer_) {
+                traceInstruction();
+            }
+            instrument();
+        } else if constexpr (Mode == LoopMode::TRACE) {
+            traceBuffer_->record(P_, code_[P_], B_, T_, H_);
+            instrument();
+        } else if constexpr (Mode == LoopMode::INSTRUMENTED) {
+            instrument();
+        }
+
+        if (!executeOne<Mode == LoopMode::WATCH>(io)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class IO>
+bool Interpreter::executeDebug(IO& io) {
+    return watchpoints_.empty() ? executeOne<false>(io) : executeOne<true>(io);
+}
+
+void Interpreter::instrument() {
+    if (profiler_) {
+        profiler_->record(P_);
+    }
+    if (statsEnabled_) {
+        opcodeCounts_[static_cast<int>(code_[P_].op)]++;
+    }
+}
+
+void Interpreter::traceInstruction() {
     const Instruction& instr = code_[P_];
-        
+    if (traceBuffer_) {
+        traceBuffer_->record(P_, instr, B_, T_, H_);
+    }
     if (trace_) {
-        std::cout << std::setw(4) << P_ << ": "
-                  << "L" << std::setw(3) << instr.line << " "
-                  << std::setw(4) << opCodeToString(instr.op) << " "
-                  << std::setw(2) << instr.L << ", "
-                  << std::setw(4) << instr.A
-                  << "  | B=" << std::setw(4) << B_
-                  << " T=" << std::setw(4) << T_
-                  << " H=" << std::setw(4) << H_ << "\n";
+        TraceRecord rec{P_, static_cast<uint8_t>(instr.op), static_cast<uint8_t>(instr.L), 0, B_, T_, H_, instr.A};
+        TraceBuffer::print(*out_, rec, instr.line);
+    }
+}
+
+void Interpreter::rebuildBreakpointMap() {
+    // Stop where control enters a breakpoint line: its first instruction in a
+    // run of that line, or any jump/call target on it. Continuing inside the
+    // line (or around a loop on it without re-entering) does not stop again.
+    const int codeSize = static_cast<int>(code_.size());
+    breakpointAt_.assign(codeSize, 0);
+    if (breakpoints_.empty()) {
+        breakpointsDirty_ = false;
+        return;
     }
+    for (int pc = 0; pc < codeSize; pc++) {
+        const Instruction& instr = code_[pc];
+        bool lineEntry = pc == 0 || code_[pc - 1].line != instr.line;
+        if (lineEntry && breakpoints_.count(instr.line)) {
+            breakpointAt_[pc] = 1;
+        }
+        bool jumps = instr.op == OpCode::JMP || instr.op == OpCode::JPC || instr.op == OpCode::CAL;
+        if (jumps && instr.A >= 0 && instr.A < codeSize && breakpoints_.count(code_[instr.A].line)) {
+            breakpointAt_[instr.A] = 1;
+        }
+    }
+    breakpointsDirty_ = false;
+}
+
+template <bool Watch, class IO>
+bool Interpreter::executeOne(IO& io) {
+    const Instruction& instr = code_[P_];
     
     P_++;
+    instructionCount_++;
     
     switch (instr.op) {
         case OpCode::LIT:
@@ -113,7 +406,7 @@ bool Interpreter::executeOne() {
         case OpCode::LOD:
             if (instr.A == 0) {
                 // Indirect addressing: pop absolute address from stack top
-                int addr = store_[T_--];
+                Word addr = store_[T_--];
                 if (addr < 0 || addr >= storeSize_) {
                      runtimeError("access violation: invalid address " + std::to_string(addr));
                      return false;
@@ -129,22 +422,29 @@ bool Interpreter::executeOne() {
         case OpCode::STO:
             if (instr.A == 0) {
                 // Indirect addressing: second-top is absolute address, top is value
-                int value = store_[T_--];
-                int addr = store_[T_--];
+                Word value = store_[T_--];
+                Word addr = store_[T_--];
                 if (addr < 0 || addr >= storeSize_) {
                      runtimeError("access violation: invalid address " + std::to_string(addr));
                      return false;
                 }
+                if constexpr (Watch) {
+                    if (isWatched(static_cast<int>(addr))) return watchStore(static_cast<int>(addr), value);
+                }
                 store_[addr] = value;
             } else {
                 // Direct addressing (Stack relative)
+                if constexpr (Watch) {
+                    int addr = base(instr.L, B_) + static_cast<int>(instr.A);
+                    if (isWatched(addr)) return watchStore(addr, store_[T_--]);
+                }
                 store_[base(instr.L, B_) + instr.A] = store_[T_--];
             }
             break;
             
         case OpCode::CAL: {
             // Pop parameter count from stack
-            int paramCount = store_[T_--];
+            int paramCount = static_cast<int>(store_[T_--]);
             // Calculate new base address
             int newBase = T_ - paramCount - 2;
             
@@ -161,6 +461,10 @@ bool Interpreter::executeOne() {
             // Update registers
             B_ = newBase;
             P_ = instr.A;
+            calls_++;
+            if (++callDepth_ > maxCallDepth_) {
+                maxCallDepth_ = callDepth_;
+            }
             break;
         }
             
@@ -189,69 +493,52 @@ bool Interpreter::executeOne() {
             bool isIndirect = (instr.A == 0);
             
             if (isIndirect) {
-                targetAddr = store_[T_--];  // Pop address from stack
-                if (targetAddr < 0 || targetAddr >= storeSize_) {
-                    runtimeError("access violation: invalid address " + std::to_string(targetAddr));
+                Word addr = store_[T_--];  // Pop address from stack
+                if (addr < 0 || addr >= storeSize_) {
+                    runtimeError("access violation: invalid address " + std::to_string(addr));
                     return false;
                 }
+                targetAddr = static_cast<int>(addr);
             } else {
-                targetAddr = base(instr.L, B_) + instr.A;
+                targetAddr = base(instr.L, B_) + static_cast<int>(instr.A);
             }
             
-            // Use input callback if available (GUI mode)
-            if (inputCb_) {
-                int value = inputCb_();
-                if (isIndirect) {
-                    store_[targetAddr] = value;
-                } else {
-                    store_[targetAddr] = value;
-                }
-            } else if (debugMode_ && !waitingForInput_) {
-                // In debug mode without callback, pause for async input from GUI
+            Word value;
+            if (!io.read(value)) {
+                // Debugger without input callback: pause for async input from GUI
                 pendingInputAddress_ = targetAddr;
                 pendingInputIndirect_ = isIndirect;
                 waitingForInput_ = true;
                 debugState_ = DebugState::WAITING_INPUT;
-                P_--;  // Rewind PC to re-execute RED when input is provided
-                return false;  // Pause execution
-            } else {
-                // CLI mode: use std::cin
-                int value;
-                std::cout << "? ";
-                std::cout.flush();
-                if (!(std::cin >> value)) {
-                    std::cin.clear();
-                    std::cin.ignore(10000, '\n');
-                    value = 0;
-                }
+                // The RED has not happened yet: resuming runs it again (CLI),
+                // provideInput() completes it (GUI)
+                P_--;
+                instructionCount_--;
                 if (isIndirect) {
-                    store_[targetAddr] = value;
-                } else {
-                    store_[targetAddr] = value;
+                    T_++;
                 }
+                return false;  // Pause execution
             }
+            inputCount_++;
+            if constexpr (Watch) {
+                if (isWatched(targetAddr)) return watchStore(targetAddr, value);
+            }
+            store_[targetAddr] = value;
             break;
         }
             
-        case OpCode::WRT: {
-            int value = store_[T_--];
-            if (outputCb_) {
-                // Use output callback (GUI mode)
-                outputCb_(value);
-            } else {
-                // CLI mode: use std::cout
-                std::cout << value << std::endl;
-            }
+        case OpCode::WRT:
+            io.write(store_[T_--]);
             break;
-        }
             
         case OpCode::NEW: {
-            int size = store_[T_--];
+            Word size = store_[T_--];
             if (size <= 0) {
                 runtimeError("invalid allocation size");
                 return false;
             }
-            int addr = allocate(size);
+            // Larger than the whole heap can never fit (and may not fit an int)
+            int addr = size < heapSize_ ? allocate(static_cast<int>(size)) : -1;
             if (addr == -1) {
                 runtimeError("out of memory (heap exhausted)");
                 return false;
@@ -261,13 +548,25 @@ bool Interpreter::executeOne() {
         }
             
         case OpCode::DEL: {
-            int addr = store_[T_--];
-            deallocate(addr);
+            Word addr = store_[T_--];
+            if (addr > 0 && addr < storeSize_) {
+                if constexpr (Watch) {
+                    int watched = watchedInBlock(static_cast<int>(addr));
+                    if (watched >= 0) {
+                        Word oldValue = store_[watched];
+                        deallocate(static_cast<int>(addr));
+                        watchTriggered(watched, oldValue, store_[watched], true);
+                        return false;
+                    }
+                }
+                deallocate(static_cast<int>(addr));
+            }
             break;
         }
             
         case OpCode::LAD:
             store_[++T_] = base(instr.L, B_) + instr.A;
+            checkCollision();
             break;
             
         default:
@@ -285,23 +584,554 @@ bool Interpreter::executeOne() {
 
 void Interpreter::setBreakpoint(int line) {
     breakpoints_.insert(line);
+    breakpointsDirty_ = true;
 }
 
 void Interpreter::removeBreakpoint(int line) {
     breakpoints_.erase(line);
+    breakpointsDirty_ = true;
+}
+
+bool Interpreter::addWatchpoint(const std::string& name, int address) {
+    if (address < 0 || address >= storeSize_) return false;
+    if (!isWatched(address)) {
+        watchpoints_.push_back({name, address});
+        rebuildWatchBits();
+    }
+    return true;
+}
+
+void Interpreter::removeWatchpoint(int address) {
+    watchpoints_.erase(std::remove_if(watchpoints_.begin(), watchpoints_.end(),
+                                      [address](const Watchpoint& w) { return w.address == address; }),
+                       watchpoints_.end());
+    rebuildWatchBits();
 }
 
-void Interpreter::provideInput(int value) {
+void Interpreter::rebuildWatchBits() {
+    watchBits_.assign(watchpoints_.empty() ? 0 : static_cast<size_t>(storeSize_ + 63) / 64, 0);
+    for (const Watchpoint& w : watchpoints_) {
+        if (w.address < storeSize_) {
+            watchBits_[static_cast<size_t>(w.address) / 64] |= uint64_t(1) << (w.address % 64);
+        }
+    }
+}
+
+bool Interpreter::watchStore(int address, Word value) {
+    Word oldValue = store_[address];
+    store_[address] = value;
+    if (oldValue == value) return true;
+    watchTriggered(address, oldValue, value, false);
+    return false;
+}
+
+int Interpreter::watchedInBlock(int address) const {
+    // Heap blocks keep their size in the header word before the data
+    int size = static_cast<int>(store_[address - 1]);
+    for (const Watchpoint& w : watchpoints_) {
+        if (w.address >= address && w.address - address < size) {
+            return w.address;
+        }
+    }
+    return -1;
+}
+
+void Interpreter::watchTriggered(int address, Word oldValue, Word newValue, bool freed) {
+    watchHit_ = WatchHit();
+    for (size_t i = 0; i < watchpoints_.size(); i++) {
+        if (watchpoints_[i].address == address) {
+            watchHit_.watchpoint = static_cast<int>(i);
+            break;
+        }
+    }
+    watchHit_.oldValue = oldValue;
+    watchHit_.newValue = newValue;
+    watchHit_.freed = freed;
+    watchHit_.line = P_ > 0 && P_ <= static_cast<int>(code_.size()) ? code_[P_ - 1].line : -1;
+    debugState_ = DebugState::PAUSED;
+    if (!replaying_) {
+        printWatchHit();
+    }
+}
+
+void Interpreter::printWatchHit() const {
+    if (watchHit_.watchpoint < 0) return;
+    const Watchpoint& watch = watchpoints_[watchHit_.watchpoint];
+    *out_ << "Watchpoint " << watch.name << " (address " << watch.address << ") at line " << watchHit_.line << ": ";
+    if (watchHit_.freed) {
+        *out_ << "freed\n";
+    } else {
+        *out_ << watchHit_.oldValue << " -> " << watchHit_.newValue << "\n";
+    }
+}
+
+void Interpreter::provideInput(Word value) {
     if (!waitingForInput_) return;
     
-    // Store the value at the pending address
-    store_[pendingInputAddress_] = value;
+    // Store the value at the pending address and complete the RED
+    int address = pendingInputAddress_;
+    Word oldValue = store_[address];
+    store_[address] = value;
+    if (recordInterval_ && !recorded_.empty() && inputCount_ - inputLogStart_ >= inputLog_.size()) {
+        inputLog_.push_back(value);
+    }
+    inputCount_++;
+    instructionCount_++;
+    P_++;
+    if (pendingInputIndirect_) {
+        T_--;   // Target address
+    }
     
     // Clear waiting state and continue
     waitingForInput_ = false;
     pendingInputAddress_ = 0;
     pendingInputIndirect_ = false;
     debugState_ = DebugState::PAUSED;  // Go to paused state, ready for next step
+    if (isWatched(address) && oldValue != value) {
+        watchTriggered(address, oldValue, value, false);
+    }
+}
+
+ExecutionStats Interpreter::getStats() const {
+    ExecutionStats stats;
+    stats.instructions = instructionCount_;
+    stats.hasOpcodeCounts = statsEnabled_;
+    stats.opcodeCounts = opcodeCounts_;
+    stats.maxStackTop = maxStackTop_;
+    stats.heapSize = storeSize_ - H_;
+    stats.heapHighWater = storeSize_ - lowestHeap_;
+    stats.liveHeap = liveHeap_;
+    stats.liveBlocks = liveBlocks_;
+    stats.maxCallDepth = maxCallDepth_;
+    stats.calls = calls_;
+    stats.wallSeconds = std::chrono::duration<double>(runTime_).count();
+
+    // Walk the free list (bounded in case the program corrupted it)
+    int limit = storeSize_;
+    for (int block = freeListHead_; block >= 0 && block + 1 < storeSize_ && limit-- > 0;
+         block = store_[block + 1]) {
+        int size = store_[block];
+        stats.freeBlocks++;
+        stats.freeWords += size;
+        stats.largestFreeBlock = std::max(stats.largestFreeBlock, size);
+    }
+    if (stats.freeWords > 0) {
+        stats.fragmentation = 1.0 - static_cast<double>(stats.largestFreeBlock) / stats.freeWords;
+    }
+    return stats;
+}
+
+// Snapshots
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'P', 'L', '0', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+// FNV-1a over what execution depends on (line numbers excluded)
+uint64_t hashCode(const std::vector<Instruction>& code) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(code.size());
+    for (const Instruction& instr : code) {
+        mix(static_cast<uint64_t>(instr.op));
+        mix(static_cast<uint64_t>(instr.L));
+        mix(static_cast<uint64_t>(instr.A));
+    }
+    return hash;
+}
+
+// Native-endian fields: a snapshot is resumed on the machine that took it
+template <class T>
+void put(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+bool Interpreter::saveSnapshot(std::ostream& out) const {
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put<uint32_t>(out, SNAPSHOT_VERSION);
+    put<uint32_t>(out, sizeof(Word));
+    put<uint64_t>(out, hashCode(code_));
+
+    put<int32_t>(out, stackSize_);
+    put<int32_t>(out, heapSize_);
+    put<int32_t>(out, P_);
+    put<int32_t>(out, B_);
+    put<int32_t>(out, T_);
+    put<int32_t>(out, H_);
+    put<int32_t>(out, freeListHead_);
+
+    put<uint8_t>(out, waitingForInput_);
+    put<int32_t>(out, pendingInputAddress_);
+    put<uint8_t>(out, pendingInputIndirect_);
+
+    put<uint64_t>(out, instructionCount_);
+    put<uint64_t>(out, inputCount_);
+    put<int32_t>(out, maxStackTop_);
+    put<int32_t>(out, lowestHeap_);
+    put<int32_t>(out, liveHeap_);
+    put<int32_t>(out, liveBlocks_);
+    put<int32_t>(out, callDepth_);
+    put<int32_t>(out, maxCallDepth_);
+    put<uint64_t>(out, calls_);
+    put<int64_t>(out, std::chrono::duration_cast<std::chrono::nanoseconds>(runTime_).count());
+    put<uint64_t>(out, intWriter_ ? intWriter_->getBytesWritten() : 0);
+
+    // Only the live ends of the store: [0, T] and [H, storeSize)
+    out.write(reinterpret_cast<const char*>(&store_[0]), static_cast<std::streamsize>((T_ + 1) * sizeof(Word)));
+    if (H_ < storeSize_) {
+        out.write(reinterpret_cast<const char*>(&store_[H_]),
+                  static_cast<std::streamsize>((storeSize_ - H_) * sizeof(Word)));
+    }
+    return static_cast<bool>(out);
+}
+
+bool Interpreter::loadSnapshot(std::istream& in, std::string& error) {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t version = 0;
+    uint32_t wordSize = 0;
+    uint64_t hash = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        error = "not a PL/0 snapshot";
+        return false;
+    }
+    if (!get(in, version) || version != SNAPSHOT_VERSION) {
+        error = "unsupported snapshot version";
+        return false;
+    }
+    if (!get(in, wordSize) || wordSize != sizeof(Word)) {
+        error = "snapshot was taken with " + std::to_string(wordSize * 8) + "-bit words";
+        return false;
+    }
+    if (!get(in, hash) || hash != hashCode(code_)) {
+        error = "snapshot was taken from a different program";
+        return false;
+    }
+
+    int32_t stackSize = 0, heapSize = 0, p = 0, b = 0, t = 0, h = 0, freeList = 0;
+    uint8_t waiting = 0, indirect = 0;
+    int32_t pendingAddress = 0;
+    uint64_t instructions = 0, inputs = 0, calls = 0;
+    int32_t maxStackTop = 0, lowestHeap = 0, liveHeap = 0, liveBlocks = 0, callDepth = 0, maxCallDepth = 0;
+    int64_t runNanos = 0;
+    uint64_t outputBytes = 0;
+    bool ok = get(in, stackSize) && get(in, heapSize) && get(in, p) && get(in, b) && get(in, t) &&
+              get(in, h) && get(in, freeList) && get(in, waiting) && get(in, pendingAddress) &&
+              get(in, indirect) && get(in, instructions) && get(in, inputs) && get(in, maxStackTop) &&
+              get(in, lowestHeap) && get(in, liveHeap) && get(in, liveBlocks) && get(in, callDepth) &&
+              get(in, maxCallDepth) && get(in, calls) && get(in, runNanos) && get(in, outputBytes);
+    if (!ok) {
+        error = "truncated snapshot";
+        return false;
+    }
+    int64_t storeSize = static_cast<int64_t>(stackSize) + heapSize;
+    if (stackSize <= 0 || heapSize <= 0 || storeSize > INT32_MAX ||
+        p < 0 || p > static_cast<int>(code_.size()) || t < 0 || t >= stackSize ||
+        b < 0 || b > t + 1 || h < stackSize || h > storeSize ||
+        (waiting && (pendingAddress < 0 || pendingAddress >= storeSize))) {
+        error = "corrupt snapshot";
+        return false;
+    }
+
+    // The snapshot's memory layout wins over the configured sizes, but
+    // only once it has loaded: a failed load leaves them for start()
+    int configuredStack = stackSize_;
+    int configuredHeap = heapSize_;
+    stackSize_ = stackSize;
+    heapSize_ = heapSize;
+    storeSize_ = static_cast<int>(storeSize);
+    bool stored = store_.reserve(storeSize_);
+    if (!stored) {
+        error = "cannot reserve " + std::to_string(storeSize_) + " words of memory";
+    } else {
+        stored = static_cast<bool>(in.read(reinterpret_cast<char*>(&store_[0]),
+                                           static_cast<std::streamsize>((t + 1) * sizeof(Word))));
+        if (stored && h < storeSize_) {
+            stored = static_cast<bool>(in.read(reinterpret_cast<char*>(&store_[h]),
+                                               static_cast<std::streamsize>((storeSize_ - h) * sizeof(Word))));
+        }
+        if (!stored) {
+            error = "truncated snapshot";
+        }
+    }
+    if (!stored) {
+        stackSize_ = configuredStack;
+        heapSize_ = configuredHeap;
+        storeSize_ = stackSize_ + heapSize_;
+        return false;
+    }
+    rebuildWatchBits();
+
+    P_ = p;
+    B_ = b;
+    T_ = t;
+    H_ = h;
+    freeListHead_ = freeList;
+    waitingForInput_ = waiting != 0;
+    pendingInputAddress_ = pendingAddress;
+    pendingInputIndirect_ = indirect != 0;
+    instructionCount_ = instructions;
+    inputCount_ = inputs;
+    maxStackTop_ = maxStackTop;
+    lowestHeap_ = lowestHeap;
+    liveHeap_ = liveHeap;
+    liveBlocks_ = liveBlocks;
+    callDepth_ = callDepth;
+    maxCallDepth_ = maxCallDepth;
+    calls_ = calls;
+    runTime_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(runNanos));
+    snapshotOutputBytes_ = outputBytes;
+    opcodeCounts_.fill(0);  // Histogram covers this process only
+
+    nextCheckpoint_ = instructionCount_ + checkpointInterval_;
+    errorMessage_.clear();
+    stopRequested_.store(false, std::memory_order_relaxed);
+    timedOut_ = false;
+    running_ = true;
+    debugState_ = waitingForInput_ ? DebugState::WAITING_INPUT : DebugState::PAUSED;
+    if (recordInterval_) {
+        startRecording();
+    }
+    return true;
+}
+
+void Interpreter::setCheckpointInterval(uint64_t instructions, CheckpointCallback checkpoint) {
+    checkpointInterval_ = checkpoint ? instructions : 0;
+    checkpoint_ = std::move(checkpoint);
+    nextCheckpoint_ = instructionCount_ + checkpointInterval_;
+}
+
+// Record and replay
+
+void Interpreter::setRecording(uint64_t interval, size_t maxCheckpoints) {
+    recordInterval_ = interval;
+    recordLimit_ = std::max<size_t>(maxCheckpoints, 1);
+    recorded_.clear();
+    inputLog_.clear();
+}
+
+Interpreter::VmState Interpreter::saveState() const {
+    VmState state;
+    state.P = P_;
+    state.B = B_;
+    state.T = T_;
+    state.H = H_;
+    state.freeListHead = freeListHead_;
+    state.instructions = instructionCount_;
+    state.inputs = inputCount_;
+    state.calls = calls_;
+    state.maxStackTop = maxStackTop_;
+    state.lowestHeap = lowestHeap_;
+    state.liveHeap = liveHeap_;
+    state.liveBlocks = liveBlocks_;
+    state.callDepth = callDepth_;
+    state.maxCallDepth = maxCallDepth_;
+    return state;
+}
+
+void Interpreter::loadState(const VmState& state) {
+    P_ = state.P;
+    B_ = state.B;
+    T_ = state.T;
+    H_ = state.H;
+    freeListHead_ = state.freeListHead;
+    instructionCount_ = state.instructions;
+    inputCount_ = state.inputs;
+    calls_ = state.calls;
+    maxStackTop_ = state.maxStackTop;
+    lowestHeap_ = state.lowestHeap;
+    liveHeap_ = state.liveHeap;
+    liveBlocks_ = state.liveBlocks;
+    callDepth_ = state.callDepth;
+    maxCallDepth_ = state.maxCallDepth;
+}
+
+void Interpreter::startRecording() {
+    recorded_.clear();
+    inputLog_.clear();
+    inputLogStart_ = inputCount_;
+    replayFrontier_ = instructionCount_;
+    if (!recordMirror_.reserve(storeSize_)) {
+        return;  // Not recording
+    }
+
+    // Everything outside [0, maxStackTop] and [lowestHeap, storeSize) has
+    // never been written and is zero in both stores
+    int stackEnd = std::min(maxStackTop_ + 1, storeSize_);
+    std::copy(&store_[0], &store_[0] + stackEnd, &recordMirror_[0]);
+    if (lowestHeap_ < storeSize_) {
+        int heapBegin = std::max(lowestHeap_, stackEnd);
+        std::copy(&store_[0] + heapBegin, &store_[0] + storeSize_, &recordMirror_[0] + heapBegin);
+    }
+
+    RecordedCheckpoint first;
+    first.state = saveState();
+    recorded_.push_back(std::move(first));
+    nextRecord_ = instructionCount_ + recordInterval_;
+}
+
+void Interpreter::recordCheckpoint() {
+    nextRecord_ = instructionCount_ + recordInterval_;
+    if (recorded_.empty() || instructionCount_ <= recorded_.back().state.instructions) {
+        return;
+    }
+
+    // Keep the old values of the words changed since the previous
+    // checkpoint; the mirror becomes the store of this one
+    RecordedCheckpoint checkpoint;
+    checkpoint.state = saveState();
+    auto diff = [&](int from, int to) {
+        for (int addr = from; addr < to; addr++) {
+            if (store_[addr] == recordMirror_[addr]) continue;
+            int start = addr;
+            for (; addr < to && store_[addr] != recordMirror_[addr]; addr++) {
+                checkpoint.undoWords.push_back(recordMirror_[addr]);
+                recordMirror_[addr] = store_[addr];
+            }
+            checkpoint.undoRuns.emplace_back(start, addr - start);
+        }
+    };
+    int stackEnd = std::min(maxStackTop_ + 1, storeSize_);
+    diff(0, stackEnd);
+    diff(std::max(lowestHeap_, stackEnd), storeSize_);
+    recorded_.push_back(std::move(checkpoint));
+
+    // Past the limit the oldest checkpoint goes; the next one has nothing
+    // left to undo to, and the input before it is never replayed again
+    if (recorded_.size() > recordLimit_) {
+        recorded_.pop_front();
+        RecordedCheckpoint& oldest = recorded_.front();
+        std::vector<std::pair<int, int>>().swap(oldest.undoRuns);
+        std::vector<Word>().swap(oldest.undoWords);
+        uint64_t unused = oldest.state.inputs - inputLogStart_;
+        if (unused > inputLog_.size() / 2) {
+            inputLog_.erase(inputLog_.begin(), inputLog_.begin() + static_cast<std::ptrdiff_t>(unused));
+            inputLogStart_ = oldest.state.inputs;
+        }
+    }
+}
+
+void Interpreter::restoreCheckpoint(size_t index) {
+    // Start from the newest checkpoint's store over every word touched so
+    // far (words first touched after it were zero then) and undo the
+    // checkpoints after index, newest first
+    const VmState& newest = recorded_.back().state;
+    int stackEnd = std::min(std::max(maxStackTop_, newest.maxStackTop) + 1, storeSize_);
+    int heapBegin = std::max(std::min(lowestHeap_, newest.lowestHeap), stackEnd);
+    std::copy(&recordMirror_[0], &recordMirror_[0] + stackEnd, &store_[0]);
+    std::copy(&recordMirror_[0] + heapBegin, &recordMirror_[0] + storeSize_, &store_[0] + heapBegin);
+    for (size_t i = recorded_.size() - 1; i > index; i--) {
+        const Word* words = recorded_[i].undoWords.data();
+        for (const auto& run : recorded_[i].undoRuns) {
+            std::copy(words, words + run.second, &store_[0] + run.first);
+            words += run.second;
+        }
+    }
+
+    loadState(recorded_[index].state);
+    running_ = true;
+    errorMessage_.clear();
+    waitingForInput_ = false;
+    pendingInputAddress_ = 0;
+    pendingInputIndirect_ = false;
+    debugState_ = DebugState::PAUSED;
+}
+
+size_t Interpreter::checkpointBefore(uint64_t instruction) const {
+    auto it = std::upper_bound(recorded_.begin(), recorded_.end(), instruction,
+                               [](uint64_t count, const RecordedCheckpoint& checkpoint) {
+                                   return count < checkpoint.state.instructions;
+                               });
+    return it == recorded_.begin() ? 0 : static_cast<size_t>(it - recorded_.begin()) - 1;
+}
+
+void Interpreter::replayTo(uint64_t target, uint64_t stopsBefore, uint64_t* lastStop, ReplayStop* lastKind) {
+    // Silently, without trace or profiling; breakpoint stops are the
+    // position before an instruction, watchpoint stops the one after it
+    if (breakpointsDirty_) {
+        rebuildBreakpointMap();
+    }
+    const int codeSize = static_cast<int>(code_.size());
+    replaying_ = true;
+    withIO([&](auto& io) {
+        while (running_ && instructionCount_ < target && P_ >= 0 && P_ < codeSize) {
+            if (lastStop && breakpointAt_[P_]) {
+                *lastStop = instructionCount_;
+                *lastKind = ReplayStop::BREAKPOINT;
+            }
+            watchHit_ = WatchHit();
+            debugState_ = DebugState::RUNNING;
+            bool paused = !executeDebug(io);
+            if (watchHit_.watchpoint >= 0) {
+                if (lastStop && instructionCount_ < stopsBefore) {
+                    *lastStop = instructionCount_;
+                    *lastKind = ReplayStop::WATCHPOINT;
+                }
+            } else if (paused) {
+                break;  // Halted, failed or waiting for input
+            }
+        }
+    });
+    replaying_ = false;
+    if (debugState_ == DebugState::RUNNING) {
+        debugState_ = DebugState::PAUSED;
+    }
+}
+
+bool Interpreter::reverseTo(uint64_t instruction) {
+    replayFrontier_ = std::max(replayFrontier_, instructionCount_);
+    restoreCheckpoint(checkpointBefore(instruction));
+    replayTo(instruction, 0, nullptr, nullptr);
+    return true;
+}
+
+bool Interpreter::reverseStep() {
+    if (recorded_.empty() || instructionCount_ <= recorded_.front().state.instructions) {
+        return false;
+    }
+    return reverseTo(instructionCount_ - 1);
+}
+
+bool Interpreter::reverseContinue() {
+    if (recorded_.empty() || instructionCount_ <= recorded_.front().state.instructions) {
+        return false;
+    }
+    uint64_t origin = instructionCount_;
+    replayFrontier_ = std::max(replayFrontier_, origin);
+
+    // Replay the recorded segments newest first until one has a stop
+    for (size_t i = checkpointBefore(origin - 1) + 1; i-- > 0;) {
+        uint64_t end = i + 1 < recorded_.size() ? std::min(recorded_[i + 1].state.instructions, origin) : origin;
+        uint64_t stop = 0;
+        ReplayStop kind = ReplayStop::NONE;
+        restoreCheckpoint(i);
+        replayTo(end, origin, &stop, &kind);
+        if (kind != ReplayStop::NONE) {
+            reverseTo(stop);
+            if (kind == ReplayStop::BREAKPOINT) {
+                *out_ << "Breakpoint hit at line " << getCurrentLine() << "\n";
+            } else {
+                printWatchHit();
+            }
+            return true;
+        }
+    }
+
+    // No stop in the recording: rest at its start
+    restoreCheckpoint(0);
+    return true;
 }
 
 int Interpreter::getCurrentLine() const {
@@ -330,33 +1160,41 @@ std::vector<StackFrame> Interpreter::getCallStack() const {
     return frames;
 }
 
-int Interpreter::getValue(const std::string& varName) const {
-    if (!symTable_) return -999999;
-    
-    // 1. Find symbol definition
-    const auto& symbols = symTable_->getAllSymbols();
-    const Symbol* found = nullptr;
-    
-    for (auto it = symbols.rbegin(); it != symbols.rend(); ++it) {
-        if (it->name == varName && (it->kind == SymbolKind::VARIABLE || it->kind == SymbolKind::POINTER)) {
-            found = &(*it);
-            break;
-        }
-    }
-    
-    if (!found) return -888888; // Not found
-    
-    // 2. Resolve Address
-    // Address = base(L, B) + Offset
-    int addr = B_ + found->address;
+Word Interpreter::getValue(const std::string& varName) const {
+    if (!debugInfo_ || debugInfo_->empty()) return -999999;
+
+    int levelDiff = 0;
+    const DebugInfo::Variable* var = debugInfo_->resolve(P_, varName, levelDiff);
+    if (!var) return -888888; // Not visible here
+    if (var->kind == SymbolKind::CONSTANT) return var->value;
+    if (var->kind != SymbolKind::VARIABLE && var->kind != SymbolKind::POINTER) return -888888;
+
+    int addr = frameAddress(levelDiff, var->offset);
     if (addr >= 0 && addr < storeSize_) {
         return store_[addr];
     }
-    
     return -777777;
 }
 
-int Interpreter::getValueAt(int address) const {
+int Interpreter::getVariableAddress(std::string_view varName) const {
+    if (!debugInfo_) return -1;
+    int levelDiff = 0;
+    const DebugInfo::Variable* var = debugInfo_->resolve(P_, varName, levelDiff);
+    if (!var || var->kind == SymbolKind::CONSTANT) return -1;
+    return frameAddress(levelDiff, var->offset);
+}
+
+int Interpreter::frameAddress(int levelDiff, int offset) const {
+    // base(L, B) + offset, following only static links that stay in the stack
+    int frame = B_;
+    for (; levelDiff > 0; levelDiff--) {
+        if (frame < 0 || frame >= stackSize_) return -1;
+        frame = static_cast<int>(store_[frame]);
+    }
+    return frame + offset;
+}
+
+Word Interpreter::getValueAt(int address) const {
     if (address >= 0 && address < storeSize_) {
         return store_[address];
     }
@@ -370,32 +1208,60 @@ void Interpreter::executeOpr(OprCode opr) {
             // Save old base to check if this is main program returning
             int oldBase = B_;
             T_ = B_ - 1;
-            P_ = store_[B_ + 2]; // RA
-            B_ = store_[B_ + 1]; // DL
+            P_ = static_cast<int>(store_[B_ + 2]); // RA
+            B_ = static_cast<int>(store_[B_ + 1]); // DL
             if (oldBase == 0) {
                 running_ = false;  // Main program returned, end execution
+            } else {
+                callDepth_--;
             }
             break;
         }
             
-        case OprCode::NEG:
-            store_[T_] = -store_[T_];
+        // The overflow builtins cost the same as the wrapping ops; the
+        // checkOverflow_ test is only reached when a result does not fit
+        case OprCode::NEG: {
+            Word result;
+            if (subOverflow(0, store_[T_], &result) && checkOverflow_) {
+                overflowError("-(" + std::to_string(store_[T_]) + ")");
+                break;
+            }
+            store_[T_] = result;
             break;
+        }
             
-        case OprCode::ADD:
+        case OprCode::ADD: {
             T_--;
-            store_[T_] = store_[T_] + store_[T_ + 1];
+            Word result;
+            if (addOverflow(store_[T_], store_[T_ + 1], &result) && checkOverflow_) {
+                overflowError(std::to_string(store_[T_]) + " + " + std::to_string(store_[T_ + 1]));
+                break;
+            }
+            store_[T_] = result;
             break;
+        }
             
-        case OprCode::SUB:
+        case OprCode::SUB: {
             T_--;
-            store_[T_] = store_[T_] - store_[T_ + 1];
+            Word result;
+            if (subOverflow(store_[T_], store_[T_ + 1], &result) && checkOverflow_) {
+                overflowError(std::to_string(store_[T_]) + " - " + std::to_string(store_[T_ + 1]));
+                break;
+            }
+            store_[T_] = result;
             break;
+        }
             
-        case OprCode::MUL:
+        case OprCode::MUL: {
             T_--;
-            store_[T_] = store_[T_] * store_[T_ + 1];
+            Word result;
+            if (mulOverflow(store_[T_], store_[T_ + 1], &result) && checkOverflow_) {
+                overflowError(std::to_string(store_[T_]) + " * " + std::to_string(store_[T_ + 1]));
+                break;
+            }
+            store_[T_] = result;
             break;
+        }
             
         case OprCode::DIV:
             T_--;
@@ -403,7 +1269,11 @@ void Interpreter::executeOpr(OprCode opr) {
                 runtimeError("division by zero");
                 break;
             }
-            store_[T_] = store_[T_] / store_[T_ + 1];
+            if (checkOverflow_ && divOverflow(store_[T_], store_[T_ + 1])) {
+                overflowError(std::to_string(store_[T_]) + " / " + std::to_string(store_[T_ + 1]));
+                break;
+            }
+            store_[T_] = wrapDiv(store_[T_], store_[T_ + 1]);
             break;
             
         case OprCode::ODD:
@@ -416,7 +1286,7 @@ void Interpreter::executeOpr(OprCode opr) {
                 runtimeError("modulo by zero");
                 break;
             }
-            store_[T_] = store_[T_] % store_[T_ + 1];
+            store_[T_] = wrapMod(store_[T_], store_[T_ + 1]);
             break;
             
         case OprCode::EQL:
@@ -451,10 +1321,10 @@ void Interpreter::executeOpr(OprCode opr) {
     }
 }
 
-int Interpreter::base(int L, int B) {
+int Interpreter::base(int L, int B) const {
     int currentBase = B;
     while (L > 0) {
-        currentBase = store_[currentBase];  // Follow static link
+        currentBase = static_cast<int>(store_[currentBase]);  // Follow static link
         L--;
     }
     return currentBase;
@@ -462,17 +1332,62 @@ int Interpreter::base(int L, int B) {
 
 void Interpreter::runtimeError(const std::string& msg) {
     errorMessage_ = msg + " (PC=" + std::to_string(P_ - 1) + ")";
-    std::cerr << Color::Red << "Runtime Error: " << Color::Reset << errorMessage_ << "\n";
+    // Output written so far goes first when both streams end up in one place
+    if (intWriter_) {
+        intWriter_->flush();
+    }
+    out_->flush();
+    *err_ << Color::Red << "Runtime Error: " << Color::Reset << errorMessage_ << "\n";
     running_ = false;
 }
 
+void Interpreter::overflowError(const std::string& expr) {
+    runtimeError("integer overflow: " + expr + " does not fit in " + std::to_string(WORD_BITS) +
+                 " bits at line " + std::to_string(code_[P_ - 1].line));
+}
+
+bool Interpreter::checkInterrupt() {
+    if (checkpointInterval_ && instructionCount_ >= nextCheckpoint_) {
+        nextCheckpoint_ = instructionCount_ + checkpointInterval_;
+        checkpoint_();
+    }
+    if (recordInterval_ && instructionCount_ >= nextRecord_) {
+        recordCheckpoint();
+    }
+    if (traceBuffer_) {
+        traceBuffer_->publish();
+    }
+
+    bool expired = timeLimit_.count() > 0 && std::chrono::steady_clock::now() >= deadline_;
+    if (!expired && !stopRequested_.load(std::memory_order_relaxed)) return false;
+
+    // Report against the instruction about to execute
+    P_++;
+    if (expired) {
+        timedOut_ = true;
+        runtimeError("time limit exceeded (" + std::to_string(timeLimit_.count()) + " ms)");
+    } else {
+        runtimeError("execution interrupted");
+    }
+    P_--;
+    debugState_ = DebugState::HALTED;
+    return true;
+}
+
 void Interpreter::checkCollision() {
-    if (T_ >= H_) {
-        runtimeError("stack overflow (stack/heap collision)");
+    if (T_ > maxStackTop_) {
+        maxStackTop_ = T_;
+    }
+    if (T_ >= stackSize_) {
+        runtimeError("stack overflow (stack size of " + std::to_string(stackSize_) + " words exceeded)");
     }
 }
 
 int Interpreter::allocate(int size) {
+    if (size >= heapSize_) {
+        return -1; // Can never fit (and size + 1 must not overflow)
+    }
+    
     // 1. Search in Free List (First-Fit)
     int prev = -1;
     int curr = freeListHead_;
@@ -503,6 +1418,8 @@ int Interpreter::allocate(int size) {
                 
                 // Setup allocated block header
                 store_[curr] = size;
+                liveHeap_ += size;
+                liveBlocks_++;
                 return curr + 1; // Return pointer to data (skip header)
                 
             } else {
@@ -516,6 +1433,8 @@ int Interpreter::allocate(int size) {
                 }
                 
                 store_[curr] = size; // Header
+                liveHeap_ += size;
+                liveBlocks_++;
                 return curr + 1;
             }
         }
@@ -525,12 +1444,17 @@ int Interpreter::allocate(int size) {
     
     // 2. If not found, Expand Heap (H_)
     // H_ grows down.
-    H_ -= totalSize;
-    if (H_ <= T_) {
-        return -1; // Out of memory
+    if (H_ - totalSize < stackSize_) {
+        return -1; // Out of memory (heap size exhausted)
     }
+    H_ -= totalSize;
     
     store_[H_] = size; // Header
+    liveHeap_ += size;
+    liveBlocks_++;
+    if (H_ < lowestHeap_) {
+        lowestHeap_ = H_;
+    }
     return H_ + 1;
 }
 
@@ -540,6 +1464,8 @@ void Interpreter::deallocate(int address) {
     int blockHeader = address - 1;
     int size = store_[blockHeader]; // User size
     int totalSize = size + 1;
+    liveHeap_ -= size;
+    liveBlocks_--;
     
     // Insert into Free List (Sorted by address to enable coalescing)
     int prev = -1;
@@ -1,43 +1,21 @@
 #include "Lexer.h"
 #include "Diagnostics.h"
+#include "CompilationContext.h"
 #include "Common.h"
 #include <cctype>
 #include <climits>
-#include <unordered_map>
 #include <cstring>
 #include <algorithm>
+#include <charconv>
 
 namespace pl0 {
-const std::unordered_map<std::string, TokenType> Lexer::keywords_ = {
-    {"program", TokenType::KW_PROGRAM},
-    {"const", TokenType::KW_CONST},
-    {"var", TokenType::KW_VAR},
-    {"procedure", TokenType::KW_PROCEDURE},
-    {"begin", TokenType::KW_BEGIN},
-    {"end", TokenType::KW_END},
-    {"if", TokenType::KW_IF},
-    {"then", TokenType::KW_THEN},
-    {"else", TokenType::KW_ELSE},
-    {"while", TokenType::KW_WHILE},
-    {"do", TokenType::KW_DO},
-    {"for", TokenType::KW_FOR},
-    {"to", TokenType::KW_TO},
-    {"downto", TokenType::KW_DOWNTO},
-    {"call", TokenType::KW_CALL},
-    {"read", TokenType::KW_READ},
-    {"write", TokenType::KW_WRITE},
-    {"odd", TokenType::KW_ODD},
-    {"mod", TokenType::KW_MOD},
-    {"new", TokenType::KW_NEW},
-    {"delete", TokenType::KW_DELETE}
-};
-
-Lexer::Lexer(const std::string& source, DiagnosticsEngine& diag)
-    : source_(source), sourcePtr_(0), 
+
+Lexer::Lexer(const std::string& source, DiagnosticsEngine& diag, CompilationContext& context)
+    : source_(context.saveText(source)), sourcePtr_(0), bufferOffset_(0),
       currentBufferIdx_(1), // Start at 1 so first load switches to 0
       hasBuffered_(false),
-      line_(1), column_(1), tokenStartLine_(1), tokenStartColumn_(1),
-      diag_(diag) {
+      line_(1), column_(1), tokenStartLine_(1), tokenStartColumn_(1), tokenStartOffset_(0),
+      diag_(diag), context_(context) {
     
     // Initialize pointers to trigger initial load
     forward_ = buffers_[1] + BUFFER_SIZE;
@@ -51,13 +29,16 @@ Lexer::Lexer(const std::string& source, DiagnosticsEngine& diag)
 }
 
 void Lexer::reset() {
-    sourcePtr_ = 0;
+    seek(0, 1, 1);
+}
+
+void Lexer::seek(size_t offset, int line, int column) {
+    sourcePtr_ = std::min(offset, source_.length());
     currentBufferIdx_ = 1;
     forward_ = buffers_[1] + BUFFER_SIZE;
     lexemeBegin_ = buffers_[1];
-    line_ = 1;
-    column_ = 1;
-    partialLexeme_.clear();
+    line_ = line;
+    column_ = column;
     hasBuffered_ = false;
     
     loadNextBuffer();
@@ -67,20 +48,15 @@ void Lexer::reset() {
 // Double Buffering Logic
 
 void Lexer::loadNextBuffer() {
-    // If there is an active lexeme part in the current buffer, save it
-    if (lexemeBegin_ < forward_) {
-        partialLexeme_.append(lexemeBegin_, forward_);
-    } else if (lexemeBegin_ >= buffers_[currentBufferIdx_] && 
-               lexemeBegin_ < buffers_[currentBufferIdx_] + BUFFER_SIZE) {
-        // Cases where lexemeBegin_ is in the buffer but forward_ is at the end sentinel
-        partialLexeme_.append(lexemeBegin_, forward_);
-    }
+    // A lexeme spanning both buffers needs no saving: lexemes are read back
+    // from source_ by offset
     
     // Switch buffer
     currentBufferIdx_ = 1 - currentBufferIdx_;
     char* buffer = buffers_[currentBufferIdx_];
     
     // Read from source
+    bufferOffset_ = sourcePtr_;
     size_t remaining = source_.length() - sourcePtr_;
     size_t toRead = std::min(remaining, BUFFER_SIZE);
     
@@ -160,17 +136,14 @@ bool Lexer::isAtEnd() const {
 
 void Lexer::markLexemeStart() {
     lexemeBegin_ = forward_;
-    partialLexeme_.clear();
     tokenStartLine_ = line_;
     tokenStartColumn_ = column_;
+    tokenStartOffset_ = bufferOffset_ + (forward_ - buffers_[currentBufferIdx_]);
 }
 
-std::string Lexer::getLexeme() const {
-    std::string s = partialLexeme_;
-    if (forward_ > lexemeBegin_) {
-        s.append(lexemeBegin_, forward_ - lexemeBegin_);
-    }
-    return s;
+std::string_view Lexer::getLexeme() const {
+    size_t end = bufferOffset_ + (forward_ - buffers_[currentBufferIdx_]);
+    return source_.substr(tokenStartOffset_, end - tokenStartOffset_);
 }
 
 // Whitespace and Comments 
@@ -263,24 +236,20 @@ int Lexer::getUtf8CharLen(unsigned char c) const {
     return utf8CharLen(c);
 }
 
-std::string Lexer::readUtf8Char() {
-    std::string result;
-    
+void Lexer::skipUtf8Char() {
     if (isAtEnd()) {
-        return result;
+        return;
     }
     
     unsigned char c = static_cast<unsigned char>(peek());
     int len = getUtf8CharLen(c);
     
     for (int i = 0; i < len && !isAtEnd(); i++) {
-        result += advance();
+        advance();
     }
-    
-    return result;
 }
 
-int Lexer::getUtf8StringLen(const std::string& s) const {
+int Lexer::getUtf8StringLen(std::string_view s) const {
     return utf8StringLen(s);
 }
 
@@ -295,17 +264,21 @@ bool Lexer::isValidPunctStart(char c) const {
 // Token Creation 
 
 Token Lexer::makeToken(TokenType type) {
-    std::string lexeme = getLexeme();
+    std::string_view lexeme = getLexeme();
     int len = getUtf8StringLen(lexeme);
-    return Token(type, lexeme, tokenStartLine_, tokenStartColumn_, len);
+    Token tok(type, lexeme, tokenStartLine_, tokenStartColumn_, len);
+    tok.offset = static_cast<int>(tokenStartOffset_);
+    return tok;
 }
 
-Token Lexer::makeToken(TokenType type, const std::string& literal) {
+Token Lexer::makeToken(TokenType type, std::string_view literal) {
     int len = getUtf8StringLen(literal);
-    return Token(type, literal, tokenStartLine_, tokenStartColumn_, len);
+    Token tok(type, literal, tokenStartLine_, tokenStartColumn_, len);
+    tok.offset = static_cast<int>(tokenStartOffset_);
+    return tok;
 }
 
-Token Lexer::makeToken(TokenType type, int value) {
+Token Lexer::makeToken(TokenType type, Word value) {
     Token tok = makeToken(type);
     tok.value = value;
     return tok;
@@ -324,15 +297,14 @@ Token Lexer::scanIdentifierOrKeyword() {
         advance();
     }
     
-    std::string lexeme = getLexeme();
+    std::string_view lexeme = getLexeme();
     
-    // Check if it's a keyword
-    auto it = keywords_.find(lexeme);
-    if (it != keywords_.end()) {
-        return makeToken(it->second);
+    // Perfect-hash keyword check on the raw bytes; the lexeme doubles as the literal
+    Token tok = makeToken(lookupKeyword(lexeme.data(), lexeme.size()), lexeme);
+    if (tok.type == TokenType::IDENT) {
+        tok.ident = context_.internIdent(lexeme);
     }
-    
-    return makeToken(TokenType::IDENT);
+    return tok;
 }
 
 Token Lexer::scanNumber() {
@@ -342,22 +314,19 @@ Token Lexer::scanNumber() {
         advance();
     }
     
-    std::string lexeme = getLexeme();
-    
-    // Check for overflow
+    // Parsed in place from the source: no string per literal
+    std::string_view lexeme = getLexeme();
     long long value = 0;
-    try {
-        value = std::stoll(lexeme);
-        if (value > INT_MAX) {
-            diag_.error("integer literal overflow", tokenStartLine_, tokenStartColumn_, static_cast<int>(lexeme.size()));
-            value = 0;
-        }
-    } catch (...) {
+    auto [ptr, ec] = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), value);
+    if (ec == std::errc::result_out_of_range || (ec == std::errc() && value > MAX_NUMBER_VALUE)) {
+        diag_.error("integer literal overflow", tokenStartLine_, tokenStartColumn_, static_cast<int>(lexeme.size()));
+        value = 0;
+    } else if (ec != std::errc() || ptr != lexeme.data() + lexeme.size()) {
         diag_.error("invalid integer literal", tokenStartLine_, tokenStartColumn_, static_cast<int>(lexeme.size()));
         value = 0;
     }
     
-    return makeToken(TokenType::NUMBER, static_cast<int>(value));
+    return makeToken(TokenType::NUMBER, static_cast<Word>(value));
 }
 
 Token Lexer::scanOperatorOrDelimiter() {
@@ -416,7 +385,6 @@ Token Lexer::scanOperatorOrDelimiter() {
 Token Lexer::scanUnknown() {
     markLexemeStart();
     
-    std::string unknown;
     int startLine = line_;
     int startCol = column_;
     
@@ -432,13 +400,14 @@ Token Lexer::scanUnknown() {
             break;
         }
         
-        // Read one complete UTF-8 character
-        unknown += readUtf8Char();
+        // Skip one complete UTF-8 character
+        skipUtf8Char();
     }
     
     // Report single error for merged illegal characters
+    std::string_view unknown = getLexeme();
     int charLen = getUtf8StringLen(unknown);
-    diag_.error("illegal character sequence: '" + unknown + "'", startLine, startCol, charLen);
+    diag_.error("illegal character sequence: '" + std::string(unknown) + "'", startLine, startCol, charLen);
     
     return Token(TokenType::UNKNOWN, unknown, startLine, startCol, charLen);
 }
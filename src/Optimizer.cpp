@@ -1,264 +1,228 @@
 #include "Optimizer.h"
-#include <stack>
-#include <iostream>
+#include <bitset>
 
 namespace pl0 {
 
-Optimizer::Optimizer() {}
+namespace {
+
+bool isReturn(const Instruction& instr) {
+    return instr.op == OpCode::OPR && static_cast<OprCode>(instr.A) == OprCode::RET;
+}
+
+// Instructions whose operand is a code address
+bool isCodeReference(const Instruction& instr) {
+    return instr.op == OpCode::JMP || instr.op == OpCode::JPC || instr.op == OpCode::CAL;
+}
+
+} // namespace
+
+Optimizer::Optimizer() : checkOverflow_(false) {}
 
 std::vector<Instruction> Optimizer::optimize(const std::vector<Instruction>& input) {
-    blocks_.clear();
-    addressMap_.clear();
-    std::set<int> targets;
-    
+    std::vector<Instruction> code;
+    if (input.empty()) return code;
+
     // 1. Analysis (Initial partitioning)
-    analyzeJumpTargets(input, targets);
-    buildBasicBlocks(input, targets);
+    findBlocks(input);
+
+    // 2. Optimization (Local): simplified blocks are written to code
+    simplifyBlocks(input, code);
 
-    // 2. Optimization (Local)
-    for (auto& block : blocks_) {
-        constantFolding(block);
-        strengthReduction(block);
-    }
-    
     // 3. Analysis (Post-optimization CFG)
-    buildCFG();
-    markReachable(0);
-    
+    markReachable(code);
+
     // 4. Reconstruction
-    return flattenAndRemap();
+    flattenAndRemap(code);
+    return code;
 }
 
-void Optimizer::analyzeJumpTargets(const std::vector<Instruction>& code, std::set<int>& targets) {
-    for (const auto& instr : code) {
-        if (instr.op == OpCode::JMP || instr.op == OpCode::JPC) {
-            targets.insert(instr.A);
+void Optimizer::findBlocks(const std::vector<Instruction>& code) {
+    size_ = static_cast<int>(code.size());
+    leaders_.assign(static_cast<size_t>(size_ + 63) / 64, 0);
+    setLeader(0);
+
+    // Leaders: jump and call targets, and the instruction after a terminator
+    for (int i = 0; i < size_; i++) {
+        const Instruction& instr = code[i];
+        if (isCodeReference(instr) && instr.A >= 0 && instr.A < size_) {
+            setLeader(static_cast<int>(instr.A));
+        }
+        bool terminator = instr.op == OpCode::JMP || instr.op == OpCode::JPC || isReturn(instr);
+        if (terminator && i + 1 < size_) {
+            setLeader(i + 1);
         }
     }
-}
 
-void Optimizer::buildBasicBlocks(const std::vector<Instruction>& code, const std::set<int>& targets) {
-    if (code.empty()) return;
+    // Blocks are numbered in address order, so the id of a leader is the
+    // number of leaders before it
+    leaderRank_.resize(leaders_.size());
+    int blocks = 0;
+    for (size_t w = 0; w < leaders_.size(); w++) {
+        leaderRank_[w] = blocks;
+        blocks += static_cast<int>(std::bitset<64>(leaders_[w]).count());
+    }
+    blockBegin_.assign(static_cast<size_t>(blocks) + 1, 0);
+}
 
+int Optimizer::blockOfTarget(Word target) const {
+    if (target < 0 || target >= size_ || !isLeader(static_cast<int>(target))) return -1;
+    size_t w = static_cast<size_t>(target) / 64;
+    uint64_t below = leaders_[w] & ((uint64_t(1) << (target % 64)) - 1);
+    return leaderRank_[w] + static_cast<int>(std::bitset<64>(below).count());
+}
 
-    BasicBlock currentBlock;
-    currentBlock.id = 0;
-    currentBlock.originalStartAddr = 0;
-    
-    for (size_t i = 0; i < code.size(); ++i) {
-        // Check if we need to start a new block
-        bool split = false;
-        
-        // 1. Current address is a jump target
-        if (i > 0 && targets.count(static_cast<int>(i))) {
-            split = true;
+void Optimizer::simplifyBlocks(const std::vector<Instruction>& input, std::vector<Instruction>& code) {
+    code.reserve(input.size());
+    int b = 0;
+    int start = 0;
+    for (int i = 0; i < size_; i++) {
+        if (i > 0 && isLeader(i)) {
+            start = static_cast<int>(code.size());
+            blockBegin_[++b] = start;
         }
-        
-        // 2. Previous instruction was a terminator
-        if (i > 0) {
-            OpCode prevOp = code[i-1].op;
-            if (prevOp == OpCode::JMP || prevOp == OpCode::JPC) {
-                split = true;
-            } else if (prevOp == OpCode::OPR && static_cast<OprCode>(code[i-1].A) == OprCode::RET) {
-                split = true;
-            }
+        const Instruction& instr = input[i];
+        code.push_back(instr);
+        // Every rewrite ends at an OPR or a JPC
+        if (instr.op == OpCode::OPR || instr.op == OpCode::JPC) {
+            code.resize(static_cast<size_t>(simplifyTail(code, start, static_cast<int>(code.size()))));
         }
-        
-        if (split) {
-            blocks_.push_back(currentBlock);
-            currentBlock = BasicBlock();
-            currentBlock.id = blocks_.size();
-            currentBlock.originalStartAddr = static_cast<int>(i);
+    }
+    blockBegin_[b + 1] = static_cast<int>(code.size());
+}
+
+// Rewrite the end of block code[start, end) after an OPR or JPC was appended
+// and return the new end. The rest of the block is already simplified, so one
+// pass over a block has the same effect as repeating the rewrites until
+// nothing changes: a fold leaves a LIT last, which no rewrite starts from,
+// and nested constant expressions fold one level per appended OPR.
+int Optimizer::simplifyTail(std::vector<Instruction>& code, int start, int end) {
+    int n = end - start;
+    if (n >= 3 && code[end - 3].op == OpCode::LIT && code[end - 2].op == OpCode::LIT &&
+        code[end - 1].op == OpCode::OPR) {
+        Word result = 0;
+        if (foldConstants(code[end - 3].A, code[end - 2].A, static_cast<OprCode>(code[end - 1].A), result)) {
+            code[end - 3].A = result;
+            return end - 2;
         }
-        
-        currentBlock.instructions.push_back(code[i]);
     }
-    
-    blocks_.push_back(currentBlock);
+    if (n < 2 || code[end - 2].op != OpCode::LIT) return end;
+
+    Word litVal = code[end - 2].A;
+    const Instruction& last = code[end - 1];
+    if (last.op == OpCode::OPR) {
+        OprCode opr = static_cast<OprCode>(last.A);
+        // x + 0, x - 0, x * 1, x / 1 -> x
+        bool identity = (litVal == 0 && (opr == OprCode::ADD || opr == OprCode::SUB)) ||
+                        (litVal == 1 && (opr == OprCode::MUL || opr == OprCode::DIV));
+        return identity ? end - 2 : end;
+    }
+
+    // JPC jumps if Top == 0 (False)
+    if (litVal == 0) {
+        // LIT 0, JPC target -> JMP target
+        code[end - 2] = Instruction(OpCode::JMP, last.L, last.A, last.line);
+        return end - 1;
+    }
+    // LIT 1, JPC target -> Remove (Fallthrough)
+    return end - 2;
 }
 
-void Optimizer::buildCFG() {
-    std::map<int, int> addrToBlock;
-    for (const auto& b : blocks_) {
-        addrToBlock[b.originalStartAddr] = b.id;
+bool Optimizer::foldConstants(Word v1, Word v2, OprCode opr, Word& result) const {
+    bool overflow = false;
+    switch (opr) {
+        case OprCode::ADD: overflow = addOverflow(v1, v2, &result); break;
+        case OprCode::SUB: overflow = subOverflow(v1, v2, &result); break;
+        case OprCode::MUL: overflow = mulOverflow(v1, v2, &result); break;
+        case OprCode::DIV:
+            if (v2 == 0) return false;
+            result = wrapDiv(v1, v2);
+            overflow = divOverflow(v1, v2);
+            break;
+        case OprCode::EQL: result = (v1 == v2); break;
+        case OprCode::NEQ: result = (v1 != v2); break;
+        case OprCode::LSS: result = (v1 < v2); break;
+        case OprCode::GEQ: result = (v1 >= v2); break;
+        case OprCode::GTR: result = (v1 > v2); break;
+        case OprCode::LEQ: result = (v1 <= v2); break;
+        default: return false;
     }
-    
-    for (auto& block : blocks_) {
-        if (block.instructions.empty()) continue;
-        
-        Instruction last = block.instructions.back();
+    return !(overflow && checkOverflow_);
+}
+
+void Optimizer::markReachable(const std::vector<Instruction>& code) {
+    int blockCount = static_cast<int>(blockBegin_.size()) - 1;
+    reachable_.assign(static_cast<size_t>(blockCount), false);
+    worklist_.clear();
+
+    auto visit = [&](int b) {
+        if (b >= 0 && b < blockCount && !reachable_[static_cast<size_t>(b)]) {
+            reachable_[static_cast<size_t>(b)] = true;
+            worklist_.push_back(b);
+        }
+    };
+
+    visit(0);
+    while (!worklist_.empty()) {
+        int b = worklist_.back();
+        worklist_.pop_back();
+
+        // Procedures are only entered through CAL
         bool fallsThrough = true;
-        
-        if (last.op == OpCode::JMP) {
-            fallsThrough = false;
-            if (addrToBlock.count(last.A)) {
-                block.successors.push_back(addrToBlock[last.A]);
+        for (int i = blockBegin_[b]; i < blockBegin_[b + 1]; i++) {
+            const Instruction& instr = code[i];
+            if (isCodeReference(instr)) {
+                visit(blockOfTarget(instr.A));
             }
-        } else if (last.op == OpCode::JPC) {
-            fallsThrough = true;
-            if (addrToBlock.count(last.A)) {
-                block.successors.push_back(addrToBlock[last.A]);
+            if (instr.op == OpCode::JMP || isReturn(instr)) {
+                fallsThrough = false;
             }
-        } else if (last.op == OpCode::OPR && static_cast<OprCode>(last.A) == OprCode::RET) {
-            fallsThrough = false;
         }
-        
         if (fallsThrough) {
-             // Fallthrough to next block in sequence
-             if (block.id + 1 < static_cast<int>(blocks_.size())) {
-                 block.successors.push_back(block.id + 1);
-             }
+            visit(b + 1);
         }
     }
 }
 
-void Optimizer::markReachable(int startBlockId) {
-    if (startBlockId >= static_cast<int>(blocks_.size())) return;
-    
-    std::vector<int> q;
-    q.push_back(startBlockId);
-    blocks_[startBlockId].reachable = true;
-    
-    size_t head = 0;
-    while(head < q.size()){
-        int curr = q[head++];
-        for (int succ : blocks_[curr].successors) {
-            if (succ < static_cast<int>(blocks_.size()) && !blocks_[succ].reachable) {
-                blocks_[succ].reachable = true;
-                q.push_back(succ);
-            }
-        }
-    }
-}
+void Optimizer::flattenAndRemap(std::vector<Instruction>& code) {
+    int blockCount = static_cast<int>(blockBegin_.size()) - 1;
 
-void Optimizer::constantFolding(BasicBlock& block) {
-    std::vector<Instruction>& insts = block.instructions;
-    
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        if (insts.size() < 3) break;
-        
-        std::vector<Instruction> optim;
-        size_t i = 0;
-        while (i < insts.size()) {
-            if (i + 2 < insts.size()) {
-                if (insts[i].op == OpCode::LIT && 
-                    insts[i+1].op == OpCode::LIT && 
-                    insts[i+2].op == OpCode::OPR) {
-                        
-                    int v1 = insts[i].A;
-                    int v2 = insts[i+1].A;
-                    int opr = insts[i+2].A;
-                    int res = 0;
-                    bool valid = true;
-                    
-                    switch(static_cast<OprCode>(opr)) {
-                        case OprCode::ADD: res = v1 + v2; break;
-                        case OprCode::SUB: res = v1 - v2; break;
-                        case OprCode::MUL: res = v1 * v2; break;
-                        case OprCode::DIV: 
-                            if(v2!=0) res = v1 / v2; else valid=false; 
-                            break;
-                        case OprCode::EQL: res = (v1 == v2); break;
-                        case OprCode::NEQ: res = (v1 != v2); break;
-                        case OprCode::LSS: res = (v1 < v2); break;
-                        case OprCode::GEQ: res = (v1 >= v2); break;
-                        case OprCode::GTR: res = (v1 > v2); break;
-                        case OprCode::LEQ: res = (v1 <= v2); break;
-                        default: valid = false;
-                    }
-                    
-                    if (valid) {
-                        optim.push_back(Instruction(OpCode::LIT, 0, res));
-                        i += 3;
-                        changed = true;
-                        continue;
-                    }
-                }
-            }
-            optim.push_back(insts[i]);
-            i++;
+    // Pass 1: Assign new addresses
+    newStart_.resize(static_cast<size_t>(blockCount));
+    int out = 0;
+    for (int b = 0; b < blockCount; b++) {
+        newStart_[b] = out;
+        if (reachable_[static_cast<size_t>(b)]) {
+            out += blockBegin_[b + 1] - blockBegin_[b];
         }
-        insts = optim;
     }
-}
 
-void Optimizer::strengthReduction(BasicBlock& block) {
-    std::vector<Instruction> optim;
-    std::vector<Instruction>& insts = block.instructions;
-    
-    size_t i = 0;
-    while (i < insts.size()) {
-        bool reduced = false;
-        if (i + 1 < insts.size()) {
-            if (insts[i].op == OpCode::LIT && insts[i+1].op == OpCode::OPR) {
-                int litVal = insts[i].A;
-                int opr = insts[i+1].A;
-                
-                // x + 0 -> x
-                if (litVal == 0 && static_cast<OprCode>(opr) == OprCode::ADD) reduced = true;
-                // x - 0 -> x
-                if (litVal == 0 && static_cast<OprCode>(opr) == OprCode::SUB) reduced = true;
-                // x * 1 -> x
-                if (litVal == 1 && static_cast<OprCode>(opr) == OprCode::MUL) reduced = true;
-                // x / 1 -> x
-                if (litVal == 1 && static_cast<OprCode>(opr) == OprCode::DIV) reduced = true; 
-                
-                if (reduced) {
-                    i += 2;
-                    continue;
-                }
-            } else if (insts[i].op == OpCode::LIT && insts[i+1].op == OpCode::JPC) {
-                // JPC jumps if Top == 0 (False)
-                int litVal = insts[i].A;
-                
-                if (litVal == 0) { // False -> Always Jump
-                    // LIT 0, JPC target -> JMP target
-                    optim.push_back(Instruction(OpCode::JMP, insts[i+1].L, insts[i+1].A));
-                    i += 2;
-                    continue;
-                } else { // True -> Never Jump
-                    // LIT 1, JPC target -> Remove (Fallthrough)
-                    i += 2;
-                    continue;
+    // Pass 2: Compact reachable blocks towards the front and remap jump and
+    // call targets (the write position never passes the read position)
+    int end = out;
+    out = 0;
+    for (int b = 0; b < blockCount; b++) {
+        if (!reachable_[static_cast<size_t>(b)]) continue;
+        for (int i = blockBegin_[b]; i < blockBegin_[b + 1]; i++) {
+            Instruction instr = code[i];
+            if (isCodeReference(instr)) {
+                int target = blockOfTarget(instr.A);
+                if (target >= 0) {
+                    instr.A = newStart_[target];
+                } else if (instr.A == size_) {
+                    instr.A = end;
                 }
             }
+            code[out++] = instr;
         }
-        optim.push_back(insts[i]);
-        i++;
     }
-    insts = optim;
+    code.resize(static_cast<size_t>(out));
+    outputSize_ = out;
 }
 
-std::vector<Instruction> Optimizer::flattenAndRemap() {
-    std::vector<Instruction> result;
-    addressMap_.clear();
-    
-    // Pass 1: Assign new addresses
-    int currentAddr = 0;
-    for (const auto& block : blocks_) {
-        if (!block.reachable) continue;
-        
-        addressMap_[block.originalStartAddr] = currentAddr;
-        currentAddr += block.instructions.size();
-    }
-    
-    // Pass 2: Emit and Remap
-    for (const auto& block : blocks_) {
-        if (!block.reachable) continue;
-        
-        for (auto instr : block.instructions) {
-            if (instr.op == OpCode::JMP || instr.op == OpCode::JPC) {
-                if (addressMap_.count(instr.A)) {
-                    instr.A = addressMap_[instr.A];
-                }
-            }
-            result.push_back(instr);
-        }
-    }
-    
-    return result;
+int Optimizer::remapAddress(int address) const {
+    if (address == size_) return outputSize_;
+    int block = blockOfTarget(address);
+    return block >= 0 ? newStart_[block] : -1;
 }
 
 } // namespace pl0
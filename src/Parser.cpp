@@ -1,11 +1,19 @@
 #include "Parser.h"
 #include "Common.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <climits>
+#include <cassert>
 
 namespace pl0 {
 
 Parser::Parser(Lexer& lexer, SymbolTable& symTable, CodeGenerator& codeGen, DiagnosticsEngine& diag)
-    : lexer_(lexer), symTable_(symTable), codeGen_(codeGen), diag_(diag), dumpAst_(false), astIndent_(0) {
+    : lexer_(lexer), symTable_(symTable), codeGen_(codeGen), diag_(diag), dumpAst_(false), astOut_(&std::cout), astIndent_(0),
+      procCache_(nullptr) {
+    // Token identifier ids index the symbol table
+    assert(&lexer.getContext() == &symTable.getContext());
+    
     // Read first token
     advance();
 }
@@ -41,7 +49,7 @@ void Parser::expect(TokenType type, const char* msg) {
 }
 
 
-int Parser::emit(OpCode op, int L, int A) {
+int Parser::emit(OpCode op, int L, Word A) {
     return codeGen_.emit(op, L, A, previousToken_.line);
 }
 
@@ -75,10 +83,20 @@ void Parser::synchronize() {
 
 // AST Debug Output
 
-void Parser::astEnter(const std::string& nodeName) {
+void Parser::astEnter(const char* nodeName) {
     if (dumpAst_) {
-        std::cout << std::string(astIndent_ * 2, ' ') 
-                  << Color::Green << "+ " << nodeName << Color::Reset << "\n";
+        // The line is only assembled as a string when a recording keeps it
+        if (recordings_.empty()) {
+            *astOut_ << std::setw(astIndent_ * 2) << "" << Color::Green << "+ " 
+                     << nodeName << Color::Reset << "\n";
+        } else {
+            std::string line = std::string(astIndent_ * 2, ' ') + Color::Green + "+ " 
+                             + nodeName + Color::Reset + "\n";
+            *astOut_ << line;
+            for (auto& rec : recordings_) {
+                rec.entry.astText += line;
+            }
+        }
         astIndent_++;
     }
 }
@@ -89,9 +107,203 @@ void Parser::astLeave() {
     }
 }
 
+// Incremental Compilation
+//
+// With a ProcedureCache attached, every procedure declaration is either
+// replayed from the cache or recorded into it. Recordings nest like the
+// declarations; anything that escapes a procedure (outer symbol lookups,
+// calls to outer procedures) is noted on every recording it escapes from.
+
+bool Parser::replayCachedProcedure() {
+    Token nameToken = lexer_.peekToken();
+    if (nameToken.type != TokenType::IDENT) {
+        return false;
+    }
+    
+    const CachedProcedure* entry = procCache_->find(nameToken.ident, lexer_.getSource(), 
+                                                    currentToken_.offset, symTable_, 
+                                                    dumpAst_, astIndent_);
+    if (!entry) {
+        return false;
+    }
+    
+    int startLine = currentToken_.line;
+    int codeStart = codeGen_.getNextAddr();
+    
+    // Dependencies of the procedure are dependencies of its enclosing procedures
+    const std::vector<int>& dependencies = procCache_->getDependencyHandles();
+    for (int handle : dependencies) {
+        noteDependency(symTable_.getSymbol(handle));
+    }
+    
+    if (dumpAst_) {
+        *astOut_ << entry->astText;
+        for (auto& rec : recordings_) {
+            rec.entry.astText += entry->astText;
+        }
+    }
+    
+    // The procedure itself lives in the current scope; nested symbols are history only
+    const Symbol& self = entry->symbols[0];
+    int procIdx = symTable_.registerSymbol(nameToken.ident, SymbolKind::PROCEDURE, 0);
+    symTable_.updateSymbolParamCount(procIdx, self.paramCount);
+    for (size_t i = 1; i < entry->symbols.size(); i++) {
+        Symbol sym = entry->symbols[i];
+        if (sym.kind == SymbolKind::PROCEDURE) {
+            sym.address += codeStart;
+        }
+        symTable_.appendHistory(sym);
+    }
+    
+    // Relocate code and relink calls that leave the procedure
+    std::vector<Instruction> code = entry->code;
+    for (auto& instr : code) {
+        if (instr.op == OpCode::JMP || instr.op == OpCode::JPC || instr.op == OpCode::CAL) {
+            instr.A += codeStart;
+        }
+        instr.line += startLine;
+    }
+    for (const auto& call : entry->externalCalls) {
+        Symbol callee = symTable_.getSymbol(dependencies[call.dependency]);
+        code[call.codeIndex].A = callee.address;
+        noteCall(codeStart + call.codeIndex, callee);
+    }
+    for (const auto& instr : code) {
+        codeGen_.emit(instr.op, instr.L, instr.A, instr.line);
+    }
+    
+    symTable_.updateSymbolAddress(procIdx, codeStart + entry->entryOffset);
+    
+    // Continue after the procedure's final 'end'
+    Token last = entry->lastToken;
+    if (last.line == 0) {
+        last.column += currentToken_.column;
+    }
+    last.line += startLine;
+    last.offset += currentToken_.offset;
+    
+    int lastBytes = static_cast<int>(last.literal.size());
+    lexer_.seek(last.offset + lastBytes, last.line, last.column + lastBytes);
+    currentToken_ = last;
+    advance();
+    
+    return true;
+}
+
+void Parser::beginRecording() {
+    ProcRecording rec;
+    rec.offset = currentToken_.offset;
+    rec.startLine = currentToken_.line;
+    rec.startColumn = currentToken_.column;
+    rec.codeStart = codeGen_.getNextAddr();
+    rec.historyStart = symTable_.getHistorySize();
+    rec.diagCount = diag_.getErrorCount() + diag_.getWarningCount();
+    rec.entry.level = symTable_.getCurrentLevel();
+    rec.entry.astIndent = dumpAst_ ? astIndent_ : -1;
+    recordings_.push_back(std::move(rec));
+}
+
+void Parser::finishRecording() {
+    ProcRecording rec = std::move(recordings_.back());
+    recordings_.pop_back();
+    
+    // Only error-free procedures are cached: replay would not re-report diagnostics
+    if (diag_.getErrorCount() + diag_.getWarningCount() != rec.diagCount) {
+        return;
+    }
+    
+    CachedProcedure& entry = rec.entry;
+    const auto& code = codeGen_.getCode();
+    
+    // Source span: 'procedure' through the final 'end' (previous token)
+    const Token& lastToken = previousToken_;
+    size_t endOffset = lastToken.offset + lastToken.literal.size();
+    entry.text = std::string(lexer_.getSource().substr(rec.offset, endOffset - rec.offset));
+    entry.lastToken = lastToken;
+    entry.lastToken.line -= rec.startLine;
+    entry.lastToken.offset -= static_cast<int>(rec.offset);
+    if (entry.lastToken.line == 0) {
+        entry.lastToken.column -= rec.startColumn;
+    }
+    
+    // Symbols declared by the span; [0] is the procedure itself
+    for (int i = rec.historyStart; i < symTable_.getHistorySize(); i++) {
+        entry.symbols.push_back(symTable_.getSymbol(i));
+    }
+    entry.name = std::string(entry.symbols[0].name);
+    entry.entryOffset = entry.symbols[0].address - rec.codeStart;
+    for (auto& sym : entry.symbols) {
+        if (sym.kind == SymbolKind::PROCEDURE) {
+            sym.address -= rec.codeStart;
+        }
+    }
+    
+    // Position independent code
+    entry.code.assign(code.begin() + rec.codeStart, code.end());
+    for (auto& instr : entry.code) {
+        if (instr.op == OpCode::JMP || instr.op == OpCode::JPC || instr.op == OpCode::CAL) {
+            instr.A -= rec.codeStart;
+        }
+        instr.line -= rec.startLine;
+    }
+    // Every callee outside the span was also looked up, so it is a dependency
+    for (const auto& [addr, callee] : rec.externalCalls) {
+        int index = addr - rec.codeStart;
+        entry.code[index].A = code[addr].A;   // Absolute; relinked on replay
+        auto dep = std::find_if(entry.dependencies.begin(), entry.dependencies.end(),
+                                [callee = callee](const SymbolDependency& d) { return d.symbol.historyIndex == callee; });
+        assert(dep != entry.dependencies.end());
+        entry.externalCalls.push_back({index, static_cast<int>(dep - entry.dependencies.begin())});
+    }
+    
+    procCache_->store(std::move(entry));
+}
+
+// Error recovery can leave a token other than an identifier in place of a
+// name; it is declared and looked up by its text, as before ids existed
+int Parser::declareSymbol(const Token& name, SymbolKind kind, int address) {
+    if (name.ident < 0) {
+        return symTable_.registerSymbol(name.literal, kind, address);
+    }
+    return symTable_.registerSymbol(name.ident, kind, address);
+}
+
+int Parser::lookupSymbol(const Token& name) {
+    int idx = name.ident >= 0 ? symTable_.lookup(name.ident) : symTable_.lookup(name.literal);
+    if (idx >= 0 && !recordings_.empty()) {
+        noteDependency(symTable_.getSymbol(idx));
+    }
+    return idx;
+}
+
+void Parser::noteDependency(const Symbol& sym) {
+    for (auto& rec : recordings_) {
+        if (sym.historyIndex >= rec.historyStart) continue;
+        
+        auto& deps = rec.entry.dependencies;
+        bool known = std::any_of(deps.begin(), deps.end(), 
+                                 [&](const SymbolDependency& d) { return d.name == sym.name; });
+        if (!known) {
+            deps.push_back({std::string(sym.name), sym});
+        }
+    }
+}
+
+void Parser::noteCall(int addr, const Symbol& callee) {
+    for (auto& rec : recordings_) {
+        if (callee.historyIndex < rec.historyStart) {
+            rec.externalCalls.emplace_back(addr, callee.historyIndex);
+        }
+    }
+}
+
 // Parse Entry 
 
 bool Parser::parse() {
+    if (procCache_) {
+        procCache_->beginPass();
+    }
+    
     parseProgram();
     
     // Strict check: Error if followed by a period
@@ -101,6 +313,10 @@ bool Parser::parse() {
         diag_.error("expected end of file", currentToken_);
     }
     
+    if (procCache_) {
+        procCache_->endPass();
+    }
+    
     return !diag_.hasErrors();
 }
 
@@ -109,7 +325,6 @@ void Parser::parseProgram() {
     astEnter("Program");
     expect(TokenType::KW_PROGRAM, "expected 'program'");
     expect(TokenType::IDENT, "expected program name");
-    std::string progName = previousToken_.literal;
     expect(TokenType::DL_SEMICOLON, "expected ';'");
     
     // Parse program block (code starts at address 0)
@@ -165,7 +380,7 @@ void Parser::parseBlock(int procIndex) {
     
     // Initialize Arrays (Allocate Heap Memory)
     for (int idx : arrayIndices) {
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         // Desciptor: [Address][Size] at sym.address and sym.address+1
         
         // 1. Allocate Heap Memory
@@ -199,7 +414,7 @@ void Parser::parseConstDecl() {
     
     do {
         expect(TokenType::IDENT, "expected constant name");
-        std::string name = previousToken_.literal;
+        std::string_view name = previousToken_.literal;
         Token nameToken = previousToken_;
         
         expect(TokenType::OP_ASSIGN, "expected ':='");
@@ -213,12 +428,12 @@ void Parser::parseConstDecl() {
         }
         
         expect(TokenType::NUMBER, "expected integer");
-        int value = sign * previousToken_.value;
+        Word value = sign * previousToken_.value;
         
         // Register constant
-        int idx = symTable_.registerSymbol(name, SymbolKind::CONSTANT, 0);
+        int idx = declareSymbol(nameToken, SymbolKind::CONSTANT, 0);
         if (idx < 0) {
-            diag_.error("duplicate identifier: " + name, nameToken);
+            diag_.error("duplicate identifier: " + std::string(name), nameToken);
         } else {
             symTable_.updateSymbolValue(idx, value);
         }
@@ -236,24 +451,24 @@ void Parser::parseVarDecl(int& dataOffset, std::vector<int>& arrayIndices) {
     
     do {
         expect(TokenType::IDENT, "expected variable name");
-        std::string name = previousToken_.literal;
+        std::string_view name = previousToken_.literal;
         Token nameToken = previousToken_;
         
         // Check for Type: var p: pointer; or i: integer;
         if (match(TokenType::DL_COLON)) {
              if (currentToken_.type == TokenType::IDENT && currentToken_.literal == "pointer") {
                  advance(); // consume 'pointer'
-                 int idx = symTable_.registerSymbol(name, SymbolKind::POINTER, dataOffset);
+                 int idx = declareSymbol(nameToken, SymbolKind::POINTER, dataOffset);
                  if (idx < 0) {
-                    diag_.error("duplicate identifier: " + name, nameToken);
+                    diag_.error("duplicate identifier: " + std::string(name), nameToken);
                  }
                  dataOffset++;
              } else if (currentToken_.type == TokenType::IDENT && currentToken_.literal == "integer") {
                  advance(); // consume 'integer'
                  // Integer is default variable type
-                 int idx = symTable_.registerSymbol(name, SymbolKind::VARIABLE, dataOffset);
+                 int idx = declareSymbol(nameToken, SymbolKind::VARIABLE, dataOffset);
                  if (idx < 0) {
-                    diag_.error("duplicate identifier: " + name, nameToken);
+                    diag_.error("duplicate identifier: " + std::string(name), nameToken);
                  }
                  dataOffset++;
              } else {
@@ -263,18 +478,21 @@ void Parser::parseVarDecl(int& dataOffset, std::vector<int>& arrayIndices) {
         else if (match(TokenType::DL_LBRACKET)) {
             // Array declaration: id[size]
             expect(TokenType::NUMBER, "expected array size");
-            int size = previousToken_.value;
+            Word size = previousToken_.value;
             
             if (size <= 0) {
                 diag_.error("array size must be positive", previousToken_);
                 size = 1;
+            } else if (size > INT_MAX) {
+                diag_.error("array size too large", previousToken_);
+                size = 1;
             }
             
             expect(TokenType::DL_RBRACKET, "expected ']'");
             
-            int idx = symTable_.registerSymbol(name, SymbolKind::ARRAY, dataOffset);
+            int idx = declareSymbol(nameToken, SymbolKind::ARRAY, dataOffset);
             if (idx < 0) {
-                diag_.error("duplicate identifier: " + name, nameToken);
+                diag_.error("duplicate identifier: " + std::string(name), nameToken);
             } else {
                 symTable_.updateSymbolSize(idx, size);
                 arrayIndices.push_back(idx);
@@ -284,9 +502,9 @@ void Parser::parseVarDecl(int& dataOffset, std::vector<int>& arrayIndices) {
             dataOffset += 2;
         } else {
             // Simple variable declaration
-            int idx = symTable_.registerSymbol(name, SymbolKind::VARIABLE, dataOffset);
+            int idx = declareSymbol(nameToken, SymbolKind::VARIABLE, dataOffset);
             if (idx < 0) {
-                diag_.error("duplicate identifier: " + name, nameToken);
+                diag_.error("duplicate identifier: " + std::string(name), nameToken);
             }
             dataOffset++;
         }
@@ -299,40 +517,47 @@ void Parser::parseVarDecl(int& dataOffset, std::vector<int>& arrayIndices) {
 }
 
 void Parser::parseProcDecl() {
+    if (procCache_) {
+        if (replayCachedProcedure()) {
+            return;
+        }
+        beginRecording();
+    }
+    
     astEnter("ProcDecl");
     
     advance();  // Consume 'procedure'
     
     expect(TokenType::IDENT, "expected procedure name");
-    std::string name = previousToken_.literal;
+    std::string_view name = previousToken_.literal;
     Token nameToken = previousToken_;
     
     // Register procedure (address will be patched later)
-    int procIdx = symTable_.registerSymbol(name, SymbolKind::PROCEDURE, 0);
+    int procIdx = declareSymbol(nameToken, SymbolKind::PROCEDURE, 0);
     if (procIdx < 0) {
-        diag_.error("duplicate identifier: " + name, nameToken);
-        procIdx = symTable_.getTableSize() - 1;  // Use a dummy index
+        diag_.error("duplicate identifier: " + std::string(name), nameToken);
+        procIdx = symTable_.getHistorySize() - 1;  // Use a dummy index
     }
     
     expect(TokenType::DL_LPAREN, "expected '('");
     
     // Parse parameters - store names for re-registration in block scope
-    std::vector<std::string> paramNames;
+    std::vector<Token> paramTokens;
     std::vector<int> arrayIndices; // For nested procedures' local arrays
     
     if (!check(TokenType::DL_RPAREN)) {
         do {
             expect(TokenType::IDENT, "expected parameter name");
-            paramNames.push_back(previousToken_.literal);
+            paramTokens.push_back(previousToken_);
         } while (match(TokenType::DL_COMMA));
     }
     
-    int paramCount = static_cast<int>(paramNames.size());
+    int paramCount = static_cast<int>(paramTokens.size());
     
     expect(TokenType::DL_RPAREN, "expected ')'");
     
     // Store parameter count
-    if (procIdx >= 0 && procIdx < symTable_.getTableSize()) {
+    if (procIdx >= 0 && procIdx < symTable_.getHistorySize()) {
         symTable_.updateSymbolParamCount(procIdx, paramCount);
     }
     
@@ -347,9 +572,9 @@ void Parser::parseProcDecl() {
     // Register parameters in procedure scope
     // Parameters are stored at offset 3, 4, 5, ... (after SL/DL/RA)
     for (int i = 0; i < paramCount; i++) {
-        int paramIdx = symTable_.registerSymbol(paramNames[i], SymbolKind::VARIABLE, 3 + i);
+        int paramIdx = declareSymbol(paramTokens[i], SymbolKind::VARIABLE, 3 + i);
         if (paramIdx < 0) {
-            diag_.error("duplicate parameter: " + paramNames[i], nameToken);
+            diag_.error("duplicate parameter: " + std::string(paramTokens[i].literal), nameToken);
         }
     }
     
@@ -378,7 +603,7 @@ void Parser::parseProcDecl() {
     }
     
     // Update procedure entry address and backpatch JMP
-    if (procIdx >= 0 && procIdx < symTable_.getTableSize()) {
+    if (procIdx >= 0 && procIdx < symTable_.getHistorySize()) {
         symTable_.updateSymbolAddress(procIdx, codeGen_.getNextAddr());
     }
     codeGen_.backpatch(jmpAddr, codeGen_.getNextAddr());
@@ -388,7 +613,7 @@ void Parser::parseProcDecl() {
 
     // Initialize Arrays (Nested Proc)
     for (int idx : arrayIndices) {
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         emit(OpCode::LIT, 0, sym.size);
         emit(OpCode::NEW, 0, 0); 
         emit(OpCode::STO, 0, sym.address);
@@ -406,6 +631,10 @@ void Parser::parseProcDecl() {
     
     astLeave();
     currentTempOffset_ = oldTemp;
+    
+    if (procCache_) {
+        finishRecording();
+    }
 }
 
 void Parser::parseBody() {
@@ -533,19 +762,19 @@ void Parser::parseForStatement() {
     advance();  // Consume 'for'
     
     expect(TokenType::IDENT, "expected loop variable");
-    std::string varName = previousToken_.literal;
+    std::string_view varName = previousToken_.literal;
     Token varToken = previousToken_;
     
     // Lookup loop variable
-    int varIdx = symTable_.lookup(varName);
+    int varIdx = lookupSymbol(varToken);
     if (varIdx < 0) {
-        diag_.error("undefined identifier: " + varName, varToken);
+        diag_.error("undefined identifier: " + std::string(varName), varToken);
         synchronize();
         astLeave();
         return;
     }
     
-    Symbol& varSym = symTable_.getSymbol(varIdx);
+    Symbol varSym = symTable_.getSymbol(varIdx);
     if (varSym.kind != SymbolKind::VARIABLE) {
         diag_.error("loop variable must be a variable", varToken);
     }
@@ -621,20 +850,20 @@ void Parser::parseCallStatement() {
     advance();  // Consume 'call'
     
     expect(TokenType::IDENT, "expected procedure name");
-    std::string procName = previousToken_.literal;
+    std::string_view procName = previousToken_.literal;
     Token procToken = previousToken_;
     
-    int idx = symTable_.lookup(procName);
+    int idx = lookupSymbol(procToken);
     if (idx < 0) {
-        diag_.error("undefined procedure: " + procName, procToken);
+        diag_.error("undefined procedure: " + std::string(procName), procToken);
         synchronize();
         astLeave();
         return;
     }
     
-    Symbol& procSym = symTable_.getSymbol(idx);
+    Symbol procSym = symTable_.getSymbol(idx);
     if (procSym.kind != SymbolKind::PROCEDURE) {
-        diag_.error("'" + procName + "' is not a procedure", procToken);
+        diag_.error("'" + std::string(procName) + "' is not a procedure", procToken);
         synchronize();
         astLeave();
         return;
@@ -666,7 +895,8 @@ void Parser::parseCallStatement() {
     
     // Generate call instruction
     int levelDiff = symTable_.getCurrentLevel() - procSym.level;
-    emit(OpCode::CAL, levelDiff, procSym.address);
+    int calAddr = emit(OpCode::CAL, levelDiff, procSym.address);
+    noteCall(calAddr, procSym);
     
     astLeave();
 }
@@ -680,22 +910,22 @@ void Parser::parseReadStatement() {
     
     do {
         expect(TokenType::IDENT, "expected variable name");
-        std::string name = previousToken_.literal;
+        std::string_view name = previousToken_.literal;
         Token nameToken = previousToken_;
         
-        int idx = symTable_.lookup(name);
+        int idx = lookupSymbol(nameToken);
         if (idx < 0) {
-            diag_.error("undefined identifier: " + name, nameToken);
+            diag_.error("undefined identifier: " + std::string(name), nameToken);
             continue;
         }
         
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         int levelDiff = symTable_.getCurrentLevel() - sym.level;
         
         // Check for Array Access
         if (check(TokenType::DL_LBRACKET)) {
             if (sym.kind != SymbolKind::ARRAY) {
-                diag_.error("'" + name + "' is not an array", nameToken);
+                diag_.error("'" + std::string(name) + "' is not an array", nameToken);
             }
             
             parseArrayElementAddress(sym);
@@ -704,7 +934,7 @@ void Parser::parseReadStatement() {
             
         } else {
             if (sym.kind != SymbolKind::VARIABLE && sym.kind != SymbolKind::POINTER) {
-                diag_.error("'" + name + "' is not a variable", nameToken);
+                diag_.error("'" + std::string(name) + "' is not a variable", nameToken);
                 continue;
             }
             emit(OpCode::RED, levelDiff, sym.address);
@@ -742,12 +972,12 @@ void Parser::parseNewStatement() {
     expect(TokenType::DL_LPAREN, "expected '('");
     
     expect(TokenType::IDENT, "expected variable name");
-    std::string name = previousToken_.literal;
+    std::string_view name = previousToken_.literal;
     Token nameToken = previousToken_;
     
-    int idx = symTable_.lookup(name);
+    int idx = lookupSymbol(nameToken);
     if (idx < 0) {
-        diag_.error("undefined identifier: " + name, nameToken);
+        diag_.error("undefined identifier: " + std::string(name), nameToken);
     }
     
     expect(TokenType::DL_COMMA, "expected ','");
@@ -762,9 +992,9 @@ void Parser::parseNewStatement() {
     
     // Store allocated address to variable
     if (idx >= 0) {
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         if (sym.kind != SymbolKind::VARIABLE && sym.kind != SymbolKind::POINTER) {
-            diag_.error("'" + name + "' is not a variable or pointer", nameToken);
+            diag_.error("'" + std::string(name) + "' is not a variable or pointer", nameToken);
         } else {
             int levelDiff = symTable_.getCurrentLevel() - sym.level;
             emit(OpCode::STO, levelDiff, sym.address);
@@ -782,21 +1012,21 @@ void Parser::parseDeleteStatement() {
     expect(TokenType::DL_LPAREN, "expected '('");
     
     expect(TokenType::IDENT, "expected variable name");
-    std::string name = previousToken_.literal;
+    std::string_view name = previousToken_.literal;
     Token nameToken = previousToken_;
     
-    int idx = symTable_.lookup(name);
+    int idx = lookupSymbol(nameToken);
     if (idx >= 0) {
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         if (sym.kind != SymbolKind::VARIABLE && sym.kind != SymbolKind::POINTER) {
-            diag_.error("'" + name + "' is not a variable or pointer", nameToken);
+            diag_.error("'" + std::string(name) + "' is not a variable or pointer", nameToken);
         } else {
             int levelDiff = symTable_.getCurrentLevel() - sym.level;
             emit(OpCode::LOD, levelDiff, sym.address);
             emit(OpCode::DEL, 0, 0);
         }
     } else {
-        diag_.error("undefined identifier: " + name, nameToken);
+        diag_.error("undefined identifier: " + std::string(name), nameToken);
     }
     
     expect(TokenType::DL_RPAREN, "expected ')'");
@@ -807,18 +1037,18 @@ void Parser::parseDeleteStatement() {
 void Parser::parseAssignOrArrayAssign() {
     astEnter("AssignStatement");
     
-    std::string name = previousToken_.literal;
+    std::string_view name = previousToken_.literal;
     Token idToken = previousToken_;
     
-    int idx = symTable_.lookup(name);
+    int idx = lookupSymbol(idToken);
     if (idx < 0) {
-        diag_.error("undefined identifier: " + name, idToken);
+        diag_.error("undefined identifier: " + std::string(name), idToken);
         synchronize();
         astLeave();
         return;
     }
     
-    Symbol& sym = symTable_.getSymbol(idx);
+    Symbol sym = symTable_.getSymbol(idx);
     int levelDiff = symTable_.getCurrentLevel() - sym.level;
     
     // Check for Array Access
@@ -853,7 +1083,7 @@ void Parser::parseAssignOrArrayAssign() {
 }
 
 // Helper: Parse Array Element Address (Pushes Absolute Address)
-void Parser::parseArrayElementAddress(Symbol& sym) {
+void Parser::parseArrayElementAddress(const Symbol& sym) {
     if (sym.kind != SymbolKind::ARRAY && sym.kind != SymbolKind::POINTER && sym.kind != SymbolKind::VARIABLE) {
         diag_.error("identifier cannot be indexed", currentToken_);
     }
@@ -1020,15 +1250,15 @@ void Parser::parseFactor() {
     else if (currentToken_.type == TokenType::OP_ADDR) { // '&'
         advance();
         expect(TokenType::IDENT, "expected identifier after '&'");
-        std::string name = previousToken_.literal;
+        std::string_view name = previousToken_.literal;
         Token nameToken = previousToken_;
         
-        int idx = symTable_.lookup(name);
+        int idx = lookupSymbol(nameToken);
         if (idx < 0) {
-            diag_.error("undefined identifier: " + name, nameToken);
+            diag_.error("undefined identifier: " + std::string(name), nameToken);
             astLeave(); return;
         }
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         int levelDiff = symTable_.getCurrentLevel() - sym.level;
         
         if (check(TokenType::DL_LBRACKET)) {
@@ -1050,16 +1280,16 @@ void Parser::parseFactor() {
     }
     // 3. Identifier
     else if (match(TokenType::IDENT)) {
-        std::string name = previousToken_.literal;
+        std::string_view name = previousToken_.literal;
         Token idToken = previousToken_;
         
-        int idx = symTable_.lookup(name);
+        int idx = lookupSymbol(idToken);
         if (idx < 0) {
-            diag_.error("undefined identifier: " + name, idToken);
+            diag_.error("undefined identifier: " + std::string(name), idToken);
             astLeave(); return;
         }
         
-        Symbol& sym = symTable_.getSymbol(idx);
+        Symbol sym = symTable_.getSymbol(idx);
         int levelDiff = symTable_.getCurrentLevel() - sym.level;
         
         if (check(TokenType::DL_LBRACKET)) {
@@ -1074,7 +1304,7 @@ void Parser::parseFactor() {
             } else if (sym.kind == SymbolKind::VARIABLE || sym.kind == SymbolKind::POINTER) {
                 emit(OpCode::LOD, levelDiff, sym.address);
             } else if (sym.kind == SymbolKind::ARRAY) {
-                diag_.error("cannot use array '" + name + "' without subscript", idToken);
+                diag_.error("cannot use array '" + std::string(name) + "' without subscript", idToken);
             } else {
                 diag_.error("invalid identifier type", idToken);
             }
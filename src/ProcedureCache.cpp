@@ -0,0 +1,127 @@
+#include "ProcedureCache.h"
+
+namespace pl0 {
+
+void ProcedureCache::beginPass() {
+    generation_++;
+    hits_ = 0;
+    misses_ = 0;
+}
+
+void ProcedureCache::endPass() {
+    // Entries not reused or recorded by this pass belong to stale source text
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.lastUsed != generation_) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const CachedProcedure* ProcedureCache::find(int ident, std::string_view source, size_t offset,
+                                            const SymbolTable& symTable, bool wantAst, int astIndent) {
+    // A redeclaration in the same scope must go through the parser (error path)
+    if (symTable.lookupCurrentScope(ident) >= 0) {
+        misses_++;
+        return nullptr;
+    }
+
+    auto range = entries_.equal_range(std::string(symTable.getContext().getIdentName(ident)));
+    for (auto it = range.first; it != range.second; ++it) {
+        CachedProcedure& entry = it->second;
+        
+        if (entry.level != symTable.getCurrentLevel()) continue;
+        if (wantAst && entry.astIndent != astIndent) continue;
+        if (offset + entry.text.size() > source.size()) continue;
+        if (source.compare(offset, entry.text.size(), entry.text) != 0) continue;
+        if (!dependenciesHold(entry, symTable)) continue;
+        
+        entry.lastUsed = generation_;
+        hits_++;
+        return &entry;
+    }
+    
+    misses_++;
+    return nullptr;
+}
+
+void ProcedureCache::store(CachedProcedure entry) {
+    entry.lastUsed = generation_;
+    
+    // Replace an entry for the same declaration recorded in another environment
+    auto range = entries_.equal_range(entry.name);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.level == entry.level && it->second.text == entry.text) {
+            it->second = std::move(entry);
+            takeOwnership(it->second);
+            return;
+        }
+    }
+    
+    std::string name = entry.name;
+    auto it = entries_.emplace(std::move(name), std::move(entry));
+    takeOwnership(it->second);
+}
+
+// Entries do not move once they are in the map, so views into ownedText stay valid
+void ProcedureCache::takeOwnership(CachedProcedure& entry) {
+    size_t size = entry.lastToken.literal.size();
+    for (const auto& sym : entry.symbols) {
+        size += sym.name.size();
+    }
+    for (const auto& dep : entry.dependencies) {
+        size += dep.symbol.name.size();
+    }
+    entry.ownedText.clear();
+    entry.ownedText.reserve(size);
+    
+    auto own = [&entry](std::string_view& text) {
+        size_t offset = entry.ownedText.size();
+        entry.ownedText.append(text);
+        text = std::string_view(entry.ownedText).substr(offset, text.size());
+    };
+    own(entry.lastToken.literal);
+    for (auto& sym : entry.symbols) {
+        own(sym.name);
+    }
+    for (auto& dep : entry.dependencies) {
+        own(dep.symbol.name);
+    }
+}
+
+void ProcedureCache::clear() {
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+bool ProcedureCache::sameSymbol(const Symbol& a, const Symbol& b) {
+    if (a.kind != b.kind || a.level != b.level) return false;
+    
+    switch (a.kind) {
+        case SymbolKind::CONSTANT:
+            return a.value == b.value;
+        case SymbolKind::PROCEDURE:
+            // Entry address moves with the code before it; calls are relinked
+            return a.paramCount == b.paramCount;
+        case SymbolKind::ARRAY:
+            return a.address == b.address && a.size == b.size;
+        default:
+            return a.address == b.address;
+    }
+}
+
+bool ProcedureCache::dependenciesHold(const CachedProcedure& entry, const SymbolTable& symTable) {
+    resolved_.clear();
+    for (const auto& dep : entry.dependencies) {
+        int idx = symTable.lookup(dep.name);
+        if (idx < 0 || !sameSymbol(symTable.getSymbol(idx), dep.symbol)) {
+            return false;
+        }
+        resolved_.push_back(idx);
+    }
+    return true;
+}
+
+} // namespace pl0
@@ -0,0 +1,212 @@
+#include "Profiler.h"
+#include "SymbolTable.h"
+#include "SourceManager.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace pl0 {
+
+namespace {
+
+std::string percent(uint64_t count, uint64_t total) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << (total ? 100.0 * static_cast<double>(count) / static_cast<double>(total) : 0.0) << "%";
+    return ss.str();
+}
+
+std::string trim(const std::string& s) {
+    size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+} // namespace
+
+Profiler::Profiler(const std::vector<Instruction>& code)
+    : code_(code), pcCounts_(code.size(), 0), current_(0) {
+    nodes_.push_back({-1, -1, 0, 1});
+}
+
+void Profiler::setSymbolTable(const SymbolTable* symTable) {
+    procNames_.clear();
+    if (!symTable) return;
+    for (const Symbol& sym : symTable->getAllSymbols()) {
+        if (sym.kind == SymbolKind::PROCEDURE) {
+            procNames_.emplace(sym.address, sym.name);
+        }
+    }
+}
+
+void Profiler::enter(int entry) {
+    uint64_t key = (static_cast<uint64_t>(current_) << 32) | static_cast<uint32_t>(entry);
+    auto it = childIndex_.find(key);
+    int node;
+    if (it != childIndex_.end()) {
+        node = it->second;
+    } else {
+        node = static_cast<int>(nodes_.size());
+        nodes_.push_back({entry, current_, 0, 0});
+        childIndex_.emplace(key, node);
+    }
+    nodes_[node].calls++;
+    current_ = node;
+}
+
+void Profiler::leave() {
+    // RET of the main program halts; stay on the root
+    if (nodes_[current_].parent >= 0) {
+        current_ = nodes_[current_].parent;
+    }
+}
+
+uint64_t Profiler::getTotal() const {
+    uint64_t total = 0;
+    for (uint64_t count : pcCounts_) {
+        total += count;
+    }
+    return total;
+}
+
+std::string Profiler::procName(int entry) const {
+    if (entry < 0) return "main";
+    auto it = procNames_.find(entry);
+    return it != procNames_.end() ? it->second : "proc@" + std::to_string(entry);
+}
+
+std::vector<std::vector<int>> Profiler::children() const {
+    std::vector<std::vector<int>> result(nodes_.size());
+    for (size_t i = 1; i < nodes_.size(); i++) {
+        result[nodes_[i].parent].push_back(static_cast<int>(i));
+    }
+    return result;
+}
+
+void Profiler::report(std::ostream& out, const SourceManager* source, int maxRows) const {
+    uint64_t total = getTotal();
+    out << "Profile: " << total << " instructions executed\n";
+
+    // Procedures. Inclusive counts are taken from the outermost activation
+    // on each path so recursion is not counted twice.
+    struct ProcStats {
+        uint64_t calls = 0;
+        uint64_t inclusive = 0;
+        uint64_t exclusive = 0;
+    };
+    std::vector<uint64_t> subtree(nodes_.size(), 0);
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        subtree[i] += nodes_[i].self;
+        if (nodes_[i].parent >= 0) {
+            subtree[nodes_[i].parent] += subtree[i];
+        }
+    }
+
+    std::map<int, ProcStats> procs;
+    std::map<int, int> active;      // entry -> activations on the current path
+    auto tree = children();
+    std::vector<std::pair<int, bool>> stack{{0, false}};   // (node, children pushed)
+    while (!stack.empty()) {
+        auto [node, expanded] = stack.back();
+        const Node& n = nodes_[node];
+        if (expanded) {
+            active[n.entry]--;
+            stack.pop_back();
+            continue;
+        }
+        stack.back().second = true;
+        ProcStats& stats = procs[n.entry];
+        stats.calls += n.calls;
+        stats.exclusive += n.self;
+        if (active[n.entry]++ == 0) {
+            stats.inclusive += subtree[node];
+        }
+        for (int child : tree[node]) {
+            stack.push_back({child, false});
+        }
+    }
+
+    std::vector<std::pair<int, ProcStats>> procRows(procs.begin(), procs.end());
+    std::stable_sort(procRows.begin(), procRows.end(), [](const auto& a, const auto& b) {
+        return a.second.inclusive > b.second.inclusive;
+    });
+
+    out << "\n" << std::left << std::setw(24) << "Procedure" << std::right
+        << std::setw(10) << "calls"
+        << std::setw(14) << "inclusive" << std::setw(8) << "%"
+        << std::setw(14) << "exclusive" << std::setw(8) << "%" << "\n";
+    for (const auto& [entry, stats] : procRows) {
+        out << std::left << std::setw(24) << procName(entry) << std::right
+            << std::setw(10) << stats.calls
+            << std::setw(14) << stats.inclusive << std::setw(8) << percent(stats.inclusive, total)
+            << std::setw(14) << stats.exclusive << std::setw(8) << percent(stats.exclusive, total) << "\n";
+    }
+
+    // Source lines
+    std::map<int, uint64_t> lines;
+    for (size_t pc = 0; pc < pcCounts_.size(); pc++) {
+        if (pcCounts_[pc]) {
+            lines[code_[pc].line] += pcCounts_[pc];
+        }
+    }
+    std::vector<std::pair<int, uint64_t>> lineRows(lines.begin(), lines.end());
+    std::stable_sort(lineRows.begin(), lineRows.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    if (static_cast<int>(lineRows.size()) > maxRows) {
+        lineRows.resize(maxRows);
+    }
+
+    out << "\n" << std::setw(6) << "Line" << std::setw(14) << "count" << std::setw(8) << "%"
+        << "  Source\n";
+    for (const auto& [line, count] : lineRows) {
+        out << std::setw(6) << line << std::setw(14) << count << std::setw(8) << percent(count, total);
+        if (source && line > 0 && line <= source->getLineCount()) {
+            out << "  " << trim(source->getLine(line));
+        }
+        out << "\n";
+    }
+
+    // Opcodes
+    std::map<int, uint64_t> ops;
+    for (size_t pc = 0; pc < pcCounts_.size(); pc++) {
+        if (pcCounts_[pc]) {
+            ops[static_cast<int>(code_[pc].op)] += pcCounts_[pc];
+        }
+    }
+    std::vector<std::pair<int, uint64_t>> opRows(ops.begin(), ops.end());
+    std::stable_sort(opRows.begin(), opRows.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+
+    out << "\n" << std::left << std::setw(6) << "Opcode" << std::right
+        << std::setw(14) << "count" << std::setw(8) << "%" << "\n";
+    for (const auto& [op, count] : opRows) {
+        out << std::left << std::setw(6) << opCodeToString(static_cast<OpCode>(op)) << std::right
+            << std::setw(14) << count << std::setw(8) << percent(count, total) << "\n";
+    }
+}
+
+void Profiler::writeCollapsedStacks(std::ostream& out) const {
+    auto tree = children();
+    std::string path;
+    std::vector<std::pair<int, size_t>> stack{{0, 0}};     // (node, path length before it)
+    while (!stack.empty()) {
+        auto [node, prefix] = stack.back();
+        stack.pop_back();
+        path.resize(prefix);
+        if (prefix) path += ';';
+        path += procName(nodes_[node].entry);
+        if (nodes_[node].self) {
+            out << path << " " << nodes_[node].self << "\n";
+        }
+        size_t length = path.size();
+        for (auto it = tree[node].rbegin(); it != tree[node].rend(); ++it) {
+            stack.push_back({*it, length});
+        }
+    }
+}
+
+} // namespace pl0
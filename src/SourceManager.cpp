@@ -1,4 +1,5 @@
 #include "SourceManager.h"
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -8,14 +9,25 @@ bool SourceManager::loadFile(const std::string& filename) {
     filename_ = filename;
     
     // Read file in binary mode to preserve original bytes
-    std::ifstream file(filename, std::ios::binary);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file) {
         return false;
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    source_ = buffer.str();
+    std::streamoff size = file.tellg();
+    if (size >= 0) {
+        source_.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(source_.data(), size)) {
+            return false;
+        }
+    } else {
+        // Not seekable (pipe): read to the end
+        file.clear();
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        source_ = buffer.str();
+    }
     
     splitLines();
     return true;
@@ -28,30 +40,35 @@ void SourceManager::loadString(const std::string& source, const std::string& fil
 }
 
 void SourceManager::splitLines() {
-    lines_.clear();
+    lineStarts_.clear();
     
-    std::string line;
-    std::istringstream stream(source_);
-    
-    while (std::getline(stream, line)) {
-        // Remove trailing \r if present (Windows line endings)
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+    // A final line without '\n' still counts; a trailing '\n' does not open one
+    size_t start = 0;
+    while (start < source_.size()) {
+        lineStarts_.push_back(start);
+        const void* newline = std::memchr(source_.data() + start, '\n', source_.size() - start);
+        if (!newline) {
+            break;
         }
-        lines_.push_back(line);
-    }
-    
-    // Handle case where source doesn't end with newline
-    if (!source_.empty() && source_.back() != '\n' && lines_.empty()) {
-        lines_.push_back(source_);
+        start = static_cast<size_t>(static_cast<const char*>(newline) - source_.data()) + 1;
     }
 }
 
 std::string SourceManager::getLine(int lineNum) const {
-    if (lineNum < 1 || lineNum > static_cast<int>(lines_.size())) {
+    if (lineNum < 1 || lineNum > static_cast<int>(lineStarts_.size())) {
         return "";
     }
-    return lines_[lineNum - 1];
+    size_t start = lineStarts_[lineNum - 1];
+    size_t end = source_.find('\n', start);
+    if (end == std::string::npos) {
+        end = source_.size();
+    }
+    
+    // Remove trailing \r if present (Windows line endings)
+    if (end > start && source_[end - 1] == '\r') {
+        end--;
+    }
+    return source_.substr(start, end - start);
 }
 
 } // namespace pl0
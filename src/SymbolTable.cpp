@@ -6,15 +6,18 @@
 
 namespace pl0 {
 
-SymbolTable::SymbolTable() : currentLevel_(0) {
-    // Initialize: Level 0 starts at index 0
+SymbolTable::SymbolTable() : SymbolTable(std::make_shared<CompilationContext>()) {}
+
+SymbolTable::SymbolTable(std::shared_ptr<CompilationContext> context)
+    : context_(std::move(context)), currentLevel_(0) {
+    // Initialize: Level 0 starts at log position 0
     scopeStack_.push_back(0);
 }
 
 void SymbolTable::enterScope() {
     currentLevel_++;
-    // Record start index for new scope
-    scopeStack_.push_back(static_cast<int>(symbolStack_.size()));
+    // Record the rollback mark for the new scope
+    scopeStack_.push_back(static_cast<int>(scopeLog_.size()));
 }
 
 void SymbolTable::leaveScope() {
@@ -23,157 +26,138 @@ void SymbolTable::leaveScope() {
         return;
     }
     
-    // Get start index for current scope
-    int scopeStart = scopeStack_.back();
+    // Roll the log back to the scope's mark: each identifier registered in
+    // the scope gets back the symbol it shadowed
+    int mark = scopeStack_.back();
     scopeStack_.pop_back();
-    
-    // Remove all symbols from current level and update hash table
-    while (static_cast<int>(symbolStack_.size()) > scopeStart) {
-        Symbol& sym = symbolStack_.back();
-        
-        // Remove from hash table
-        removeFromHashTable(sym.name, sym.tableIndex);
-        
-        // Pop from symbol stack
-        symbolStack_.pop_back();
+    for (int i = static_cast<int>(scopeLog_.size()) - 1; i >= mark; i--) {
+        int& innermost = innermost_[scopeLog_[i]];
+        innermost = records_[innermost].shadowed;
     }
+    scopeLog_.resize(mark);
     
     currentLevel_--;
 }
 
 // Symbol Operations 
 
-int SymbolTable::registerSymbol(const std::string& name, SymbolKind kind, int address) {
+int SymbolTable::registerSymbol(int ident, SymbolKind kind, int address) {
+    assert(ident >= 0 && ident < context_->getIdentCount());
+    if (ident >= static_cast<int>(innermost_.size())) {
+        innermost_.resize(context_->getIdentCount(), -1);
+    }
+    int& innermost = innermost_[ident];
+    
     // Check for duplicate definition in current scope
-    if (lookupCurrentScope(name) >= 0) {
+    if (innermost >= 0 && records_[innermost].level == currentLevel_) {
         return -1;  // Duplicate definition
     }
     
-    // Create new symbol
-    Symbol sym(name, kind, currentLevel_, address);
-    sym.tableIndex = static_cast<int>(symbolStack_.size());
-    sym.historyIndex = static_cast<int>(allSymbols_.size());
-    
-    // Add to symbol stack
-    symbolStack_.push_back(sym);
-    
-    // Add to complete history (for dump output)
-    allSymbols_.push_back(sym);
+    // New symbol becomes the innermost one and shadows the previous one
+    int handle = static_cast<int>(records_.size());
+    records_.push_back({ident, address, 0, innermost, currentLevel_, kind});
+    innermost = handle;
+    scopeLog_.push_back(ident);
     
-    // Add to hash table
-    addToHashTable(name, sym.tableIndex);
-    
-    return sym.tableIndex;
+    return handle;
 }
 
-int SymbolTable::lookup(const std::string& name) const {
-    // O(1) average complexity lookup
-    auto it = hashTable_.find(name);
-    if (it == hashTable_.end() || it->second.indices.empty()) {
-        return -1;  // Not found
-    }
-    
-    // Return head of list (innermost scope symbol)
-    return it->second.indices.front();
+int SymbolTable::registerSymbol(std::string_view name, SymbolKind kind, int address) {
+    return registerSymbol(context_->internIdent(name), kind, address);
 }
 
-int SymbolTable::lookupCurrentScope(const std::string& name) const {
-    auto it = hashTable_.find(name);
-    if (it == hashTable_.end() || it->second.indices.empty()) {
-        return -1;
-    }
+int SymbolTable::lookup(int ident) const {
+    return ident >= 0 && ident < static_cast<int>(innermost_.size()) ? innermost_[ident] : -1;
+}
+
+int SymbolTable::lookup(std::string_view name) const {
+    return lookup(context_->findIdent(name));
+}
+
+int SymbolTable::lookupCurrentScope(int ident) const {
+    int index = lookup(ident);
     
     // Check if innermost symbol is in current scope
-    int index = it->second.indices.front();
-    if (symbolStack_[index].level == currentLevel_) {
+    if (index >= 0 && records_[index].level == currentLevel_) {
         return index;
     }
     
     return -1;  // Not in current scope
 }
 
-bool SymbolTable::exists(const std::string& name) const {
-    return lookup(name) >= 0;
-}
-
-// Hash Table Operations 
-
-void SymbolTable::addToHashTable(const std::string& name, int index) {
-    // Add new index to front of list (innermost priority)
-    hashTable_[name].indices.push_front(index);
+int SymbolTable::lookupCurrentScope(std::string_view name) const {
+    return lookupCurrentScope(context_->findIdent(name));
 }
 
-void SymbolTable::removeFromHashTable(const std::string& name, int index) {
-    auto it = hashTable_.find(name);
-    if (it == hashTable_.end()) {
-        return;
-    }
-    
-    // Remove specified index from list
-    it->second.indices.remove(index);
-    
-    // Optionally remove empty entry
-    if (it->second.indices.empty()) {
-        hashTable_.erase(it);
-    }
+bool SymbolTable::exists(std::string_view name) const {
+    return lookup(name) >= 0;
 }
 
 // Symbol Access 
 
-Symbol& SymbolTable::getSymbol(int index) {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    return symbolStack_[index];
+Symbol SymbolTable::getSymbol(int index) const {
+    assert(index >= 0 && index < static_cast<int>(records_.size()));
+    const Record& rec = records_[index];
+    Symbol sym(context_->getIdentName(rec.ident), rec.kind, rec.level, rec.address);
+    switch (rec.kind) {
+        case SymbolKind::CONSTANT:  sym.value = rec.value; break;
+        case SymbolKind::ARRAY:     sym.size = static_cast<int>(rec.value); break;
+        case SymbolKind::PROCEDURE: sym.paramCount = static_cast<int>(rec.value); break;
+        default: break;
+    }
+    sym.historyIndex = index;
+    sym.shadowed = rec.shadowed;
+    return sym;
 }
 
-const Symbol& SymbolTable::getSymbol(int index) const {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    return symbolStack_[index];
+std::vector<Symbol> SymbolTable::getAllSymbols() const {
+    std::vector<Symbol> symbols;
+    symbols.reserve(records_.size());
+    for (int i = 0; i < getHistorySize(); i++) {
+        symbols.push_back(getSymbol(i));
+    }
+    return symbols;
 }
 
+// Each update only lands in the field the record keeps for that kind
+
 void SymbolTable::updateSymbolAddress(int index, int address) {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    symbolStack_[index].address = address;
-    
-    // Also update in history for dump output
-    int histIdx = symbolStack_[index].historyIndex;
-    if (histIdx >= 0 && histIdx < static_cast<int>(allSymbols_.size())) {
-        allSymbols_[histIdx].address = address;
-    }
+    assert(index >= 0 && index < static_cast<int>(records_.size()));
+    records_[index].address = address;
 }
 
 void SymbolTable::updateSymbolParamCount(int index, int paramCount) {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    symbolStack_[index].paramCount = paramCount;
-    
-    // Also update in history for dump output
-    int histIdx = symbolStack_[index].historyIndex;
-    if (histIdx >= 0 && histIdx < static_cast<int>(allSymbols_.size())) {
-        allSymbols_[histIdx].paramCount = paramCount;
+    assert(index >= 0 && index < static_cast<int>(records_.size()));
+    if (records_[index].kind == SymbolKind::PROCEDURE) {
+        records_[index].value = paramCount;
     }
 }
 
 void SymbolTable::updateSymbolSize(int index, int size) {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    symbolStack_[index].size = size;
-    
-    // Also update in history for dump output
-    int histIdx = symbolStack_[index].historyIndex;
-    if (histIdx >= 0 && histIdx < static_cast<int>(allSymbols_.size())) {
-        allSymbols_[histIdx].size = size;
+    assert(index >= 0 && index < static_cast<int>(records_.size()));
+    if (records_[index].kind == SymbolKind::ARRAY) {
+        records_[index].value = size;
     }
 }
 
-void SymbolTable::updateSymbolValue(int index, int value) {
-    assert(index >= 0 && index < static_cast<int>(symbolStack_.size()));
-    symbolStack_[index].value = value;
-    
-    // Also update in history for dump output
-    int histIdx = symbolStack_[index].historyIndex;
-    if (histIdx >= 0 && histIdx < static_cast<int>(allSymbols_.size())) {
-        allSymbols_[histIdx].value = value;
+void SymbolTable::updateSymbolValue(int index, Word value) {
+    assert(index >= 0 && index < static_cast<int>(records_.size()));
+    if (records_[index].kind == SymbolKind::CONSTANT) {
+        records_[index].value = value;
     }
 }
 
+void SymbolTable::appendHistory(const Symbol& sym) {
+    Word value = 0;
+    switch (sym.kind) {
+        case SymbolKind::CONSTANT:  value = sym.value; break;
+        case SymbolKind::ARRAY:     value = sym.size; break;
+        case SymbolKind::PROCEDURE: value = sym.paramCount; break;
+        default: break;
+    }
+    records_.push_back({context_->internIdent(sym.name), sym.address, value, -1, sym.level, sym.kind});
+}
+
 // Debug Output 
 
 const char* symbolKindToString(SymbolKind kind) {
@@ -186,69 +170,68 @@ const char* symbolKindToString(SymbolKind kind) {
     }
 }
 
-void SymbolTable::dump() const {
-    std::cout << "\n";
-    std::cout << Color::Cyan << "[Symbol Table]" << Color::Reset 
-              << " Stack + Hash Implementation\n";
-    std::cout << std::string(76, '-') << "\n";
-    std::cout << std::left 
-              << "| " << std::setw(5) << "Index"
-              << "| " << std::setw(15) << "Name"
-              << "| " << std::setw(8) << "Kind"
-              << "| " << std::setw(6) << "Level"
-              << "| " << std::setw(12) << "Addr/Val"
-              << "| " << std::setw(12) << "Size/Params"
-              << "|\n";
-    std::cout << std::string(76, '-') << "\n";
-    
-    // Use allSymbols_ to show complete symbol history
-    for (size_t i = 0; i < allSymbols_.size(); i++) {
-        const Symbol& sym = allSymbols_[i];
-        std::cout << "| " << std::left << std::setw(5) << i;
-        std::cout << "| " << std::setw(15) << sym.name;
-        std::cout << "| " << std::setw(8) << symbolKindToString(sym.kind);
-        std::cout << "| " << std::setw(6) << sym.level;
+void SymbolTable::dump(std::ostream& out) const {
+    out << "\n";
+    out << Color::Cyan << "[Symbol Table]" << Color::Reset 
+        << " Stack + Hash Implementation\n";
+    out << std::string(76, '-') << "\n";
+    out << std::left 
+        << "| " << std::setw(5) << "Index"
+        << "| " << std::setw(15) << "Name"
+        << "| " << std::setw(8) << "Kind"
+        << "| " << std::setw(6) << "Level"
+        << "| " << std::setw(12) << "Addr/Val"
+        << "| " << std::setw(12) << "Size/Params"
+        << "|\n";
+    out << std::string(76, '-') << "\n";
+    
+    // Complete symbol history, including symbols out of scope
+    for (int i = 0; i < getHistorySize(); i++) {
+        Symbol sym = getSymbol(i);
+        out << "| " << std::left << std::setw(5) << i;
+        out << "| " << std::setw(15) << sym.name;
+        out << "| " << std::setw(8) << symbolKindToString(sym.kind);
+        out << "| " << std::setw(6) << sym.level;
         
         switch (sym.kind) {
             case SymbolKind::CONSTANT:
-                std::cout << "| " << std::setw(12) << sym.value
-                          << "| " << std::setw(12) << "-";
+                out << "| " << std::setw(12) << sym.value
+                    << "| " << std::setw(12) << "-";
                 break;
             case SymbolKind::VARIABLE:
-                std::cout << "| " << std::setw(12) << sym.address
-                          << "| " << std::setw(12) << "-";
+                out << "| " << std::setw(12) << sym.address
+                    << "| " << std::setw(12) << "-";
                 break;
             case SymbolKind::ARRAY:
-                std::cout << "| " << std::setw(12) << sym.address
-                          << "| " << std::setw(12) << sym.size;
+                out << "| " << std::setw(12) << sym.address
+                    << "| " << std::setw(12) << sym.size;
                 break;
             case SymbolKind::PROCEDURE:
-                std::cout << "| " << std::setw(12) << sym.address
-                          << "| " << std::setw(12) << sym.paramCount;
+                out << "| " << std::setw(12) << sym.address
+                    << "| " << std::setw(12) << sym.paramCount;
                 break;
         }
-        std::cout << "|\n";
+        out << "|\n";
     }
     
-    std::cout << std::string(76, '-') << "\n";
-    std::cout << "Total symbols: " << allSymbols_.size() << "\n";
+    out << std::string(76, '-') << "\n";
+    out << "Total symbols: " << records_.size() << "\n";
 }
 
-void SymbolTable::dumpHashTable() const {
-    std::cout << "\n" << Color::Cyan << "[Hash Table]" << Color::Reset << " State:\n";
-    std::cout << std::string(50, '-') << "\n";
+void SymbolTable::dumpHashTable(std::ostream& out) const {
+    out << "\n" << Color::Cyan << "[Hash Table]" << Color::Reset << " State:\n";
+    out << std::string(50, '-') << "\n";
     
-    for (const auto& [name, entry] : hashTable_) {
-        std::cout << "  \"" << name << "\" -> [";
-        bool first = true;
-        for (int idx : entry.indices) {
-            if (!first) std::cout << " -> ";
-            std::cout << idx << "(L" << symbolStack_[idx].level << ")";
-            first = false;
+    for (int id = 0; id < static_cast<int>(innermost_.size()); id++) {
+        if (innermost_[id] < 0) continue;
+        out << "  \"" << context_->getIdentName(id) << "\" -> [";
+        for (int idx = innermost_[id]; idx >= 0; idx = records_[idx].shadowed) {
+            if (idx != innermost_[id]) out << " -> ";
+            out << idx << "(L" << records_[idx].level << ")";
         }
-        std::cout << "]\n";
+        out << "]\n";
     }
-    std::cout << std::string(50, '-') << "\n";
+    out << std::string(50, '-') << "\n";
 }
 
 } // namespace pl0
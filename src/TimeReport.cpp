@@ -0,0 +1,118 @@
+#include "TimeReport.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Per thread, so parallel compilation jobs (pl0c -j) do not see each
+// other's allocations and counting needs no atomics
+thread_local uint64_t g_allocCount = 0;
+thread_local uint64_t g_allocBytes = 0;
+
+} // namespace
+
+// Counting replacement of the global allocation function; operator new[]
+// and the nothrow forms forward to it in the standard library
+void* operator new(std::size_t size) {
+    g_allocCount++;
+    g_allocBytes += size;
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace pl0 {
+
+AllocationCounter AllocationCounter::current() {
+    AllocationCounter counter;
+    counter.count = g_allocCount;
+    counter.bytes = g_allocBytes;
+    return counter;
+}
+
+size_t peakRss() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);            // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;     // kilobytes
+#endif
+#endif
+}
+
+void TimeReport::print(std::ostream& out) const {
+    Phase total;
+    total.name = "total";
+    for (const Phase& phase : phases_) {
+        total.seconds += phase.seconds;
+        total.allocations += phase.allocations;
+        total.allocatedBytes += phase.allocatedBytes;
+        total.peakRss = std::max(total.peakRss, phase.peakRss);
+    }
+
+    auto row = [&out](const Phase& phase) {
+        out << std::left << std::setw(14) << phase.name << std::right
+            << std::setw(12) << phase.seconds * 1000.0
+            << std::setw(12) << phase.allocations
+            << std::setw(14) << static_cast<double>(phase.allocatedBytes) / 1024.0
+            << std::setw(14) << static_cast<double>(phase.peakRss) / (1024.0 * 1024.0) << "\n";
+    };
+
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(14) << "Phase" << std::right
+        << std::setw(12) << "Wall ms" << std::setw(12) << "Allocs"
+        << std::setw(14) << "Alloc KB" << std::setw(14) << "Peak RSS MB" << "\n";
+    for (const Phase& phase : phases_) {
+        row(phase);
+    }
+    out << std::string(66, '-') << "\n";
+    row(total);
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+ScopedPhase::ScopedPhase(TimeReport* report, const char* name) : report_(report), name_(name) {
+    if (report_) {
+        allocStart_ = AllocationCounter::current();
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+void ScopedPhase::stop() {
+    if (!report_) return;
+    auto end = std::chrono::steady_clock::now();
+    AllocationCounter allocEnd = AllocationCounter::current();
+
+    TimeReport::Phase phase;
+    phase.name = name_;
+    phase.seconds = std::chrono::duration<double>(end - start_).count();
+    phase.allocations = allocEnd.count - allocStart_.count;
+    phase.allocatedBytes = allocEnd.bytes - allocStart_.bytes;
+    phase.peakRss = peakRss();
+    report_->add(std::move(phase));
+    report_ = nullptr;
+}
+
+} // namespace pl0
@@ -1,7 +1,103 @@
 #include "Token.h"
+#include <cstring>
 
 namespace pl0 {
 
+// Keyword Perfect Hash
+//
+// hash = (s[0] * a + s[1] * b + s[len - 1] + len) mod KEYWORD_SLOTS
+// The multipliers a/b are searched at compile time so that every keyword
+// lands in its own slot; a lookup is then one hash, one length compare
+// and one memcmp, with no std::string construction.
+
+namespace {
+
+constexpr size_t KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr unsigned KEYWORD_SLOTS = 64;  // Power of two
+
+static_assert(KEYWORD_COUNT <= KEYWORD_SLOTS, "keyword table too small");
+
+constexpr size_t constLength(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') n++;
+    return n;
+}
+
+constexpr unsigned keywordHash(const char* s, size_t len, unsigned a, unsigned b) {
+    return (static_cast<unsigned char>(s[0]) * a +
+            static_cast<unsigned char>(s[1]) * b +
+            static_cast<unsigned char>(s[len - 1]) +
+            static_cast<unsigned>(len)) & (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable {
+    unsigned a = 0;
+    unsigned b = 0;
+    size_t minLen = 0;
+    size_t maxLen = 0;
+    signed char slots[KEYWORD_SLOTS] = {};     // Index into KEYWORDS, -1 if empty
+    unsigned char lengths[KEYWORD_COUNT] = {};
+};
+
+constexpr bool tryFill(KeywordTable& table) {
+    for (unsigned i = 0; i < KEYWORD_SLOTS; i++) {
+        table.slots[i] = -1;
+    }
+    for (size_t k = 0; k < KEYWORD_COUNT; k++) {
+        unsigned h = keywordHash(KEYWORDS[k].spelling, table.lengths[k], table.a, table.b);
+        if (table.slots[h] != -1) {
+            return false;   // Collision
+        }
+        table.slots[h] = static_cast<signed char>(k);
+    }
+    return true;
+}
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table;
+    table.minLen = constLength(KEYWORDS[0].spelling);
+    for (size_t k = 0; k < KEYWORD_COUNT; k++) {
+        size_t len = constLength(KEYWORDS[k].spelling);
+        table.lengths[k] = static_cast<unsigned char>(len);
+        if (len < table.minLen) table.minLen = len;
+        if (len > table.maxLen) table.maxLen = len;
+    }
+
+    for (unsigned a = 1; a < KEYWORD_SLOTS; a++) {
+        for (unsigned b = 0; b < KEYWORD_SLOTS; b++) {
+            table.a = a;
+            table.b = b;
+            if (tryFill(table)) {
+                return table;
+            }
+        }
+    }
+
+    table.a = 0;    // No perfect hash found
+    return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+
+static_assert(KEYWORD_TABLE.a != 0, "no perfect hash for KEYWORDS; increase KEYWORD_SLOTS");
+static_assert(KEYWORD_TABLE.minLen >= 2, "keywordHash reads s[1]");
+
+} // namespace
+
+TokenType lookupKeyword(const char* text, size_t len) {
+    if (len < KEYWORD_TABLE.minLen || len > KEYWORD_TABLE.maxLen) {
+        return TokenType::IDENT;
+    }
+
+    int idx = KEYWORD_TABLE.slots[keywordHash(text, len, KEYWORD_TABLE.a, KEYWORD_TABLE.b)];
+    if (idx < 0 || KEYWORD_TABLE.lengths[idx] != len ||
+        std::memcmp(KEYWORDS[idx].spelling, text, len) != 0) {
+        return TokenType::IDENT;
+    }
+
+    return KEYWORDS[idx].type;
+}
+
 const char* tokenTypeToString(TokenType type) {
     switch (type) {
         case TokenType::END_OF_FILE:    return "EOF";
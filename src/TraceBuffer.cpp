@@ -0,0 +1,270 @@
+#include "TraceBuffer.h"
+#include "DebugInfo.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <new>
+#include <ostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PL0_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define PL0_HAVE_MMAP 0
+#endif
+
+namespace pl0 {
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = {'P', 'L', '0', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TRACE_VERSION = 1;
+
+// The ring starts on a cache line
+constexpr size_t RING_ALIGN = 64;
+
+} // namespace
+
+TraceBuffer::~TraceBuffer() {
+    close();
+}
+
+bool TraceBuffer::create(const std::vector<Instruction>& code, const DebugInfo* debugInfo, size_t records,
+                         const std::string& path) {
+    close();
+    error_.clear();
+
+    uint64_t capacity = 1;
+    while (capacity < records) {
+        capacity <<= 1;
+    }
+    bool haveScopes = debugInfo && !debugInfo->empty();
+    size_t procedureCount = haveScopes ? debugInfo->getScopes().size() : 1;
+    size_t tables = sizeof(Header) + code.size() * sizeof(PcInfo) + procedureCount * sizeof(ProcedureName);
+    size_t ringOffset = (tables + RING_ALIGN - 1) / RING_ALIGN * RING_ALIGN;
+    size_t bytes = ringOffset + capacity * sizeof(TraceRecord);
+    if (!allocate(bytes, path)) {
+        return false;
+    }
+
+    // Fresh memory is zeroed: names are NUL padded, the ring is empty
+    Header* header = reinterpret_cast<Header*>(base_);
+    std::memcpy(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header->version = TRACE_VERSION;
+    header->recordSize = sizeof(TraceRecord);
+    header->capacity = capacity;
+    header->total = 0;
+    header->codeSize = static_cast<uint32_t>(code.size());
+    header->procedureCount = static_cast<uint32_t>(procedureCount);
+    header->ringOffset = ringOffset;
+    header->wordBits = static_cast<int32_t>(sizeof(Word) * 8);
+
+    PcInfo* info = reinterpret_cast<PcInfo*>(base_ + sizeof(Header));
+    for (size_t pc = 0; pc < code.size(); pc++) {
+        info[pc].line = code[pc].line;
+        info[pc].procedure = haveScopes ? std::max(debugInfo->scopeAt(static_cast<int>(pc)), 0) : 0;
+    }
+    ProcedureName* names = reinterpret_cast<ProcedureName*>(info + code.size());
+    for (size_t i = 0; i < procedureCount; i++) {
+        const std::string& name = haveScopes ? debugInfo->getScopes()[i].name : std::string("main");
+        std::memcpy(names[i].name, name.data(), std::min(name.size(), MAX_NAME));
+    }
+
+    return bind(bytes);
+}
+
+bool TraceBuffer::allocate(size_t bytes, const std::string& path) {
+#if PL0_HAVE_MMAP
+    if (path.empty()) {
+        void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map != MAP_FAILED) {
+            base_ = static_cast<char*>(map);
+            bytes_ = bytes;
+            mapped_ = true;
+            return true;
+        }
+    } else {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            error_ = "cannot open trace file '" + path + "': " + std::strerror(errno);
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+            void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED) {
+                base_ = static_cast<char*>(map);
+                bytes_ = bytes;
+                mapped_ = true;
+                fd_ = fd;
+                return true;
+            }
+        }
+        ::close(fd);
+        // Not mappable: build the image in memory, close() writes it
+    }
+#endif
+    try {
+        fallback_.assign(bytes, 0);
+    } catch (const std::bad_alloc&) {
+        error_ = "cannot allocate " + std::to_string(bytes) + " bytes for the trace";
+        return false;
+    }
+    base_ = fallback_.data();
+    bytes_ = bytes;
+    path_ = path;
+    return true;
+}
+
+bool TraceBuffer::open(const std::string& path) {
+    close();
+    error_.clear();
+#if PL0_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_ = "cannot open trace file '" + path + "': " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            ::close(fd);
+            base_ = static_cast<char*>(map);
+            bytes_ = size;
+            mapped_ = true;
+            return bind(size);
+        }
+    }
+    ::close(fd);
+#endif
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open trace file '" + path + "'";
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    base_ = fallback_.data();
+    bytes_ = fallback_.size();
+    return bind(bytes_);
+}
+
+bool TraceBuffer::bind(size_t bytes) {
+    const Header* header = reinterpret_cast<const Header*>(base_);
+    if (bytes < sizeof(Header) || std::memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        error_ = "not a PL/0 trace file";
+        close();
+        return false;
+    }
+    uint64_t capacity = header->capacity;
+    uint64_t held = std::min(header->total, capacity);
+    uint64_t tables = sizeof(Header) + uint64_t(header->codeSize) * sizeof(PcInfo)
+                    + uint64_t(header->procedureCount) * sizeof(ProcedureName);
+    if (header->version != TRACE_VERSION || header->recordSize != sizeof(TraceRecord)) {
+        error_ = "unsupported trace file version";
+        close();
+        return false;
+    }
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 || header->procedureCount == 0
+        || tables > header->ringOffset || header->ringOffset % alignof(TraceRecord) != 0
+        || header->ringOffset + held * sizeof(TraceRecord) > bytes) {
+        error_ = "truncated or corrupt trace file";
+        close();
+        return false;
+    }
+
+    header_ = reinterpret_cast<Header*>(base_);
+    pcInfo_ = reinterpret_cast<const PcInfo*>(base_ + sizeof(Header));
+    names_ = reinterpret_cast<const ProcedureName*>(pcInfo_ + header_->codeSize);
+    ring_ = reinterpret_cast<TraceRecord*>(base_ + header_->ringOffset);
+    mask_ = capacity - 1;
+    total_ = header_->total;
+    return true;
+}
+
+bool TraceBuffer::close() {
+    bool ok = true;
+    if (fd_ >= 0 || !path_.empty()) {
+        publish();      // Written files only; opened ones are read-only
+    }
+    if (base_ && !mapped_ && !path_.empty()) {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out.write(base_, static_cast<std::streamsize>(bytes_));
+        if (!out) {
+            error_ = "cannot write trace file '" + path_ + "'";
+            ok = false;
+        }
+    }
+#if PL0_HAVE_MMAP
+    // A ring that never wrapped only needs the slots written
+    size_t used = header_ && total_ < mask_ + 1 ? header_->ringOffset + total_ * sizeof(TraceRecord) : bytes_;
+    if (mapped_) {
+        munmap(base_, bytes_);
+    }
+    if (fd_ >= 0) {
+        if (used < bytes_ && ftruncate(fd_, static_cast<off_t>(used)) != 0) {
+            error_ = std::string("cannot truncate trace file: ") + std::strerror(errno);
+            ok = false;
+        }
+        ::close(fd_);
+    }
+#endif
+    reset();
+    return ok;
+}
+
+void TraceBuffer::reset() {
+    base_ = nullptr;
+    bytes_ = 0;
+    mapped_ = false;
+    fd_ = -1;
+    path_.clear();
+    std::vector<char>().swap(fallback_);
+    header_ = nullptr;
+    pcInfo_ = nullptr;
+    names_ = nullptr;
+    ring_ = nullptr;
+    mask_ = 0;
+    total_ = 0;
+}
+
+int TraceBuffer::lineAt(int pc) const {
+    if (!header_ || pc < 0 || pc >= getCodeSize()) return -1;
+    return pcInfo_[pc].line;
+}
+
+int TraceBuffer::procedureAt(int pc) const {
+    if (!header_ || pc < 0 || pc >= getCodeSize()) return -1;
+    int procedure = pcInfo_[pc].procedure;
+    return procedure >= 0 && procedure < static_cast<int>(header_->procedureCount) ? procedure : -1;
+}
+
+std::vector<std::string_view> TraceBuffer::getProcedures() const {
+    std::vector<std::string_view> procedures;
+    if (header_) {
+        for (uint32_t i = 0; i < header_->procedureCount; i++) {
+            const char* name = names_[i].name;
+            procedures.emplace_back(name, std::find(name, name + MAX_NAME, '\0') - name);
+        }
+    }
+    return procedures;
+}
+
+void TraceBuffer::print(std::ostream& out, const TraceRecord& rec, int line) {
+    out << std::setw(4) << rec.pc << ": "
+        << "L" << std::setw(3) << line << " "
+        << std::setw(4) << opCodeToString(static_cast<OpCode>(rec.op)) << " "
+        << std::setw(2) << static_cast<int>(rec.level) << ", "
+        << std::setw(4) << rec.a
+        << "  | B=" << std::setw(4) << rec.b
+        << " T=" << std::setw(4) << rec.t
+        << " H=" << std::setw(4) << rec.h << "\n";
+}
+
+} // namespace pl0
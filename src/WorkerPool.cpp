@@ -0,0 +1,115 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pl0 {
+
+namespace {
+
+// Per-worker job deque (owner pops front, thieves steal back)
+struct JobQueue {
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+};
+
+bool popFront(JobQueue& queue, size_t& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+bool stealBack(JobQueue& queue, size_t& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+} // namespace
+
+WorkerPool::WorkerPool(int workers) : workers_(workers) {
+    if (workers_ <= 0) {
+        workers_ = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (workers_ <= 0) {
+        workers_ = 1;
+    }
+}
+
+void WorkerPool::run(size_t count,
+                     const std::function<void(size_t)>& job,
+                     const std::function<void(size_t)>& onDone) {
+    if (count == 0) return;
+
+    int n = static_cast<int>(std::min<size_t>(static_cast<size_t>(workers_), count));
+
+    // Deal jobs round-robin so every worker starts with local work
+    std::vector<JobQueue> queues(n);
+    for (size_t i = 0; i < count; i++) {
+        queues[i % n].jobs.push_back(i);
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    std::vector<char> finished(count, 0);
+    std::vector<std::exception_ptr> errors(count);
+
+    auto worker = [&](int self) {
+        size_t idx;
+        while (true) {
+            bool found = popFront(queues[self], idx);
+            for (int k = 1; !found && k < n; k++) {
+                found = stealBack(queues[(self + k) % n], idx);
+            }
+            // No job is ever re-queued, so empty deques mean we are done
+            if (!found) return;
+
+            try {
+                job(idx);
+            } catch (...) {
+                errors[idx] = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                finished[idx] = 1;
+            }
+            doneCv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    for (int w = 0; w < n; w++) {
+        threads.emplace_back(worker, w);
+    }
+
+    // Report completions in index order on the calling thread
+    for (size_t next = 0; next < count; next++) {
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCv.wait(lock, [&] { return finished[next] != 0; });
+        }
+        if (onDone && !errors[next]) {
+            onDone(next);
+        }
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
+
+} // namespace pl0
@@ -1,5 +1,6 @@
 #include "Common.h"
 #include "Token.h"
+#include "CompilationContext.h"
 #include "Lexer.h"
 #include "Parser.h"
 #include "SymbolTable.h"
@@ -8,6 +9,12 @@
 #include "SourceManager.h"
 #include "Diagnostics.h"
 #include "Optimizer.h"
+#include "DebugInfo.h"
+#include "WorkerPool.h"
+#include "IntStream.h"
+#include "Profiler.h"
+#include "TraceBuffer.h"
+#include "TimeReport.h"
 
 #include <iostream>
 #include <iomanip>
@@ -17,6 +24,13 @@
 #include <algorithm>
 #include <chrono>
 #include <sstream>
+#include <cstdlib>
+#include <climits>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -47,7 +61,7 @@ inline const char* col(const char* color) {
 }
 
 struct CompilerOptions {
-    std::string inputFile;
+    std::vector<std::string> inputFiles;
     bool showTokens   = false;
     bool showAst      = false;
     bool showSymbols  = false;
@@ -62,6 +76,38 @@ struct CompilerOptions {
     std::string testDirectory;
     bool optimize     = false;
     bool debug        = false;
+    int jobs          = -1;     // Worker threads (0 = all cores, -1 = default: 1 for files, all cores for --test)
+    int timeoutMs     = 0;      // Execution time limit per program (0 = none)
+    bool checkOverflow = false; // Runtime error on integer overflow instead of wrap-around
+    std::string junitFile;      // --test: write JUnit XML report here
+    int batchIo       = -1;     // Buffered read()/write() without prompts (-1 = auto: stdin and stdout not terminals)
+    std::string inputFile;      // read() from this file instead of stdin
+    std::string outputFile;     // write() to this file instead of stdout
+    pl0::IntFormat ioFormat = pl0::IntFormat::TEXT;  // Encoding of --input-file / --output-file
+    bool profile      = false;  // Print an execution profile after the run
+    std::string profileStacksFile;  // Write collapsed call stacks (flamegraph input) here
+    int stackSize     = pl0::DEFAULT_STACK_SIZE;   // VM memory limits (words)
+    int heapSize      = pl0::DEFAULT_HEAP_SIZE;
+    bool stats        = false;  // Print VM statistics after the run
+    std::string statsJsonFile;  // Write VM statistics as JSON here ("-" = standard output)
+    uint64_t checkpointEvery = 0;   // Snapshot the VM every N instructions (0 = off)
+    std::string checkpointFile;     // Snapshot path (default: <source>.ckpt)
+    std::string traceFile;      // Binary trace of every instruction, for pl0-trace
+    size_t traceRecords = 0;    // Binary trace ring size (0 = default; alone: in memory, print at exit)
+    uint64_t recordEvery = 100000;  // Debugger: reverse checkpoint every N instructions (0 = off)
+    bool timeReport   = false;  // Print per-phase time, allocations and peak RSS
+};
+
+// Per-test execution time limit when --timeout is not given. It is the
+// interpreter's cooperative poll, so it bounds program execution only: a
+// hang while compiling a test (or in the runner) is not caught.
+constexpr int DEFAULT_TEST_TIMEOUT_MS = 10000;
+
+// Console streams of one compilation job; parallel jobs each get private buffers
+struct JobStreams {
+    std::istream& in;
+    std::ostream& out;
+    std::ostream& err;
 };
 
 
@@ -71,6 +117,7 @@ void printHelp(const char* programName) {
     
     std::cout << col(TermColor::Bold) << "USAGE:" << col(TermColor::Reset) << "\n"
               << "    " << programName << " [OPTIONS] <source_file>\n"
+              << "    " << programName << " [OPTIONS] -j <N> <file1> <file2> ...\n"
               << "    " << programName << " --test [directory]\n\n";
     
     std::cout << col(TermColor::Bold) << "DESCRIPTION:" << col(TermColor::Reset) << "\n"
@@ -79,9 +126,16 @@ void printHelp(const char* programName) {
     
     std::cout << col(TermColor::Bold) << "OPTIONS:" << col(TermColor::Reset) << "\n";
     
+    // Options too long for the column get a line of their own
+    constexpr size_t OPT_WIDTH = 20;
     auto printOpt = [](const char* opt, const char* desc) {
-        std::cout << "    " << col(TermColor::Green) << std::left << std::setw(20) << opt 
-                  << col(TermColor::Reset) << desc << "\n";
+        bool wrap = std::strlen(opt) + 2 > OPT_WIDTH;
+        std::cout << "    " << col(TermColor::Green) << std::left << std::setw(wrap ? 0 : OPT_WIDTH) << opt 
+                  << col(TermColor::Reset);
+        if (wrap) {
+            std::cout << "\n" << std::string(4 + OPT_WIDTH, ' ');
+        }
+        std::cout << desc << "\n";
     };
     
     printOpt("-h, --help", "Display this help message and exit");
@@ -92,11 +146,33 @@ void printHelp(const char* programName) {
     printOpt("--code", "Print generated P-Code instructions");
     printOpt("--all", "Enable all debug outputs (tokens, ast, sym, code)");
     printOpt("--trace", "Trace P-Code execution step by step");
+    printOpt("--trace-file <f>", "Write a binary trace of the run to <f> (decode with pl0-trace)");
+    printOpt("--trace-records <N>", "Keep the last N instructions of the binary trace; alone: print them at exit");
     printOpt("--no-run", "Compile only, do not execute");
     printOpt("--no-color", "Disable colored output");
     printOpt("--test [dir]", "Run batch tests on directory (default: test/)");
     printOpt("-O, --optimize", "Enable optimizations (Const Folding, Dead Code)");
     printOpt("-d, --debug", "Enable interactive debug mode");
+    printOpt("-j, --jobs <N>", "Compile files / run tests on N worker threads (0 = all cores)");
+    printOpt("--timeout <ms>", "Abort program execution after <ms> milliseconds");
+    printOpt("--check-overflow", "Stop with a runtime error on integer overflow");
+    printOpt("--stack-size <N>", "Stack limit in words (default: 1048576)");
+    printOpt("--heap-size <N>", "Heap limit in words (default: 16777216)");
+    printOpt("--junit <file>", "With --test: write a JUnit XML report to <file>");
+    printOpt("--batch-io", "Buffered read/write without prompts (default when piped)");
+    printOpt("--no-batch-io", "Always use prompting console read/write");
+    printOpt("--input-file <f>", "read() integers from file <f> (memory-mapped)");
+    printOpt("--output-file <f>", "write() integers to file <f> (memory-mapped)");
+    std::string binaryWord = "Data file format: text (default) or binary (int" + std::to_string(pl0::WORD_BITS) + ")";
+    printOpt("--io-format <fmt>", binaryWord.c_str());
+    printOpt("--profile", "Report instruction counts per procedure, line and opcode");
+    printOpt("--profile-stacks <f>", "Write collapsed call stacks to <f> (flamegraph input)");
+    printOpt("--checkpoint-every <N>", "Snapshot the VM every N instructions; resume from it on restart");
+    printOpt("--checkpoint <f>", "Snapshot file for --checkpoint-every (default: <source>.ckpt)");
+    printOpt("--record-every <N>", "Debug mode: record every N instructions for rs/rc (0 = off)");
+    printOpt("--stats", "Print VM statistics (instructions, stack, heap, calls, time)");
+    printOpt("--stats-json <f>", "Write VM statistics as one JSON line to <f> (- = stdout)");
+    printOpt("--time-report", "Print time, allocations and peak RSS per compiler phase");
     
     std::cout << "\n" << col(TermColor::Bold) << "FILE RESOLUTION:" << col(TermColor::Reset) << "\n"
               << "    The compiler intelligently searches for source files:\n"
@@ -112,10 +188,14 @@ void printHelp(const char* programName) {
               << col(TermColor::Reset) << "          # Show P-Code for test_heap.pl0\n"
               << "    " << col(TermColor::Cyan) << programName << " --all program.pl0" 
               << col(TermColor::Reset) << "         # Full debug output\n"
+              << "    " << col(TermColor::Cyan) << programName << " -j 8 a.pl0 b.pl0 c.pl0" 
+              << col(TermColor::Reset) << "     # Parallel batch, output in argument order\n"
               << "    " << col(TermColor::Cyan) << programName << " --test" 
               << col(TermColor::Reset) << "                     # Run all tests\n"
               << "    " << col(TermColor::Cyan) << programName << " --test test/parser" 
-              << col(TermColor::Reset) << "         # Test parser module only\n\n";
+              << col(TermColor::Reset) << "         # Test parser module only\n"
+              << "    " << col(TermColor::Cyan) << programName << " --test -j 4 --junit report.xml" 
+              << col(TermColor::Reset) << " # Parallel tests, CI report\n\n";
     
     std::cout << col(TermColor::Bold) << "TEST DIRECTORY STRUCTURE:" << col(TermColor::Reset) << "\n"
               << "    test/\n"
@@ -218,29 +298,107 @@ public:
     }
 };
 
-void printTokens(const std::vector<pl0::Token>& tokens) {
-    std::cout << "\n" << col(TermColor::BoldCyan) << "[Lexer]" << col(TermColor::Reset)
-              << " Token Sequence:\n";
-    std::cout << std::string(76, '-') << "\n";
-    std::cout << col(TermColor::Bold)
-              << "| " << std::left << std::setw(6) << "Line"
-              << "| " << std::setw(6) << "Col"
-              << "| " << std::setw(15) << "Type"
-              << "| " << std::setw(40) << "Value"
-              << "|\n" << col(TermColor::Reset);
-    std::cout << std::string(76, '-') << "\n";
+void printTokens(const std::vector<pl0::Token>& tokens, std::ostream& out) {
+    out << "\n" << col(TermColor::BoldCyan) << "[Lexer]" << col(TermColor::Reset)
+        << " Token Sequence:\n";
+    out << std::string(76, '-') << "\n";
+    out << col(TermColor::Bold)
+        << "| " << std::left << std::setw(6) << "Line"
+        << "| " << std::setw(6) << "Col"
+        << "| " << std::setw(15) << "Type"
+        << "| " << std::setw(40) << "Value"
+        << "|\n" << col(TermColor::Reset);
+    out << std::string(76, '-') << "\n";
     
     for (const auto& tok : tokens) {
-        std::cout << "| " << std::left << std::setw(6) << tok.line
-                  << "| " << std::setw(6) << tok.column
-                  << "| " << std::setw(15) << pl0::tokenTypeToString(tok.type)
-                  << "| " << std::setw(40) << tok.literal
-                  << "|\n";
+        out << "| " << std::left << std::setw(6) << tok.line
+            << "| " << std::setw(6) << tok.column
+            << "| " << std::setw(15) << pl0::tokenTypeToString(tok.type)
+            << "| " << std::setw(40) << tok.literal
+            << "|\n";
     }
     
-    std::cout << std::string(76, '-') << "\n";
-    std::cout << "Total tokens: " << col(TermColor::Bold) << tokens.size() 
-              << col(TermColor::Reset) << "\n";
+    out << std::string(76, '-') << "\n";
+    out << "Total tokens: " << col(TermColor::Bold) << tokens.size() 
+        << col(TermColor::Reset) << "\n";
+}
+
+void printStats(const pl0::ExecutionStats& stats, std::ostream& out) {
+    out << "\n" << col(TermColor::BoldCyan) << "========== Statistics ==========" 
+        << col(TermColor::Reset) << "\n";
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(20) << "Instructions:" << stats.instructions << "\n"
+        << std::setw(20) << "Wall time:" << stats.wallSeconds * 1000.0 << " ms\n"
+        << std::setw(20) << "Calls:" << stats.calls << " (max depth " << stats.maxCallDepth << ")\n"
+        << std::setw(20) << "Stack high-water:" << stats.maxStackTop << " words\n"
+        << std::setw(20) << "Heap:" << stats.heapSize << " words (high-water " << stats.heapHighWater
+        << "), live " << stats.liveHeap << " words in " << stats.liveBlocks << " blocks\n"
+        << std::setw(20) << "Free list:" << stats.freeBlocks << " blocks, " << stats.freeWords 
+        << " words (largest " << stats.largestFreeBlock << ", fragmentation " 
+        << std::setprecision(1) << stats.fragmentation * 100.0 << "%)\n";
+    
+    if (stats.hasOpcodeCounts) {
+        out << "Opcodes:\n";
+        for (int op = 0; op < pl0::OPCODE_COUNT; op++) {
+            uint64_t count = stats.opcodeCounts[op];
+            if (count == 0) continue;
+            out << "    " << std::setw(6) << pl0::opCodeToString(static_cast<pl0::OpCode>(op))
+                << std::right << std::setw(14) << count << std::setw(8)
+                << (stats.instructions ? 100.0 * count / stats.instructions : 0.0) << "%\n" << std::left;
+        }
+    }
+    out << std::defaultfloat << std::setprecision(6) << std::right;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// One JSON object per run, on a single line (for log scrapers)
+void writeStatsJson(const pl0::ExecutionStats& stats, const std::string& file, 
+                    bool runtimeSuccess, bool timedOut, std::ostream& out) {
+    out << "{\"file\":\"" << jsonEscape(file) << "\""
+        << ",\"success\":" << (runtimeSuccess ? "true" : "false")
+        << ",\"timedOut\":" << (timedOut ? "true" : "false")
+        << ",\"instructions\":" << stats.instructions
+        << ",\"wallSeconds\":" << stats.wallSeconds
+        << ",\"calls\":" << stats.calls
+        << ",\"maxCallDepth\":" << stats.maxCallDepth
+        << ",\"maxStackTop\":" << stats.maxStackTop
+        << ",\"heap\":{\"size\":" << stats.heapSize
+        << ",\"highWater\":" << stats.heapHighWater
+        << ",\"live\":" << stats.liveHeap
+        << ",\"liveBlocks\":" << stats.liveBlocks
+        << ",\"freeBlocks\":" << stats.freeBlocks
+        << ",\"freeWords\":" << stats.freeWords
+        << ",\"largestFreeBlock\":" << stats.largestFreeBlock
+        << ",\"fragmentation\":" << stats.fragmentation << "}";
+    if (stats.hasOpcodeCounts) {
+        out << ",\"opcodes\":{";
+        for (int op = 0; op < pl0::OPCODE_COUNT; op++) {
+            out << (op ? "," : "") << "\"" << pl0::opCodeToString(static_cast<pl0::OpCode>(op)) 
+                << "\":" << stats.opcodeCounts[op];
+        }
+        out << "}";
+    }
+    out << "}\n";
 }
 
 struct CompilationResult {
@@ -250,77 +408,159 @@ struct CompilationResult {
     std::string errorMessage;
     bool runtimeSuccess = true;
     std::string runtimeError;
+    bool timedOut = false;
+    uint64_t instructions = 0;  // Instructions executed (0 if not run)
+    pl0::TimeReport timeReport; // Filled with --time-report
 };
 
-CompilationResult compileFile(const std::string& filepath, const CompilerOptions& opts) {
+// Write to a temporary file and rename it over the old one, so a process
+// killed while saving still leaves the previous checkpoint intact
+bool saveCheckpoint(const pl0::Interpreter& interpreter, const std::string& path) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out || !interpreter.saveSnapshot(out) || !out.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    return !ec;
+}
+
+// Restore interpreter from path if it exists. Returns true if the program
+// should resume; an unusable checkpoint is reported and the run starts over.
+bool loadCheckpoint(pl0::Interpreter& interpreter, const std::string& path, const JobStreams& io) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string error;
+    if (!interpreter.loadSnapshot(in, error)) {
+        io.err << col(TermColor::Yellow) << "Warning: " << col(TermColor::Reset)
+               << "ignoring checkpoint " << path << ": " << error << "\n";
+        return false;
+    }
+    io.err << "Resuming from checkpoint " << path << " at instruction "
+           << interpreter.getInstructionCount() << "\n";
+    return true;
+}
+
+// Store address of a debugger watch target: a variable visible at the
+// current PC, the word a pointer variable points to (*p), or an address.
+// Returns -1 if it cannot be resolved.
+int watchTarget(const pl0::Interpreter& interpreter, const std::string& target) {
+    if (std::isdigit(static_cast<unsigned char>(target[0]))) {
+        char* end = nullptr;
+        long addr = std::strtol(target.c_str(), &end, 10);
+        return *end == '\0' && addr <= INT_MAX ? static_cast<int>(addr) : -1;
+    }
+    if (target[0] == '*') {
+        int ptr = interpreter.getVariableAddress(std::string_view(target).substr(1));
+        if (ptr < 0) return -1;
+        pl0::Word addr = interpreter.getValueAt(ptr);
+        return addr >= 0 && addr <= INT_MAX ? static_cast<int>(addr) : -1;
+    }
+    return interpreter.getVariableAddress(target);
+}
+
+CompilationResult compileFile(const std::string& filepath, const CompilerOptions& opts, const JobStreams& io) {
     CompilationResult result;
+    pl0::TimeReport* report = opts.timeReport ? &result.timeReport : nullptr;
     
     // Load source file
     pl0::SourceManager srcMgr;
-    if (!srcMgr.loadFile(filepath)) {
+    pl0::ScopedPhase loadPhase(report, "load");
+    bool loaded = srcMgr.loadFile(filepath);
+    loadPhase.stop();
+    if (!loaded) {
         result.errorMessage = "Failed to open file: " + filepath;
         return result;
     }
     
     // Initialize components
-    pl0::DiagnosticsEngine diag(srcMgr);
-    pl0::Lexer lexer(srcMgr.getSource(), diag);
-    pl0::SymbolTable symTable;
+    pl0::DiagnosticsEngine diag(srcMgr, io.err);
+    diag.setUseColor(g_useColor && !opts.noColor);
+    // Front-end memory of this compilation: the lexer's source copy (token
+    // literals point into it) and symbol names, sized for the source plus names
+    const std::string& source = srcMgr.getSource();
+    auto context = std::make_shared<pl0::CompilationContext>(source.size() + source.size() / 8);
+    pl0::Lexer lexer(source, diag, *context);
+    pl0::SymbolTable symTable(context);
     pl0::CodeGenerator codeGen;
     
     // Tokenize first (for display purposes) - before creating parser
+    pl0::ScopedPhase lexPhase(report, "tokenize");
     std::vector<pl0::Token> tokens = lexer.tokenize();
+    lexPhase.stop();
     
     if (opts.showTokens || opts.showAll) {
-        printTokens(tokens);
+        printTokens(tokens, io.out);
     }
     
     // Reset lexer for parsing
     lexer.reset();
     
     // Create parser after lexer is reset (parser constructor calls advance())
+    pl0::ScopedPhase parsePhase(report, "parse");
     pl0::Parser parser(lexer, symTable, codeGen, diag);
     
     // Enable AST dump if requested
     if (opts.showAst || opts.showAll) {
         parser.enableAstDump(true);
+        parser.setAstOutput(io.out);
     }
     
     // Parse and generate code
     parser.parse();
+    parsePhase.stop();
+
+    // Scopes, variables and lines for the debugger
+    pl0::DebugInfo debugInfo;
+    if (opts.debug || !opts.traceFile.empty()) {
+        debugInfo.build(symTable, codeGen.getCode());
+    }
 
     // Optimize
     if (opts.optimize) {
+        pl0::ScopedPhase optimizePhase(report, "optimize");
         pl0::Optimizer optimizer;
-        std::vector<pl0::Instruction> optimCode = optimizer.optimize(codeGen.getCode());
-        codeGen.setCode(optimCode);
+        optimizer.setCheckOverflow(opts.checkOverflow);
+        codeGen.setCode(optimizer.optimize(codeGen.getCode()));
+        if (!debugInfo.empty()) {
+            debugInfo.relocate([&optimizer](int address) { return optimizer.remapAddress(address); },
+                               codeGen.getCode());
+        }
     }
     
+    pl0::ScopedPhase dumpPhase(report, "dump");
+    
     // Show symbol table
     if (opts.showSymbols || opts.showAll) {
-        symTable.dump();
+        symTable.dump(io.out);
     }
     
     // Show generated code
     if (opts.showCode || opts.showAll) {
-        codeGen.dump();
+        codeGen.dump(io.out);
     }
+    dumpPhase.stop();
     
     // Get error/warning counts
     result.errorCount = diag.getErrorCount();
     result.warningCount = diag.getWarningCount();
     
     // Print compilation summary
-    std::cout << "\n" << std::string(50, '=') << "\n";
+    io.out << "\n" << std::string(50, '=') << "\n";
     if (result.errorCount == 0) {
-        std::cout << col(TermColor::BoldGreen) << "Compilation successful" << col(TermColor::Reset);
+        io.out << col(TermColor::BoldGreen) << "Compilation successful" << col(TermColor::Reset);
     } else {
-        std::cout << col(TermColor::BoldRed) << "Compilation failed" << col(TermColor::Reset);
+        io.out << col(TermColor::BoldRed) << "Compilation failed" << col(TermColor::Reset);
     }
-    std::cout << " (errors: " << col(result.errorCount > 0 ? TermColor::Red : TermColor::Green) 
-              << result.errorCount << col(TermColor::Reset)
-              << ", warnings: " << col(result.warningCount > 0 ? TermColor::Yellow : TermColor::Green)
-              << result.warningCount << col(TermColor::Reset) << ")\n";
+    io.out << " (errors: " << col(result.errorCount > 0 ? TermColor::Red : TermColor::Green) 
+           << result.errorCount << col(TermColor::Reset)
+           << ", warnings: " << col(result.warningCount > 0 ? TermColor::Yellow : TermColor::Green)
+           << result.warningCount << col(TermColor::Reset) << ")\n";
     
     if (result.errorCount > 0) {
         return result;
@@ -330,89 +570,300 @@ CompilationResult compileFile(const std::string& filepath, const CompilerOptions
     
     // Execute if requested
     if (!opts.noRun) {
-        std::cout << "\n" << col(TermColor::BoldCyan) 
-                  << "========== Program Execution ==========" 
-                  << col(TermColor::Reset) << "\n";
+        pl0::ScopedPhase setupPhase(report, "vm setup");
+        
+        // Data files are mapped before the run so a bad path fails up front
+        pl0::MappedIntReader fileReader(opts.ioFormat);
+        pl0::MappedIntWriter fileWriter(opts.ioFormat);
+        if (!opts.inputFile.empty() && !fileReader.open(opts.inputFile)) {
+            setupPhase.stop();
+            result.success = false;
+            result.errorMessage = fileReader.getError();
+            return result;
+        }
+        // A checkpointed run may resume: its output so far is kept until the checkpoint is read
+        bool resumable = opts.checkpointEvery > 0 && !opts.debug;
+        if (!opts.outputFile.empty() && !fileWriter.open(opts.outputFile, resumable)) {
+            setupPhase.stop();
+            result.success = false;
+            result.errorMessage = fileWriter.getError();
+            return result;
+        }
+        
+        io.out << "\n" << col(TermColor::BoldCyan) 
+               << "========== Program Execution ==========" 
+               << col(TermColor::Reset) << "\n";
+        
+        // Binary trace: into the file, or an in-memory ring printed after the run
+        pl0::TraceBuffer traceBuffer;
+        if (!opts.traceFile.empty() || opts.traceRecords > 0) {
+            size_t records = opts.traceRecords > 0 ? opts.traceRecords : pl0::TraceBuffer::DEFAULT_RECORDS;
+            if (!traceBuffer.create(codeGen.getCode(), &debugInfo, records, opts.traceFile)) {
+                setupPhase.stop();
+                result.success = false;
+                result.errorMessage = traceBuffer.getError();
+                return result;
+            }
+        }
         
         pl0::Interpreter interpreter(codeGen.getCode());
-        interpreter.setSymbolTable(&symTable); // Link SymbolTable for debugging
+        interpreter.setDebugInfo(&debugInfo);
+        if (traceBuffer.capacity() > 0) {
+            interpreter.setTraceBuffer(&traceBuffer);
+        }
+        interpreter.setStreams(io.in, io.out, io.err);
         
         if (opts.trace) {
             interpreter.enableTrace(true);
         }
         
+        if (opts.timeoutMs > 0) {
+            interpreter.setTimeLimit(std::chrono::milliseconds(opts.timeoutMs));
+        }
+        interpreter.setCheckOverflow(opts.checkOverflow);
+        interpreter.setStackSize(opts.stackSize);
+        interpreter.setHeapSize(opts.heapSize);
+        
+        // Batch I/O: trace and debug output interleave with program output, keep the console path
+        std::unique_ptr<pl0::StreamIntReader> batchReader;
+        std::unique_ptr<pl0::StreamIntWriter> batchWriter;
+        if (opts.batchIo > 0 && !opts.debug && !opts.trace) {
+            batchReader = std::make_unique<pl0::StreamIntReader>(io.in);
+            batchWriter = std::make_unique<pl0::StreamIntWriter>(io.out);
+            interpreter.setIntReader(batchReader.get());
+            interpreter.setIntWriter(batchWriter.get());
+        }
+        if (!opts.inputFile.empty()) {
+            interpreter.setIntReader(&fileReader);
+        }
+        if (!opts.outputFile.empty()) {
+            interpreter.setIntWriter(&fileWriter);
+        }
+        
+        std::unique_ptr<pl0::Profiler> profiler;
+        if (opts.profile || !opts.profileStacksFile.empty()) {
+            profiler = std::make_unique<pl0::Profiler>(codeGen.getCode());
+            profiler->setSymbolTable(&symTable);
+            interpreter.setProfiler(profiler.get());
+        }
+        
+        if (opts.stats || !opts.statsJsonFile.empty()) {
+            interpreter.enableStats(true);
+        }
+        setupPhase.stop();
+        
+        pl0::ScopedPhase executePhase(report, "execute");
         if (opts.debug) {
-            std::cout << col(TermColor::Yellow) << "Entering Debug Mode...\n" << col(TermColor::Reset);
-            std::cout << "Commands: b <line> (break), r (run), s (step), n (next), p <var> (print), q (quit)\n";
+            io.out << col(TermColor::Yellow) << "Entering Debug Mode...\n" << col(TermColor::Reset);
+            io.out << "Commands: b <line> (break), w <var|*ptr|addr> (watch), r (run), s (step), n (next), p <var> (print), q (quit)\n";
+            if (opts.recordEvery > 0) {
+                io.out << "          rs (reverse step), rc (reverse continue)\n";
+            }
             
             interpreter.setDebugMode(true);
+            interpreter.setRecording(opts.recordEvery);
             interpreter.start(); // Prepare
             
             // REPL loop
             std::string line;
             bool quit = false;
+            bool terminated = false;
             
             while (!quit) {
                 pl0::DebugState state = interpreter.getDebugState();
                 if (state == pl0::DebugState::HALTED || state == pl0::DebugState::ERROR) {
-                     std::cout << "Program terminated.\n";
-                     break; 
+                     // A recorded run can still be stepped back into
+                     if (!interpreter.isRecording()) {
+                         io.out << "Program terminated.\n";
+                         break;
+                     }
+                     if (!terminated) {
+                         io.out << "Program terminated (rs/rc to go back, q to quit).\n";
+                         terminated = true;
+                     }
+                } else {
+                     terminated = false;
                 }
                 
                 int currentLine = interpreter.getCurrentLine();
-                std::cout << col(TermColor::BoldBlue) << "(debug L" << currentLine << ")> " << col(TermColor::Reset);
+                io.out << col(TermColor::BoldBlue) << "(debug L" << currentLine << ")> " << col(TermColor::Reset);
                 
-                if (!std::getline(std::cin, line)) break;
+                if (!std::getline(io.in, line)) break;
                 if (line.empty()) continue;
                 
                 std::stringstream ss(line);
-                char cmd;
+                std::string cmd;
                 ss >> cmd;
                 
-                if (cmd == 'b') {
+                if (cmd == "b") {
                      int ln;
                      if (ss >> ln) {
                          interpreter.setBreakpoint(ln);
-                         std::cout << "Breakpoint set at line " << ln << "\n";
+                         io.out << "Breakpoint set at line " << ln << "\n";
                      } else {
-                         std::cout << "Usage: b <line_number>\n";
+                         io.out << "Usage: b <line_number>\n";
                      }
-                } else if (cmd == 'r' || cmd == 'c') {
+                } else if (cmd == "w") {
+                     std::string target;
+                     if (ss >> target) {
+                         int addr = watchTarget(interpreter, target);
+                         if (interpreter.addWatchpoint(target, addr)) {
+                             io.out << "Watchpoint set on " << target << " (address " << addr << ")\n";
+                         } else {
+                             io.out << "Cannot watch " << target << "\n";
+                         }
+                     } else if (interpreter.getWatchpoints().empty()) {
+                         io.out << "No watchpoints. Usage: w <var> | w *<pointer> | w <address>\n";
+                     } else {
+                         for (const auto& w : interpreter.getWatchpoints()) {
+                             io.out << "  " << w.name << " (address " << w.address << ") = "
+                                    << interpreter.getValueAt(w.address) << "\n";
+                         }
+                     }
+                } else if (cmd == "r" || cmd == "c") {
                     interpreter.resume();
-                } else if (cmd == 's') {
+                } else if (cmd == "s") {
                     interpreter.step();
-                } else if (cmd == 'n') {
+                } else if (cmd == "n") {
                     interpreter.stepOver();
-                } else if (cmd == 'p') {
+                } else if (cmd == "p") {
                     std::string var;
                     if (ss >> var) {
-                         int val = interpreter.getValue(var);
+                         pl0::Word val = interpreter.getValue(var);
                          // Note: getValue returns fallback error values if not found or visible.
                          // Ideally we should have a `bool tryGetValue(name, &val)`
-                         std::cout << var << " = " << val << "\n";
+                         io.out << var << " = " << val << "\n";
                     } else {
-                         std::cout << "Usage: p <variable_name>\n";
+                         io.out << "Usage: p <variable_name>\n";
+                    }
+                } else if (cmd == "rs" || cmd == "rc") {
+                    bool moved = cmd == "rs" ? interpreter.reverseStep() : interpreter.reverseContinue();
+                    if (!moved) {
+                        io.out << (interpreter.isRecording() ? "At the start of the recording.\n"
+                                                             : "Recording is off (--record-every).\n");
                     }
-                } else if (cmd == 'q') {
+                } else if (cmd == "q") {
                     quit = true;
                 } else {
-                    std::cout << "Unknown command.\n";
+                    io.out << "Unknown command.\n";
+                }
+            }
+            
+        } else if (opts.checkpointEvery > 0) {
+            std::string checkpointFile = opts.checkpointFile.empty() ? filepath + ".ckpt" : opts.checkpointFile;
+            pl0::IntReader* reader = !opts.inputFile.empty() ? static_cast<pl0::IntReader*>(&fileReader) : batchReader.get();
+            pl0::IntWriter* writer = !opts.outputFile.empty() ? static_cast<pl0::IntWriter*>(&fileWriter) : batchWriter.get();
+            bool saveFailed = false;
+            interpreter.setCheckpointInterval(opts.checkpointEvery, [&]() {
+                // Output up to here is final before the snapshot says so
+                if (writer) {
+                    writer->flush();
+                }
+                io.out.flush();
+                if (!saveCheckpoint(interpreter, checkpointFile) && !saveFailed) {
+                    saveFailed = true;
+                    io.err << col(TermColor::Yellow) << "Warning: " << col(TermColor::Reset)
+                           << "cannot write checkpoint " << checkpointFile << "\n";
                 }
+            });
+            
+            bool resumed = loadCheckpoint(interpreter, checkpointFile, io);
+            // Output written before the checkpoint stays, anything after it goes
+            if (!opts.outputFile.empty() &&
+                !fileWriter.resumeAt(resumed ? interpreter.getSnapshotOutputBytes() : 0)) {
+                io.err << col(TermColor::Yellow) << "Warning: " << col(TermColor::Reset)
+                       << fileWriter.getError() << "; starting over\n";
+                resumed = false;
+                fileWriter.resumeAt(0);
+            }
+            if (resumed) {
+                // Input consumed before the checkpoint is not read again
+                pl0::Word skipped;
+                for (uint64_t n = interpreter.getInputCount(); n > 0 && reader && reader->read(skipped); n--) {
+                }
+                interpreter.resume();
+            } else {
+                interpreter.run();
             }
             
+            // Keep the checkpoint only when the run was cut short by --timeout
+            if (!interpreter.timedOut()) {
+                std::error_code ec;
+                fs::remove(checkpointFile, ec);
+            }
         } else {
             // Normal Run
             interpreter.run();
         }
         
+        if (batchWriter) {
+            batchWriter->flush();
+        }
+        executePhase.stop();
+        if (!opts.traceFile.empty() && !traceBuffer.close()) {
+            io.err << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                   << opts.traceFile << ": " << traceBuffer.getError() << "\n";
+        }
+        if (!opts.outputFile.empty() && !fileWriter.close()) {
+            io.err << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                   << opts.outputFile << ": " << fileWriter.getError() << "\n";
+            result.runtimeSuccess = false;
+            result.runtimeError = fileWriter.getError();
+        }
+        
         if (interpreter.hasError()) {
             result.runtimeSuccess = false;
             result.runtimeError = interpreter.getError();
         }
+        result.timedOut = interpreter.timedOut();
+        result.instructions = interpreter.getInstructionCount();
+        
+        io.out << col(TermColor::BoldCyan) 
+               << "========== Execution Complete ==========" 
+               << col(TermColor::Reset) << "\n";
+        
+        if (opts.traceFile.empty() && traceBuffer.capacity() > 0) {
+            io.out << "\n" << col(TermColor::BoldCyan)
+                   << "========== Last " << traceBuffer.size() << " of "
+                   << traceBuffer.getTotal() << " Instructions =========="
+                   << col(TermColor::Reset) << "\n";
+            for (size_t i = 0; i < traceBuffer.size(); i++) {
+                const pl0::TraceRecord& rec = traceBuffer[i];
+                pl0::TraceBuffer::print(io.out, rec, traceBuffer.lineAt(rec.pc));
+            }
+        }
+        if (opts.stats) {
+            printStats(interpreter.getStats(), io.out);
+        }
+        if (opts.statsJsonFile == "-") {
+            writeStatsJson(interpreter.getStats(), filepath, result.runtimeSuccess, result.timedOut, io.out);
+        } else if (!opts.statsJsonFile.empty()) {
+            std::ofstream json(opts.statsJsonFile);
+            if (json) {
+                writeStatsJson(interpreter.getStats(), filepath, result.runtimeSuccess, result.timedOut, json);
+            }
+            if (!json) {
+                io.err << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                       << "Cannot write statistics: " << opts.statsJsonFile << "\n";
+            }
+        }
         
-        std::cout << col(TermColor::BoldCyan) 
-                  << "========== Execution Complete ==========" 
-                  << col(TermColor::Reset) << "\n";
+        if (opts.profile) {
+            io.out << "\n" << col(TermColor::BoldCyan) 
+                   << "========== Profile ==========" 
+                   << col(TermColor::Reset) << "\n";
+            profiler->report(io.out, &srcMgr);
+        }
+        if (!opts.profileStacksFile.empty()) {
+            std::ofstream stacks(opts.profileStacksFile);
+            if (stacks) {
+                profiler->writeCollapsedStacks(stacks);
+            }
+            if (!stacks) {
+                io.err << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                       << "Cannot write profile stacks: " << opts.profileStacksFile << "\n";
+            }
+        }
     }
     
     return result;
@@ -425,12 +876,17 @@ struct TestResult {
     bool expectError;
     std::string message;
     double duration_ms;
+    uint64_t instructions = 0;  // Instructions executed (0 for compile-only tests)
+    std::string stdoutText;     // Captured compiler/program output
+    std::string stderrText;     // Captured diagnostics and runtime errors
 };
 
 class TestRunner {
 public:
-    explicit TestRunner(const std::string& baseDir) : baseDir_(baseDir) {}
+    TestRunner(const std::string& baseDir, int jobs, int timeoutMs)
+        : baseDir_(baseDir), jobs_(jobs), timeoutMs_(timeoutMs) {}
     
+    // Run every test on the worker pool; results are in sorted path order
     std::vector<TestResult> runAllTests() {
         std::vector<TestResult> results;
         
@@ -451,14 +907,24 @@ public:
         
         std::sort(testFiles.begin(), testFiles.end());
         
-        for (const auto& [path, expectError] : testFiles) {
-            results.push_back(runSingleTest(path, expectError));
-        }
+        results.resize(testFiles.size());
+        pl0::WorkerPool pool(jobs_);
+        workerCount_ = pool.getWorkerCount();
+        
+        auto start = std::chrono::steady_clock::now();
+        pool.run(testFiles.size(), [&](size_t i) {
+            results[i] = runSingleTest(testFiles[i].first, testFiles[i].second);
+        });
+        auto end = std::chrono::steady_clock::now();
+        wallTime_ms_ = std::chrono::duration<double, std::milli>(end - start).count();
         
         return results;
     }
     
-    static void printResults(const std::vector<TestResult>& results) {
+    int getWorkerCount() const { return workerCount_; }
+    double getWallTime() const { return wallTime_ms_; }
+    
+    void printResults(const std::vector<TestResult>& results) const {
         if (results.empty()) {
             return;
         }
@@ -471,6 +937,7 @@ public:
         
         int passed = 0, failed = 0;
         double totalTime = 0;
+        uint64_t totalInstructions = 0;
         
         std::string currentDir;
         
@@ -498,13 +965,25 @@ public:
             std::cout << col(TermColor::Cyan) << std::right << std::setw(8) 
                       << std::fixed << std::setprecision(2) << r.duration_ms << " ms"
                       << col(TermColor::Reset);
+            if (r.instructions > 0) {
+                std::cout << std::setw(12) << r.instructions << " instr";
+            } else if (!r.passed && !r.message.empty()) {
+                std::cout << std::string(18, ' ');
+            }
             
             if (!r.message.empty() && !r.passed) {
                 std::cout << "  " << col(TermColor::Yellow) << r.message << col(TermColor::Reset);
             }
             
             std::cout << "\n";
+            
+            // Show the tail of the captured diagnostics for failures
+            if (!r.passed && !r.stderrText.empty()) {
+                printIndented(r.stderrText, 10);
+            }
+            
             totalTime += r.duration_ms;
+            totalInstructions += r.instructions;
         }
         
         std::cout << "\n" << std::string(60, '-') << "\n";
@@ -514,7 +993,11 @@ public:
         std::cout << "  Failed: " << col(failed > 0 ? TermColor::BoldRed : TermColor::BoldGreen) 
                   << failed << col(TermColor::Reset) << "\n";
         std::cout << "  Time:   " << col(TermColor::Cyan) << std::fixed << std::setprecision(2) 
-                  << totalTime << " ms" << col(TermColor::Reset) << "\n";
+                  << totalTime << " ms" << col(TermColor::Reset)
+                  << " (wall " << wallTime_ms_ << " ms, " << workerCount_ << " worker"
+                  << (workerCount_ == 1 ? "" : "s") << ")\n";
+        std::cout << "  Instr:  " << col(TermColor::Cyan) << totalInstructions 
+                  << col(TermColor::Reset) << " executed\n";
         std::cout << std::string(60, '-') << "\n";
         
         if (failed == 0) {
@@ -526,8 +1009,118 @@ public:
         }
     }
     
+    // Write a JUnit XML report (one <testsuite> per test directory).
+    // Returns false if the file cannot be written.
+    bool writeJUnit(const std::vector<TestResult>& results, const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        
+        int failures = 0;
+        double totalTime = 0;
+        for (const auto& r : results) {
+            if (!r.passed) failures++;
+            totalTime += r.duration_ms;
+        }
+        
+        out << std::fixed << std::setprecision(3);
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        out << "<testsuites name=\"pl0c\" tests=\"" << results.size() 
+            << "\" failures=\"" << failures << "\" time=\"" << totalTime / 1000.0 << "\">\n";
+        
+        size_t i = 0;
+        while (i < results.size()) {
+            // Results are sorted by path, so each directory is a contiguous run
+            std::string dir = fs::path(results[i].path).parent_path().generic_string();
+            size_t end = i;
+            int suiteFailures = 0;
+            double suiteTime = 0;
+            while (end < results.size() && 
+                   fs::path(results[end].path).parent_path().generic_string() == dir) {
+                if (!results[end].passed) suiteFailures++;
+                suiteTime += results[end].duration_ms;
+                end++;
+            }
+            
+            out << "  <testsuite name=\"" << xmlEscape(dir) << "\" tests=\"" << (end - i)
+                << "\" failures=\"" << suiteFailures << "\" time=\"" << suiteTime / 1000.0 << "\">\n";
+            
+            for (; i < end; ++i) {
+                const TestResult& r = results[i];
+                out << "    <testcase classname=\"" << xmlEscape(dir) << "\" name=\"" 
+                    << xmlEscape(r.name) << "\" time=\"" << r.duration_ms / 1000.0 << "\">\n";
+                if (!r.passed) {
+                    out << "      <failure message=\"" << xmlEscape(r.message) << "\"/>\n";
+                }
+                if (!r.stdoutText.empty()) {
+                    out << "      <system-out>" << xmlEscape(r.stdoutText) << "</system-out>\n";
+                }
+                if (!r.stderrText.empty()) {
+                    out << "      <system-err>" << xmlEscape(r.stderrText) << "</system-err>\n";
+                }
+                out << "    </testcase>\n";
+            }
+            
+            out << "  </testsuite>\n";
+        }
+        
+        out << "</testsuites>\n";
+        return static_cast<bool>(out);
+    }
+    
 private:
     std::string baseDir_;
+    int jobs_;
+    int timeoutMs_;
+    int workerCount_ = 1;
+    double wallTime_ms_ = 0;
+    
+    // Print the last maxLines lines of text, indented under a test line
+    static void printIndented(const std::string& text, size_t maxLines) {
+        std::vector<std::string> lines;
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        
+        size_t first = lines.size() > maxLines ? lines.size() - maxLines : 0;
+        for (size_t i = first; i < lines.size(); ++i) {
+            std::cout << "        " << col(TermColor::Yellow) << "│ " << col(TermColor::Reset) 
+                      << lines[i] << "\n";
+        }
+    }
+    
+    // Escape text for XML attributes/content; drops ANSI escapes and other
+    // control characters that XML 1.0 cannot represent
+    static std::string xmlEscape(const std::string& text) {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            char c = text[i];
+            switch (c) {
+                case '&':  escaped += "&amp;"; break;
+                case '<':  escaped += "&lt;"; break;
+                case '>':  escaped += "&gt;"; break;
+                case '"':  escaped += "&quot;"; break;
+                case '\'': escaped += "&apos;"; break;
+                case '\033':
+                    // Skip CSI sequence: ESC '[' params final-byte
+                    if (i + 1 < text.size() && text[i + 1] == '[') {
+                        i += 2;
+                        while (i < text.size() && !(text[i] >= '@' && text[i] <= '~')) i++;
+                    }
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20 || c == '\n' || c == '\t' || c == '\r') {
+                        escaped += c;
+                    }
+                    break;
+            }
+        }
+        return escaped;
+    }
     
     void collectTestFiles(const std::string& dir, 
                           std::vector<std::pair<std::string, bool>>& files) {
@@ -549,6 +1142,21 @@ private:
         }
     }
     
+    // Program output: the text between the execution banners
+    static std::string executionOutput(const std::string& text) {
+        size_t begin = text.find("========== Program Execution ==========");
+        size_t end = text.find("========== Execution Complete ==========");
+        if (begin == std::string::npos || end == std::string::npos || end < begin) {
+            return std::string();
+        }
+        return text.substr(begin, end - begin);
+    }
+    
+    static bool isInDirectory(const std::string& path, const std::string& dir) {
+        return path.find("/" + dir + "/") != std::string::npos ||
+               path.find("\\" + dir + "\\") != std::string::npos;
+    }
+    
     bool isErrorTest(const std::string& path) const {
         return path.find("/error/") != std::string::npos ||
                path.find("/errors/") != std::string::npos ||
@@ -556,7 +1164,7 @@ private:
                path.find("\\errors\\") != std::string::npos;
     }
     
-    TestResult runSingleTest(const std::string& path, bool expectError) {
+    TestResult runSingleTest(const std::string& path, bool expectError) const {
         TestResult result;
         result.path = path;
         result.name = fs::path(path).filename().string();
@@ -565,34 +1173,48 @@ private:
         auto start = std::chrono::high_resolution_clock::now();
         
         try {
-            std::streambuf* coutBuf = std::cout.rdbuf();
-            std::streambuf* cerrBuf = std::cerr.rdbuf();
-            std::ostringstream nullStream;
-            std::cout.rdbuf(nullStream.rdbuf());
-            std::cerr.rdbuf(nullStream.rdbuf());
+            // Capture all compiler/interpreter output; tests never see stdin
+            std::istringstream noInput;
+            std::ostringstream capturedOut;
+            std::ostringstream capturedErr;
+            JobStreams io{noInput, capturedOut, capturedErr};
             
             CompilerOptions opts;
             opts.noColor = true;
+            opts.timeoutMs = timeoutMs_;
+            opts.batchIo = 1;
+            
+            // overflow/: run with --check-overflow; errors must be overflow traps
+            bool overflowTest = isInDirectory(path, "overflow");
+            opts.checkOverflow = overflowTest;
             
             if (path.find("interpreter") != std::string::npos || 
-                path.find("integration") != std::string::npos) {
+                path.find("integration") != std::string::npos || overflowTest ||
+                isInDirectory(path, "optimized")) {
                 opts.noRun = false;
             } else {
                 opts.noRun = true;
             }
             
-            CompilationResult compResult = compileFile(path, opts);
-            
-            std::cout.rdbuf(coutBuf);
-            std::cerr.rdbuf(cerrBuf);
+            CompilationResult compResult = compileFile(path, opts, io);
+            result.instructions = compResult.instructions;
+            result.stdoutText = capturedOut.str();
+            result.stderrText = capturedErr.str();
             
             bool hasErrors = compResult.errorCount > 0;
             bool runtimeFailed = !compResult.runtimeSuccess;
             
-            if (expectError) {
+            if (compResult.timedOut) {
+                // A hung program never counts as the expected failure
+                result.passed = false;
+                result.message = "Timed out after " + std::to_string(timeoutMs_) + " ms";
+            } else if (expectError) {
                 result.passed = hasErrors || runtimeFailed;
                 if (!result.passed) {
                     result.message = "Expected error but compiled and ran successfully";
+                } else if (overflowTest && compResult.runtimeError.find("integer overflow") == std::string::npos) {
+                    result.passed = false;
+                    result.message = "Expected an integer overflow error";
                 }
             } else {
                 result.passed = !hasErrors && !runtimeFailed;
@@ -603,6 +1225,29 @@ private:
                 }
             }
             
+            // A program that runs must write the same output with -O
+            if (result.passed && !expectError && !opts.noRun) {
+                std::ostringstream optimizedOut;
+                std::ostringstream optimizedErr;
+                JobStreams optimizedIo{noInput, optimizedOut, optimizedErr};
+                CompilerOptions optimizedOpts = opts;
+                optimizedOpts.optimize = true;
+                CompilationResult optimized = compileFile(path, optimizedOpts, optimizedIo);
+                result.stdoutText += "\n[-O]\n" + optimizedOut.str();
+                result.stderrText += optimizedErr.str();
+                
+                if (optimized.timedOut) {
+                    result.passed = false;
+                    result.message = "Timed out with -O after " + std::to_string(timeoutMs_) + " ms";
+                } else if (optimized.errorCount > 0 || !optimized.runtimeSuccess) {
+                    result.passed = false;
+                    result.message = "Fails with -O: " + optimized.runtimeError;
+                } else if (executionOutput(optimizedOut.str()) != executionOutput(capturedOut.str())) {
+                    result.passed = false;
+                    result.message = "Output differs with -O";
+                }
+            }
+            
         } catch (const std::exception& e) {
             result.passed = expectError;
             result.message = std::string("Exception: ") + e.what();
@@ -615,6 +1260,108 @@ private:
     }
 };
 
+// Resolve, compile and (optionally) run one input file; returns its exit code
+int compileJob(const std::string& inputFile, const CompilerOptions& opts, const JobStreams& io) {
+    // Resolve file path
+    std::string resolvedPath = FileResolver::resolve(inputFile);
+    
+    // Check if file exists
+    if (!fs::exists(resolvedPath)) {
+        io.err << col(TermColor::BoldRed) << "Error: " << col(TermColor::Reset)
+               << "File not found: " << inputFile << "\n";
+        
+        // Suggest similar files
+        std::string dir = fs::path(inputFile).parent_path().string();
+        if (dir.empty()) dir = ".";
+        
+        if (fs::exists(dir)) {
+            std::vector<std::string> suggestions;
+            std::string base = FileResolver::getBasename(inputFile);
+            
+            try {
+                for (const auto& entry : fs::directory_iterator(dir)) {
+                    if (entry.path().extension() == ".pl0") {
+                        std::string name = entry.path().stem().string();
+                        // Simple similarity check
+                        if (name.find(base) != std::string::npos ||
+                            base.find(name) != std::string::npos) {
+                            suggestions.push_back(entry.path().filename().string());
+                        }
+                    }
+                }
+            } catch (...) {}
+            
+            if (!suggestions.empty()) {
+                io.err << "\nDid you mean:\n";
+                for (const auto& s : suggestions) {
+                    io.err << "  " << col(TermColor::Cyan) << s << col(TermColor::Reset) << "\n";
+                }
+            }
+        }
+        
+        return 3;
+    }
+    
+    // Print header
+    io.out << col(TermColor::BoldCyan) << "Extended PL/0 Compiler" << col(TermColor::Reset) << "\n";
+    io.out << "Input file: " << col(TermColor::Bold) << resolvedPath << col(TermColor::Reset) << "\n";
+    io.out << std::string(50, '=') << "\n";
+    
+    // Compile
+    CompilationResult result = compileFile(resolvedPath, opts, io);
+    
+    // Also after failed compilations: slow error paths are worth seeing
+    if (opts.timeReport) {
+        io.err << "\n" << col(TermColor::BoldCyan) << "========== Time Report ==========" 
+               << col(TermColor::Reset) << "\n";
+        result.timeReport.print(io.err);
+    }
+    
+    if (!result.success) {
+        if (!result.errorMessage.empty()) {
+            io.err << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                   << result.errorMessage << "\n";
+        }
+        return result.errorCount > 0 ? 1 : 2;
+    }
+    
+    return 0;
+}
+
+// Compile all input files on the worker pool. Every job writes into private
+// buffers that are flushed in argument order, so the output is deterministic
+// regardless of scheduling. Parallel jobs have no stdin (read() sees EOF).
+int compileParallel(const CompilerOptions& opts) {
+    struct JobOutput {
+        std::ostringstream out;
+        std::ostringstream err;
+        int exitCode = 0;
+    };
+    
+    std::vector<JobOutput> outputs(opts.inputFiles.size());
+    int exitCode = 0;
+    
+    pl0::WorkerPool pool(opts.jobs);
+    pool.run(outputs.size(),
+        [&](size_t i) {
+            std::istringstream noInput;
+            JobStreams io{noInput, outputs[i].out, outputs[i].err};
+            outputs[i].exitCode = compileJob(opts.inputFiles[i], opts, io);
+        },
+        [&](size_t i) {
+            std::cout << outputs[i].out.str();
+            std::cout.flush();
+            std::cerr << outputs[i].err.str();
+            outputs[i].out.str("");
+            outputs[i].err.str("");
+            if (exitCode == 0) {
+                exitCode = outputs[i].exitCode;
+            }
+        });
+    
+    return exitCode;
+}
+
 CompilerOptions parseArguments(int argc, char* argv[]) {
     CompilerOptions opts;
     
@@ -652,21 +1399,170 @@ CompilerOptions parseArguments(int argc, char* argv[]) {
             }
         } else if (arg == "--optimize" || arg == "-O") {
             opts.optimize = true;
+        } else if (arg == "--check-overflow") {
+            opts.checkOverflow = true;
         } else if (arg == "--debug" || arg == "-d") {
             opts.debug = true;
+        } else if (arg == "-j" || arg == "--jobs" || (arg.size() > 2 && arg.compare(0, 2, "-j") == 0)) {
+            std::string value = arg.size() > 2 && arg[1] == 'j' ? arg.substr(2) : "";
+            if (value.empty() && i + 1 < argc) {
+                value = argv[++i];
+            }
+            char* end = nullptr;
+            long jobs = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || jobs < 0) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid job count for " << arg << ": '" << value << "'\n";
+                std::exit(4);
+            }
+            opts.jobs = static_cast<int>(jobs);
+        } else if (arg == "--timeout") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            char* end = nullptr;
+            long ms = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || ms <= 0 || ms > INT_MAX) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid timeout for --timeout: '" << value << "'\n";
+                std::exit(4);
+            }
+            opts.timeoutMs = static_cast<int>(ms);
+        } else if (arg == "--stack-size" || arg == "--heap-size") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            char* end = nullptr;
+            long words = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || words <= 0 || words > INT_MAX / 2) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid size for " << arg << ": '" << value << "'\n";
+                std::exit(4);
+            }
+            (arg == "--stack-size" ? opts.stackSize : opts.heapSize) = static_cast<int>(words);
+        } else if (arg == "--junit") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "--junit requires a file name\n";
+                std::exit(4);
+            }
+            opts.junitFile = argv[++i];
+        } else if (arg == "--batch-io") {
+            opts.batchIo = 1;
+        } else if (arg == "--no-batch-io") {
+            opts.batchIo = 0;
+        } else if (arg == "--input-file" || arg == "--output-file") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << arg << " requires a file name\n";
+                std::exit(4);
+            }
+            (arg == "--input-file" ? opts.inputFile : opts.outputFile) = argv[++i];
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--stats") {
+            opts.stats = true;
+        } else if (arg == "--time-report") {
+            opts.timeReport = true;
+        } else if (arg == "--stats-json") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "--stats-json requires a file name (or -)\n";
+                std::exit(4);
+            }
+            opts.statsJsonFile = argv[++i];
+        } else if (arg == "--profile-stacks") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "--profile-stacks requires a file name\n";
+                std::exit(4);
+            }
+            opts.profileStacksFile = argv[++i];
+        } else if (arg == "--checkpoint-every") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            char* end = nullptr;
+            unsigned long long count = std::strtoull(value.c_str(), &end, 10);
+            if (value.empty() || value[0] == '-' || *end != '\0' || count == 0) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid instruction count for --checkpoint-every: '" << value << "'\n";
+                std::exit(4);
+            }
+            opts.checkpointEvery = count;
+        } else if (arg == "--trace-file") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "--trace-file requires a file name\n";
+                std::exit(4);
+            }
+            opts.traceFile = argv[++i];
+        } else if (arg == "--trace-records") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            char* end = nullptr;
+            unsigned long long count = std::strtoull(value.c_str(), &end, 10);
+            if (value.empty() || value[0] == '-' || *end != '\0' || count == 0 || count > (1ull << 32)) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid record count for --trace-records: '" << value << "'\n";
+                std::exit(4);
+            }
+            opts.traceRecords = static_cast<size_t>(count);
+        } else if (arg == "--record-every") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            char* end = nullptr;
+            unsigned long long count = std::strtoull(value.c_str(), &end, 10);
+            if (value.empty() || value[0] == '-' || *end != '\0') {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid instruction count for --record-every: '" << value << "'\n";
+                std::exit(4);
+            }
+            opts.recordEvery = count;
+        } else if (arg == "--checkpoint") {
+            if (i + 1 >= argc) {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "--checkpoint requires a file name\n";
+                std::exit(4);
+            }
+            opts.checkpointFile = argv[++i];
+        } else if (arg == "--io-format") {
+            std::string value = i + 1 < argc ? argv[++i] : "";
+            if (value == "text") {
+                opts.ioFormat = pl0::IntFormat::TEXT;
+            } else if (value == "binary") {
+                opts.ioFormat = pl0::IntFormat::BINARY;
+            } else {
+                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                          << "Invalid format for --io-format: '" << value << "' (text or binary)\n";
+                std::exit(4);
+            }
         } else if (arg[0] == '-') {
             std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
                       << "Unknown option: " << arg << "\n";
             std::cerr << "Use --help for usage information.\n";
             std::exit(4);
         } else {
-            if (opts.inputFile.empty()) {
-                opts.inputFile = arg;
-            } else {
-                std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
-                          << "Multiple input files specified.\n";
-                std::exit(4);
-            }
+            opts.inputFiles.push_back(arg);
+        }
+    }
+    
+    if (opts.debug && opts.inputFiles.size() > 1) {
+        std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                  << "--debug accepts a single input file.\n";
+        std::exit(4);
+    }
+    
+    if (!opts.checkpointFile.empty() && opts.checkpointEvery == 0) {
+        std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                  << "--checkpoint requires --checkpoint-every.\n";
+        std::exit(4);
+    }
+    
+    // Options naming one output file cannot be shared by several jobs
+    if (opts.inputFiles.size() > 1) {
+        const char* single = !opts.outputFile.empty() ? "--output-file"
+                           : !opts.traceFile.empty() ? "--trace-file"
+                           : !opts.checkpointFile.empty() ? "--checkpoint"
+                           : !opts.profileStacksFile.empty() ? "--profile-stacks"
+                           : !opts.statsJsonFile.empty() && opts.statsJsonFile != "-" ? "--stats-json <file>"
+                           : nullptr;
+        if (single) {
+            std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                      << single << " accepts a single input file.\n";
+            std::exit(4);
         }
     }
     
@@ -687,6 +1583,11 @@ int main(int argc, char* argv[]) {
         g_useColor = false;
     }
     
+    // Nobody to prompt when both ends are redirected
+    if (opts.batchIo < 0) {
+        opts.batchIo = !pl0::isTerminal(stdin) && !pl0::isTerminal(stdout) ? 1 : 0;
+    }
+    
     // Handle help/version
     if (opts.showHelp) {
         printHelp(argv[0]);
@@ -704,9 +1605,16 @@ int main(int argc, char* argv[]) {
         std::cout << col(TermColor::Bold) << "Running tests in: " << col(TermColor::Reset)
                   << opts.testDirectory << "\n";
         
-        TestRunner runner(opts.testDirectory);
+        TestRunner runner(opts.testDirectory, opts.jobs < 0 ? 0 : opts.jobs,
+                          opts.timeoutMs > 0 ? opts.timeoutMs : DEFAULT_TEST_TIMEOUT_MS);
         auto results = runner.runAllTests();
-        TestRunner::printResults(results);
+        runner.printResults(results);
+        
+        if (!opts.junitFile.empty() && !runner.writeJUnit(results, opts.junitFile)) {
+            std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
+                      << "Cannot write JUnit report: " << opts.junitFile << "\n";
+            return 1;
+        }
         
         // Return non-zero if any test failed
         int failed = std::count_if(results.begin(), results.end(),
@@ -715,66 +1623,23 @@ int main(int argc, char* argv[]) {
     }
     
     // Check for input file
-    if (opts.inputFile.empty()) {
+    if (opts.inputFiles.empty()) {
         printHelp(argv[0]);
         return 0;
     }
     
-    // Resolve file path
-    std::string resolvedPath = FileResolver::resolve(opts.inputFile);
-    
-    // Check if file exists
-    if (!fs::exists(resolvedPath)) {
-        std::cerr << col(TermColor::BoldRed) << "Error: " << col(TermColor::Reset)
-                  << "File not found: " << opts.inputFile << "\n";
-        
-        // Suggest similar files
-        std::string dir = fs::path(opts.inputFile).parent_path().string();
-        if (dir.empty()) dir = ".";
-        
-        if (fs::exists(dir)) {
-            std::vector<std::string> suggestions;
-            std::string base = FileResolver::getBasename(opts.inputFile);
-            
-            try {
-                for (const auto& entry : fs::directory_iterator(dir)) {
-                    if (entry.path().extension() == ".pl0") {
-                        std::string name = entry.path().stem().string();
-                        // Simple similarity check
-                        if (name.find(base) != std::string::npos ||
-                            base.find(name) != std::string::npos) {
-                            suggestions.push_back(entry.path().filename().string());
-                        }
-                    }
-                }
-            } catch (...) {}
-            
-            if (!suggestions.empty()) {
-                std::cerr << "\nDid you mean:\n";
-                for (const auto& s : suggestions) {
-                    std::cerr << "  " << col(TermColor::Cyan) << s << col(TermColor::Reset) << "\n";
-                }
+    // Single file or sequential batch: compile directly on the console
+    if (opts.jobs < 0 || opts.jobs == 1 || opts.inputFiles.size() == 1) {
+        JobStreams console{std::cin, std::cout, std::cerr};
+        int exitCode = 0;
+        for (const auto& file : opts.inputFiles) {
+            int code = compileJob(file, opts, console);
+            if (exitCode == 0) {
+                exitCode = code;
             }
         }
-        
-        return 3;
-    }
-    
-    // Print header
-    std::cout << col(TermColor::BoldCyan) << "Extended PL/0 Compiler" << col(TermColor::Reset) << "\n";
-    std::cout << "Input file: " << col(TermColor::Bold) << resolvedPath << col(TermColor::Reset) << "\n";
-    std::cout << std::string(50, '=') << "\n";
-    
-    // Compile
-    CompilationResult result = compileFile(resolvedPath, opts);
-    
-    if (!result.success) {
-        if (!result.errorMessage.empty()) {
-            std::cerr << col(TermColor::Red) << "Error: " << col(TermColor::Reset)
-                      << result.errorMessage << "\n";
-        }
-        return result.errorCount > 0 ? 1 : 2;
+        return exitCode;
     }
     
-    return 0;
+    return compileParallel(opts);
 }
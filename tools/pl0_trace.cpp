@@ -0,0 +1,183 @@
+// pl0-trace - render a binary execution trace written by pl0c --trace-file
+//
+// The trace holds the newest instructions of a run (a ring of fixed-size
+// records) plus the source line and procedure of every code address, so it
+// is filtered and printed without the program. Output uses the layout of
+// pl0c --trace; filters combine (an instruction must match all of them).
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include "TraceBuffer.h"
+
+namespace {
+
+struct Range {
+    long first = 0;
+    long last = -1;             // Inclusive; last < first: not set
+
+    bool set() const { return last >= first; }
+    bool contains(long value) const { return value >= first && value <= last; }
+};
+
+struct TraceOptions {
+    Range lines;                // --line
+    Range pcs;                  // --pc
+    std::string procedure;      // --proc; empty: any
+    uint64_t lastCount = 0;     // --last; 0: all
+    bool count = false;         // Print the number of matches only
+    bool numbers = false;       // Prefix records with their instruction number
+    std::string file;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] <trace-file>\n\n"
+              << "Prints the instructions recorded by pl0c --trace-file, oldest first.\n\n"
+              << "Options:\n"
+              << "  --line <a>[-<b>]    Only instructions of source lines a..b\n"
+              << "  --proc <name>       Only instructions of procedure <name> (main: program body)\n"
+              << "  --pc <a>[-<b>]      Only code addresses a..b\n"
+              << "  --last <N>          Only the last N matching instructions\n"
+              << "  --count             Print the number of matching instructions\n"
+              << "  -n                  Prefix each instruction with its number in the run\n";
+}
+
+bool parseNumber(const std::string& text, long min, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= min;
+}
+
+// "a" or "a-b"
+bool parseRange(const std::string& text, Range& range) {
+    size_t dash = text.find('-', 1);
+    if (dash == std::string::npos) {
+        return parseNumber(text, 0, range.first) && parseNumber(text, 0, range.last);
+    }
+    return parseNumber(text.substr(0, dash), 0, range.first)
+        && parseNumber(text.substr(dash + 1), range.first, range.last);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TraceOptions opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (arg == "--count") {
+            opts.count = true;
+            continue;
+        }
+        if (arg == "-n") {
+            opts.numbers = true;
+            continue;
+        }
+        if (arg[0] != '-') {
+            if (!opts.file.empty()) {
+                std::cerr << "Error: unexpected argument " << arg << "\n";
+                return 4;
+            }
+            opts.file = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires a value\n";
+            return 4;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--line") {
+            valid = parseRange(value, opts.lines);
+        } else if (arg == "--pc") {
+            valid = parseRange(value, opts.pcs);
+        } else if (arg == "--proc") {
+            opts.procedure = value;
+        } else if (arg == "--last") {
+            long number = 0;
+            valid = parseNumber(value, 1, number);
+            opts.lastCount = static_cast<uint64_t>(number);
+        } else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 4;
+        }
+        if (!valid) {
+            std::cerr << "Error: invalid value for " << arg << ": '" << value << "'\n";
+            return 4;
+        }
+    }
+    if (opts.file.empty()) {
+        printUsage(argv[0]);
+        return 4;
+    }
+
+    std::ios::sync_with_stdio(false);
+    pl0::TraceBuffer trace;
+    if (!trace.open(opts.file)) {
+        std::cerr << "Error: " << opts.file << ": " << trace.getError() << "\n";
+        return 2;
+    }
+
+    // Procedure filter as an index; a name may be declared in several scopes
+    std::vector<bool> procedureMatch;
+    if (!opts.procedure.empty()) {
+        bool found = false;
+        for (std::string_view name : trace.getProcedures()) {
+            procedureMatch.push_back(name == opts.procedure);
+            found = found || name == opts.procedure;
+        }
+        if (!found) {
+            std::cerr << "Error: no procedure '" << opts.procedure << "' in the trace\n";
+            return 4;
+        }
+    }
+
+    // Match per code address once instead of per record
+    std::vector<char> pcMatch(static_cast<size_t>(trace.getCodeSize()), 1);
+    for (int pc = 0; pc < trace.getCodeSize(); pc++) {
+        int procedure = trace.procedureAt(pc);
+        if ((opts.lines.set() && !opts.lines.contains(trace.lineAt(pc)))
+            || (opts.pcs.set() && !opts.pcs.contains(pc))
+            || (!procedureMatch.empty() && (procedure < 0 || !procedureMatch[procedure]))) {
+            pcMatch[pc] = 0;
+        }
+    }
+    auto matches = [&](const pl0::TraceRecord& rec) {
+        return rec.pc >= 0 && rec.pc < trace.getCodeSize() && pcMatch[rec.pc];
+    };
+
+    size_t held = trace.size();
+    uint64_t matching = 0;
+    for (size_t i = 0; i < held; i++) {
+        matching += matches(trace[i]) ? 1 : 0;
+    }
+    if (opts.count) {
+        std::cout << matching << "\n";
+        return 0;
+    }
+    if (trace.getTotal() > held) {
+        std::cerr << "(" << trace.getTotal() - held << " earlier instructions not kept)\n";
+    }
+
+    uint64_t skip = opts.lastCount > 0 && matching > opts.lastCount ? matching - opts.lastCount : 0;
+    uint64_t firstNumber = trace.getTotal() - held;
+    for (size_t i = 0; i < held; i++) {
+        const pl0::TraceRecord& rec = trace[i];
+        if (!matches(rec)) continue;
+        if (skip > 0) {
+            skip--;
+            continue;
+        }
+        if (opts.numbers) {
+            std::cout << firstNumber + i << " ";
+        }
+        pl0::TraceBuffer::print(std::cout, rec, trace.lineAt(rec.pc));
+    }
+    return 0;
+}